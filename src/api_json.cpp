@@ -0,0 +1,293 @@
+// JSON for the REST API, see api_json.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "api_json.h"
+
+// ===== Writer =====
+static void put(ApiJson &w, const char *data, size_t len)
+{
+  if (w.overflow || w.n + len >= w.len)
+  {
+    w.overflow = true;
+    return;
+  }
+  memcpy(w.buf + w.n, data, len);
+  w.n += len;
+}
+
+static void putChar(ApiJson &w, char ch)
+{
+  put(w, &ch, 1);
+}
+
+static void putString(ApiJson &w, const char *s)
+{
+  putChar(w, '"');
+  for (; *s; s++)
+  {
+    unsigned char ch = (unsigned char)*s;
+    if (ch == '"' || ch == '\\')
+    {
+      char esc[2] = {'\\', (char)ch};
+      put(w, esc, 2);
+    }
+    else if (ch < 0x20)
+    {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", ch);
+      put(w, esc, 6);
+    }
+    else
+      putChar(w, (char)ch);
+  }
+  putChar(w, '"');
+}
+
+/// @brief Separator and key of the next member
+static void member(ApiJson &w, const char *key)
+{
+  uint8_t bit = (uint8_t)(1u << (w.depth - 1));
+  if (w.members & bit)
+    putChar(w, ',');
+  w.members |= bit;
+  if (key)
+  {
+    putString(w, key);
+    putChar(w, ':');
+  }
+}
+
+static void openLevel(ApiJson &w, const char *key, char openCh, char closeCh)
+{
+  if (w.depth >= API_JSON_DEPTH)
+  {
+    w.overflow = true;
+    return;
+  }
+  member(w, key);
+  putChar(w, openCh);
+  w.close[w.depth] = closeCh;
+  w.members &= (uint8_t)~(1u << w.depth);
+  w.depth++;
+}
+
+void apiJsonBegin(ApiJson &w, char *buf, size_t len)
+{
+  memset(&w, 0, sizeof(w));
+  w.buf = buf;
+  w.len = len;
+  putChar(w, '{');
+  w.close[0] = '}';
+  w.depth = 1;
+}
+
+void apiJsonObject(ApiJson &w, const char *key)
+{
+  openLevel(w, key, '{', '}');
+}
+
+void apiJsonArray(ApiJson &w, const char *key)
+{
+  openLevel(w, key, '[', ']');
+}
+
+void apiJsonEnd(ApiJson &w)
+{
+  if (w.depth <= 1)
+    return; // the top level closes in apiJsonFinish()
+  w.depth--;
+  putChar(w, w.close[w.depth]);
+}
+
+void apiJsonString(ApiJson &w, const char *key, const char *value)
+{
+  member(w, key);
+  putString(w, value);
+}
+
+void apiJsonInt(ApiJson &w, const char *key, long value)
+{
+  char text[24];
+  int n = snprintf(text, sizeof(text), "%ld", value);
+  member(w, key);
+  put(w, text, n);
+}
+
+void apiJsonUint(ApiJson &w, const char *key, unsigned long value)
+{
+  char text[24];
+  int n = snprintf(text, sizeof(text), "%lu", value);
+  member(w, key);
+  put(w, text, n);
+}
+
+void apiJsonDeci(ApiJson &w, const char *key, int32_t deci)
+{
+  char text[16];
+  long v = deci < 0 ? -(long)deci : deci;
+  int n = snprintf(text, sizeof(text), "%s%ld.%ld", deci < 0 ? "-" : "", v / 10, v % 10);
+  member(w, key);
+  put(w, text, n);
+}
+
+void apiJsonBool(ApiJson &w, const char *key, bool value)
+{
+  member(w, key);
+  put(w, value ? "true" : "false", value ? 4 : 5);
+}
+
+void apiJsonNull(ApiJson &w, const char *key)
+{
+  member(w, key);
+  put(w, "null", 4);
+}
+
+size_t apiJsonFinish(ApiJson &w)
+{
+  while (w.depth > 0)
+  {
+    w.depth--;
+    putChar(w, w.close[w.depth]);
+  }
+  if (w.overflow)
+  {
+    if (w.len)
+      w.buf[0] = '\0';
+    return 0;
+  }
+  w.buf[w.n] = '\0';
+  return w.n;
+}
+
+// ===== Reader =====
+static const char *skipSpace(const char *p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
+  return p;
+}
+
+/// @brief Read the string at p (on its opening quote), unescaped into out if it fits
+/// @return Past the closing quote, nullptr if unterminated
+static const char *readString(const char *p, char *out, size_t len, bool &fits)
+{
+  size_t n = 0;
+  fits = out != nullptr && len > 0;
+  for (p++; *p && *p != '"'; p++)
+  {
+    char ch = *p;
+    if (ch == '\\')
+    {
+      p++;
+      switch (*p)
+      {
+      case 'n': ch = '\n'; break;
+      case 't': ch = '\t'; break;
+      case 'r': ch = '\r'; break;
+      case 'b': ch = '\b'; break;
+      case 'f': ch = '\f'; break;
+      case 'u':
+        for (int i = 1; i <= 4; i++)
+        {
+          if (p[i] == '\0')
+            return nullptr;
+        }
+        ch = '?'; // no use for non-ASCII in this API
+        p += 4;
+        break;
+      case '\0': return nullptr;
+      default: ch = *p; break;
+      }
+    }
+    if (fits && n + 1 < len)
+      out[n++] = ch;
+    else
+      fits = false;
+  }
+  if (*p != '"')
+    return nullptr;
+  if (out && len > 0)
+    out[n < len ? n : len - 1] = '\0';
+  return p + 1;
+}
+
+/// @brief Skip the value at p
+/// @return Past it, nullptr if malformed
+static const char *skipValue(const char *p)
+{
+  bool fits;
+  if (*p == '"')
+    return readString(p, nullptr, 0, fits);
+  if (*p == '{' || *p == '[')
+  {
+    int depth = 0;
+    for (; *p; p++)
+    {
+      if (*p == '"')
+      {
+        p = readString(p, nullptr, 0, fits);
+        if (p == nullptr)
+          return nullptr;
+        p--;
+      }
+      else if (*p == '{' || *p == '[')
+        depth++;
+      else if ((*p == '}' || *p == ']') && --depth == 0)
+        return p + 1;
+    }
+    return nullptr;
+  }
+  const char *start = p;
+  while (*p && !strchr(",}] \t\r\n", *p))
+    p++;
+  return p > start ? p : nullptr;
+}
+
+bool apiJsonMember(const char *json, const char *key, char *out, size_t len, bool &isString)
+{
+  const char *p = skipSpace(json);
+  if (*p != '{')
+    return false;
+  p = skipSpace(p + 1);
+  if (*p == '}')
+    return false;
+  for (;;)
+  {
+    if (*p != '"')
+      return false;
+    char name[32];
+    bool fits;
+    p = readString(p, name, sizeof(name), fits);
+    if (p == nullptr)
+      return false;
+    p = skipSpace(p);
+    if (*p != ':')
+      return false;
+    p = skipSpace(p + 1);
+
+    if (fits && strcmp(name, key) == 0)
+    {
+      if (*p == '{' || *p == '[')
+        return false;
+      isString = *p == '"';
+      if (isString)
+        return readString(p, out, len, fits) != nullptr && fits;
+      const char *end = skipValue(p);
+      if (end == nullptr || (size_t)(end - p) >= len)
+        return false;
+      memcpy(out, p, end - p);
+      out[end - p] = '\0';
+      return true;
+    }
+
+    p = skipValue(p);
+    if (p == nullptr)
+      return false;
+    p = skipSpace(p);
+    if (*p != ',')
+      return false; // '}': not there
+    p = skipSpace(p + 1);
+  }
+}
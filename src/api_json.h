@@ -0,0 +1,51 @@
+// JSON for the REST API, no heap
+// Writer: members are appended to a caller's buffer (normally on the stack) as they are produced,
+// commas and closing brackets are tracked per nesting level. On overflow the writer stops and
+// apiJsonFinish() reports it, a truncated document is never returned.
+// Reader: looks up a top-level member of a small request body already in memory (flat objects,
+// nested values are skipped).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const int API_JSON_DEPTH = 8;
+
+struct ApiJson
+{
+  char *buf;
+  size_t len;
+  size_t n;
+  uint8_t depth;
+  uint8_t members;            // bit per level: a member was written
+  char close[API_JSON_DEPTH]; // closing bracket per level
+  bool overflow;
+};
+
+/// @brief Start a document in buf, the top level object is open
+void apiJsonBegin(ApiJson &w, char *buf, size_t len);
+
+/// @brief Open a nested object / array; key nullptr inside arrays
+void apiJsonObject(ApiJson &w, const char *key);
+void apiJsonArray(ApiJson &w, const char *key);
+/// @brief Close the innermost object / array
+void apiJsonEnd(ApiJson &w);
+
+void apiJsonString(ApiJson &w, const char *key, const char *value);
+void apiJsonInt(ApiJson &w, const char *key, long value);
+void apiJsonUint(ApiJson &w, const char *key, unsigned long value);
+/// @brief Fixed point deci value as a number with one decimal, e.g. -12.5
+void apiJsonDeci(ApiJson &w, const char *key, int32_t deci);
+void apiJsonBool(ApiJson &w, const char *key, bool value);
+void apiJsonNull(ApiJson &w, const char *key);
+
+/// @brief Close all open levels
+/// @return Document length (NUL terminated in buf), 0 if it did not fit
+size_t apiJsonFinish(ApiJson &w);
+
+/// @brief Find a top-level member of a JSON object
+/// @param out  Receives the value: unescaped for strings, the raw token for numbers / true / false / null
+/// @param isString  Set if the value is a string
+/// @return false if the member is missing, nested (object / array), too long or the object is malformed
+bool apiJsonMember(const char *json, const char *key, char *out, size_t len, bool &isString);
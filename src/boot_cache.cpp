@@ -0,0 +1,65 @@
+// Last good display frame + temperature, see boot_cache.h
+
+#include "hal.h"
+#include "boot_cache.h"
+
+#define BOOT_CACHE_MAGIC 0x42435631UL // "BCV1"
+
+struct BootCache
+{
+  uint32_t magic;
+  uint16_t frame;
+  int16_t tempDeci; // temperature * 10
+  uint32_t check;
+};
+
+HAL_RTC_NOINIT static BootCache rtcCache;
+static BootCache lastStored;
+static bool lastStoredValid = false;
+
+static uint32_t bootCacheCheck(const BootCache &c)
+{
+  return c.magic ^ ((uint32_t)c.frame << 16) ^ (uint16_t)c.tempDeci ^ 0xA5A5A5A5UL;
+}
+
+static bool bootCacheValid(const BootCache &c)
+{
+  return c.magic == BOOT_CACHE_MAGIC && c.check == bootCacheCheck(c);
+}
+
+bool bootCacheLoad(uint16_t &frame, float &temp)
+{
+  BootCache c = rtcCache;
+
+  if (!bootCacheValid(c))
+  {
+    if (!halStoreRead("bootcache", "last", &c, sizeof(c)) || !bootCacheValid(c))
+      return false;
+    rtcCache = c;
+  }
+
+  lastStored = c;
+  lastStoredValid = true;
+  frame = c.frame;
+  temp = c.tempDeci / 10.0f;
+  return true;
+}
+
+void bootCacheStore(uint16_t frame, float temp)
+{
+  BootCache c;
+  c.magic = BOOT_CACHE_MAGIC;
+  c.frame = frame;
+  c.tempDeci = (int16_t)(temp * 10.0f + (temp < 0 ? -0.5f : 0.5f));
+  c.check = bootCacheCheck(c);
+  rtcCache = c;
+
+  if (lastStoredValid && lastStored.frame == c.frame && lastStored.tempDeci == c.tempDeci)
+    return;
+
+  if (halStoreWrite("bootcache", "last", &c, sizeof(c)))
+  {
+    lastStored = c;
+    lastStoredValid = true;
+  }
+}
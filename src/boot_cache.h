@@ -0,0 +1,17 @@
+// Last good display frame + temperature, persisted for instant display on boot
+// RTC copy survives soft reset / brown-out reset, NVS copy survives power-off.
+
+#pragma once
+
+#include <stdint.h>
+
+/// @brief Load last good frame and temperature
+/// @param frame  Output 16-bit display frame
+/// @param temp   Output temperature in Celsius
+/// @return true if a valid cached value exists
+bool bootCacheLoad(uint16_t &frame, float &temp);
+
+/// @brief Store last good frame and temperature (NVS written only on change)
+/// @param frame  16-bit display frame
+/// @param temp   Temperature in Celsius
+void bootCacheStore(uint16_t frame, float temp);
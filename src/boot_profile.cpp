@@ -0,0 +1,74 @@
+// Boot-phase profiler, see boot_profile.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "boot_profile.h"
+
+const int BOOT_PROFILE_MAX_PHASES = 12;
+
+struct BootPhase
+{
+  const char *name;
+  unsigned long us;
+};
+
+static BootPhase phases[BOOT_PROFILE_MAX_PHASES];
+static int phaseCount = 0;
+static unsigned long lastMark = 0; // micros() since power-on
+
+static unsigned long loopUs[BOOT_PROFILE_LOOPS];
+static int loopCount = 0;
+static unsigned long lastLoopStart = 0;
+static bool reported = false;
+
+void bootProfileMark(const char *phase)
+{
+  unsigned long now = halMicros();
+  if (phaseCount < BOOT_PROFILE_MAX_PHASES)
+  {
+    phases[phaseCount].name = phase;
+    phases[phaseCount].us = now - lastMark;
+    phaseCount++;
+  }
+  lastMark = now;
+}
+
+void bootProfileLoop()
+{
+  if (reported)
+    return;
+
+  unsigned long now = halMicros();
+  if (lastLoopStart != 0 && loopCount < BOOT_PROFILE_LOOPS)
+    loopUs[loopCount++] = now - lastLoopStart;
+  lastLoopStart = now;
+
+  if (loopCount < BOOT_PROFILE_LOOPS)
+    return;
+
+  reported = true;
+  char buf[512];
+  bootProfileReport(buf, sizeof(buf));
+  halSerialWrite(buf);
+}
+
+size_t bootProfileReport(char *buf, size_t len)
+{
+  size_t n = 0;
+  unsigned long total = 0;
+
+  n += snprintf(buf + n, len - n, "boot phases [us]:\n");
+  for (int i = 0; i < phaseCount && n < len; i++)
+  {
+    total += phases[i].us;
+    n += snprintf(buf + n, len - n, "  %-10s %8lu\n", phases[i].name, phases[i].us);
+  }
+  if (n < len)
+    n += snprintf(buf + n, len - n, "  %-10s %8lu\nfirst loops [us]:", "total", total);
+  for (int i = 0; i < loopCount && n < len; i++)
+    n += snprintf(buf + n, len - n, " %lu", loopUs[i]);
+  if (n < len)
+    n += snprintf(buf + n, len - n, "\n");
+  return n < len ? n : len - 1;
+}
@@ -0,0 +1,22 @@
+// Boot-phase profiler
+// Records time spent in each part of setup() and in the first loop() iterations.
+
+#pragma once
+
+#include <stddef.h>
+
+// number of loop() iterations recorded after setup()
+const int BOOT_PROFILE_LOOPS = 8;
+
+/// @brief Mark end of a setup() phase (time since previous mark is attributed to it)
+/// @param phase  Static phase name
+void bootProfileMark(const char *phase);
+
+/// @brief Call at the start of every loop(); records first iterations, prints report once
+void bootProfileLoop();
+
+/// @brief Write report as text
+/// @param buf  Output buffer
+/// @param len  Buffer size
+/// @return Number of chars written
+size_t bootProfileReport(char *buf, size_t len);
@@ -0,0 +1,289 @@
+// OUTDOOR display driver + frame compositor, see display.h
+
+#include <string.h>
+
+#include "hal.h"
+#include "outdoor_symbols.h"
+#include "display.h"
+#include "trace.h"
+
+// heldpers for open-drain signaling
+inline void setPinLow(int pin);
+inline void setDataBit(uint8_t bit);
+inline void setPinHigh(int pin);
+inline void pulseClock();
+void pulseLatch();
+
+static uint16_t layerFrame[DISPLAY_LAYER_COUNT];
+static uint8_t layerActive = 0; // bit per layer
+static uint16_t latchedFrame = 0;
+static bool latchedValid = false;
+static DisplayStats stats = {};
+
+static bool topFrame(uint16_t &frame);
+
+/// @brief  Pack two digits + minus + celsius into 16-bit frame
+/// @param digit1   First digit segments array (7 bools)
+/// @param digit2   Second digit segments array (7 bools)
+/// @param minus    Minus sign segment (bool)
+/// @param celsius  Celsius sign segment (bool)
+/// @return Frame word, bit 0 is sent first
+uint16_t makeFrame(const bool *digit1, const bool *digit2, bool minus, bool celsius)
+{
+  uint16_t frame = 0;
+  for (int i = 0; i < 7; ++i)
+  {
+    if (digit1[i])
+      frame |= 1u << i;
+    if (digit2[i])
+      frame |= 1u << (7 + i);
+  }
+  if (minus)
+    frame |= FRAME_BIT_MINUS;
+  if (celsius)
+    frame |= FRAME_BIT_CELSIUS;
+  return frame;
+}
+
+void sendFrame(uint16_t frame)
+{
+  TRACE_SCOPE(TRACE_SEND_FRAME);
+  unsigned long t0 = halMicros();
+
+  // ensure latch idle low before starting
+  setPinLow(PIN_LATCH);
+  halDelayMicroseconds(4);
+
+  for (int i = 0; i < 16; ++i)
+  {
+    setDataBit((frame >> i) & 1u);
+    // small setup time before clock
+    halDelayMicroseconds(1);
+    pulseClock();
+  }
+
+  latchedFrame = frame;
+  latchedValid = true;
+
+  // after bits sent, pulse latch to update display
+  pulseLatch();
+
+  // release data line
+  setPinHigh(PIN_DATA);
+
+  unsigned long us = halMicros() - t0;
+  stats.sent++;
+  stats.busUs += us;
+  if (us > stats.busMaxUs)
+    stats.busMaxUs = us;
+}
+
+/// @brief  Frame for integer number (-99..99)
+/// @param num   Integer number to display
+uint16_t frameForNumber(int num)
+{
+  bool minus = false;
+  if (num < 0)
+  {
+    minus = true;
+    num = -num;
+  }
+  int digit1 = num / 10;
+  int digit2 = num % 10;
+
+  if (digit1 == 0)
+    digit1 = 10; // NULL for leading zero
+
+  if (minus && num > 0 && num < 10)
+  {
+    minus = false;
+    digit1 = DISPLAY_SIGN_MINUS_IDX; // show minus on first digit if only one digit negative
+  }
+  return makeFrame(DIGIT_1[digit1], DIGIT_2[digit2], minus, true);
+}
+
+/// @brief  Frame for symbol
+/// @param data  String data ( "NULL" , "--", "01".."06", "99" )
+bool frameForSymbol(const char *data, uint16_t &frame)
+{
+  // NULL display (all segments off)
+  if (strcmp(data, "NULL") == 0)
+  {
+    frame = makeFrame(DIGIT_1[DISPLAY_NULL_IDX], DIGIT_2[DISPLAY_NULL_IDX], false, true);
+    return true;
+  }
+  // -- display
+  if (strcmp(data, "--") == 0)
+  {
+    frame = makeFrame(DIGIT_1[DISPLAY_SIGN_MINUS_IDX], DIGIT_2[DISPLAY_SIGN_MINUS_IDX], false, true);
+    return true;
+  }
+
+  // WiFi error codes 01..06
+  if (data[0] == '0' && data[1] >= '1' && data[1] <= '6' && data[2] == '\0')
+  {
+    frame = makeFrame(DIGIT_1[0], DIGIT_2[data[1] - '0'], false, false);
+    return true;
+  }
+
+  if (strcmp(data, "99") == 0)
+  {
+    frame = makeFrame(DIGIT_1[9], DIGIT_2[9], false, false);
+    return true;
+  }
+
+  return false;
+}
+
+/// @brief  Animation frame
+/// @param idx  Index of animation frame (0..11)
+uint16_t frameForAnimation(int idx)
+{
+  return makeFrame(DIGIT_1[idx + 12], DIGIT_2[idx + 12], false, false);
+}
+
+// ===== Compositor =====
+
+void displaySet(DisplayLayer layer, uint16_t frame)
+{
+  uint16_t before, after;
+  bool shown = topFrame(before);
+  layerFrame[layer] = frame;
+  layerActive |= (uint8_t)(1u << layer);
+  if (shown && topFrame(after) && after == before)
+    stats.suppressed++;
+}
+
+void displayClear(DisplayLayer layer)
+{
+  layerActive &= (uint8_t)~(1u << layer);
+}
+
+/// @brief Frame of highest active layer
+/// @return false if no layer is active
+static bool topFrame(uint16_t &frame)
+{
+  for (int i = DISPLAY_LAYER_COUNT - 1; i >= 0; i--)
+  {
+    if (layerActive & (1u << i))
+    {
+      frame = layerFrame[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool displayDirty()
+{
+  uint16_t frame;
+  return topFrame(frame) && (!latchedValid || frame != latchedFrame);
+}
+
+void displayLatch()
+{
+  uint16_t frame;
+  if (topFrame(frame) && (!latchedValid || frame != latchedFrame))
+    sendFrame(frame);
+}
+
+uint16_t displayFrame()
+{
+  return latchedFrame;
+}
+
+const DisplayStats &displayStats()
+{
+  return stats;
+}
+
+int displayTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
+  {
+    PT_WAIT_UNTIL(pt, displayDirty());
+    displayLatch();
+  }
+  PT_END(pt);
+}
+
+// ===== Bus =====
+
+/// @brief Set a pin to LOW (drive line low)
+/// @param pin  Pin number
+inline void setPinLow(int pin)
+{
+  halPinLow(pin);
+}
+/// @brief Set a pin to high-Z (pull-up will pull line HIGH)
+/// @param pin  Pin number
+inline void setPinHigh(int pin)
+{
+  halPinRelease(pin); // high-Z, pull-up will pull line HIGH
+}
+
+/// @brief Set data line according to logical bit and BIT_ON_HIGH polarity
+/// @param bit  Logical bit to send (0/1)
+inline void setDataBit(uint8_t bit)
+{
+  bool wantHigh = (bit != 0) ? true : false;
+  if (wantHigh)
+    setPinHigh(PIN_DATA);
+  else
+    setPinLow(PIN_DATA);
+}
+
+/// @brief  Pulse clock line (LOW->HIGH->LOW)
+inline void pulseClock()
+{
+  const unsigned int T_HALF_US = 5; // half clock period in microseconds (5 -> ~100 kHz)
+  setPinHigh(PIN_CLOCK);
+  halDelayMicroseconds(T_HALF_US);
+  setPinLow(PIN_CLOCK);
+  halDelayMicroseconds(T_HALF_US);
+}
+
+/// @brief  Pulse latch line to update display
+void pulseLatch()
+{
+  // ensure latch idle = LOW
+  setPinHigh(PIN_LATCH);
+  halDelayMicroseconds(2);
+
+  // release -> goes HIGH (via pull-up)
+  setPinLow(PIN_LATCH);
+  halDelayMicroseconds(8); // hold HIGH briefly to latch
+  // drive low again to return to idle
+  setPinHigh(PIN_LATCH);
+  halDelayMicroseconds(4);
+  // release to leave in high-Z (optional)
+  setPinLow(PIN_LATCH);
+}
+
+void initPins()
+{
+  setPinHigh(PIN_CLOCK);
+  setPinHigh(PIN_DATA);
+  setPinHigh(PIN_LATCH);
+}
+
+bool waitBusReady(unsigned long timeoutMs)
+{
+  const int STABLE_SAMPLES = 5; // 5 x 200 us
+  int stable = 0;
+  unsigned long start = halMillis();
+
+  while (halMillis() - start < timeoutMs)
+  {
+    if (halPinRead(PIN_CLOCK) && halPinRead(PIN_DATA) && halPinRead(PIN_LATCH))
+    {
+      if (++stable >= STABLE_SAMPLES)
+        return true;
+    }
+    else
+      stable = 0;
+    halDelayMicroseconds(200);
+  }
+  return false;
+}
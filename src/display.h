@@ -0,0 +1,89 @@
+// ESP32 OPEN-DRAIN DRIVER for OUTDOOR display (16-bit frames) + frame compositor
+// Pins used: CLOCK -> GPIO4, LATCH -> GPIO2, DATA -> GPIO3
+// Open-drain emulation: OUTPUT LOW to pull line low, INPUT to release (pull-up pulls HIGH)
+// BIT_ON_HIGH = true means bit==1 -> LINE HIGH (LED ON), bit==0 -> LINE LOW (LED OFF)
+//
+// Tasks do not write to the bus directly: each owns a compositor layer and the display task
+// latches the frame of the highest active layer whenever it changes.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "pt.h"
+
+// Pin definitions
+const int PIN_LATCH = 2; // green
+const int PIN_DATA = 3;  // blue
+const int PIN_CLOCK = 4; // yellow
+
+// 16-bit frame, bit order as sent on the wire: 0..6 digit1, 7..13 digit2, 14 minus, 15 celsius
+const uint16_t FRAME_BIT_MINUS = 1u << 14;
+const uint16_t FRAME_BIT_CELSIUS = 1u << 15;
+
+// number of animation frames in outdoor_symbols.h
+const int DISPLAY_ANIM_FRAMES = 12;
+
+// compositor layers, higher layer wins
+enum DisplayLayer
+{
+  DISPLAY_LAYER_VALUE,        // temperature (or value set from web)
+  DISPLAY_LAYER_SENSOR_ERROR, // thermometer error animation
+  DISPLAY_LAYER_WIFI,         // "--" / "NULL" blinking while WiFi is down
+  DISPLAY_LAYER_STATUS,       // reconnect sequence, WiFi error codes
+  DISPLAY_LAYER_ANIM,         // start animation
+  DISPLAY_LAYER_PLAYBACK,     // uploaded frame stream (playback.h)
+  DISPLAY_LAYER_COUNT
+};
+
+/// @brief Bus and compositor counters
+struct DisplayStats
+{
+  unsigned long sent;       // frames written to the bus
+  unsigned long suppressed; // layer updates that left the composed frame unchanged (no bus write)
+  uint64_t busUs;           // time spent in sendFrame()
+  unsigned long busMaxUs;
+};
+
+// initialize pins to safe released state
+void initPins();
+
+/// @brief Wait until display bus lines are pulled HIGH (display powered)
+/// @param timeoutMs  Max wait time
+/// @return true if all lines were HIGH for a few consecutive samples
+bool waitBusReady(unsigned long timeoutMs);
+
+/// @brief  Send 16-bit frame to display and latch it (bypasses compositor)
+/// @param frame  Frame word, bit 0 is sent first
+void sendFrame(uint16_t frame);
+
+/// @brief  Pack two digits + minus + celsius into 16-bit frame
+uint16_t makeFrame(const bool *digit1, const bool *digit2, bool minus, bool celsius);
+
+/// @brief  Frame for integer number (-99..99)
+uint16_t frameForNumber(int num);
+
+/// @brief  Frame for symbol: "NULL", "--", "01".."06", "99"
+/// @return false if symbol is unknown
+bool frameForSymbol(const char *data, uint16_t &frame);
+
+/// @brief  Frame of start / error animation
+/// @param idx  Index of animation frame (0..11)
+uint16_t frameForAnimation(int idx);
+
+/// @brief Set frame of a compositor layer (latched by display task)
+void displaySet(DisplayLayer layer, uint16_t frame);
+
+/// @brief Deactivate compositor layer
+void displayClear(DisplayLayer layer);
+
+/// @brief Latch top frame now if it differs from the panel
+void displayLatch();
+
+/// @brief Last frame latched to the panel
+uint16_t displayFrame();
+
+const DisplayStats &displayStats();
+
+/// @brief Display service task: latches composed frame when it changes
+int displayTask(Pt *pt);
@@ -0,0 +1,110 @@
+// Display command queue and per-client rate limit, see display_cmd.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "display.h"
+#include "display_cmd.h"
+
+struct CmdClient
+{
+  uint32_t ip;
+  int tokens;
+  unsigned long refillMs; // last token added
+  unsigned long seenMs;
+  bool used;
+};
+
+struct DisplayCmd
+{
+  bool pending;
+  uint16_t frame;
+  bool applied; // appliedMs is valid
+  unsigned long appliedMs;
+  CmdClient clients[DISPLAY_CMD_CLIENTS];
+  DisplayCmdStats stats;
+};
+
+static DisplayCmd cmd = {};
+
+/// @brief Bucket of ip, a fresh full one (replacing the least recently seen) if it has none
+static CmdClient &clientFor(uint32_t ip, unsigned long now)
+{
+  CmdClient *oldest = &cmd.clients[0];
+  for (int i = 0; i < DISPLAY_CMD_CLIENTS; i++)
+  {
+    CmdClient &c = cmd.clients[i];
+    if (c.used && c.ip == ip)
+      return c;
+    if (!c.used || (oldest->used && now - c.seenMs > now - oldest->seenMs))
+      oldest = &c;
+  }
+  oldest->used = true;
+  oldest->ip = ip;
+  oldest->tokens = DISPLAY_CMD_BURST;
+  oldest->refillMs = now;
+  return *oldest;
+}
+
+bool displayCmdPost(uint32_t client, uint16_t frame)
+{
+  unsigned long now = halMillis();
+  CmdClient &c = clientFor(client, now);
+  c.seenMs = now;
+  unsigned long earned = (now - c.refillMs) / DISPLAY_CMD_RATE_MS;
+  if (earned)
+  {
+    c.tokens = c.tokens + earned > (unsigned long)DISPLAY_CMD_BURST ? DISPLAY_CMD_BURST : c.tokens + (int)earned;
+    c.refillMs += earned * DISPLAY_CMD_RATE_MS;
+  }
+  if (c.tokens == 0)
+  {
+    cmd.stats.limited++;
+    return false;
+  }
+  c.tokens--;
+
+  if (cmd.pending)
+    cmd.stats.coalesced++;
+  cmd.pending = true;
+  cmd.frame = frame;
+  cmd.stats.posted++;
+  return true;
+}
+
+void displayCmdPoll()
+{
+  if (!cmd.pending)
+    return;
+  unsigned long now = halMillis();
+  if (cmd.applied && now - cmd.appliedMs < DISPLAY_CMD_PERIOD_MS)
+    return;
+  displaySet(DISPLAY_LAYER_VALUE, cmd.frame);
+  cmd.pending = false;
+  cmd.applied = true;
+  cmd.appliedMs = now;
+  cmd.stats.applied++;
+}
+
+const DisplayCmdStats &displayCmdStats()
+{
+  return cmd.stats;
+}
+
+size_t displayCmdReport(char *buf, size_t len)
+{
+  const DisplayCmdStats &s = cmd.stats;
+  int n = snprintf(buf, len, "display commands %lu posted, %lu applied, %lu coalesced, %lu rate limited%s\n", s.posted,
+                   s.applied, s.coalesced, s.limited, cmd.pending ? ", one pending" : "");
+  unsigned long now = halMillis();
+  for (int i = 0; i < DISPLAY_CMD_CLIENTS && n > 0 && (size_t)n < len; i++)
+  {
+    const CmdClient &c = cmd.clients[i];
+    if (!c.used)
+      continue;
+    n += snprintf(buf + n, len - n, "  client %u.%u.%u.%u tokens %d, seen %lu s ago\n", (unsigned)(c.ip & 0xff),
+                  (unsigned)((c.ip >> 8) & 0xff), (unsigned)((c.ip >> 16) & 0xff), (unsigned)(c.ip >> 24), c.tokens,
+                  (now - c.seenMs) / 1000);
+  }
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
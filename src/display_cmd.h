@@ -0,0 +1,40 @@
+// Coalescing queue for display commands from web handlers (/set, PUT /api/display)
+// A handler only posts the frame it wants on the value layer and answers at once. The queue keeps
+// the latest posted frame and hands it to the compositor at most once per DISPLAY_CMD_PERIOD_MS,
+// so a burst of requests costs one bus write per period however many arrive; the frames in
+// between are dropped (coalesced), only the last one is shown.
+// Each client (IPv4 address) has a token bucket: DISPLAY_CMD_BURST commands at once, then one per
+// DISPLAY_CMD_RATE_MS. Buckets live in a small table, the least recently seen client gives way to
+// a new one. Commands over the limit are refused (429), they never reach the queue.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const unsigned long DISPLAY_CMD_PERIOD_MS = 100; // refresh interval for web-set frames
+const int DISPLAY_CMD_CLIENTS = 8;
+const int DISPLAY_CMD_BURST = 5;
+const unsigned long DISPLAY_CMD_RATE_MS = 200;
+
+/// @brief Queue counters since boot
+struct DisplayCmdStats
+{
+  unsigned long posted;    // accepted commands
+  unsigned long applied;   // handed to the compositor
+  unsigned long coalesced; // replaced by a newer one before their period came
+  unsigned long limited;   // refused by the client's rate limit
+};
+
+/// @brief Take a frame for the value layer from client (webClient())
+/// @return false if the client is over its rate limit (nothing queued)
+bool displayCmdPost(uint32_t client, uint16_t frame);
+
+/// @brief Apply the latest posted frame once its period has come, call every loop
+void displayCmdPoll();
+
+const DisplayCmdStats &displayCmdStats();
+
+/// @brief Write queue counters and the rate limit table as text
+/// @return Number of chars written
+size_t displayCmdReport(char *buf, size_t len);
@@ -0,0 +1,157 @@
+// Live events, see events.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "display.h"
+#include "api_json.h"
+#include "events.h"
+
+// longest event: id, name and data lines
+const size_t EVENT_TEXT_MAX = 80;
+
+enum EventType
+{
+  EVENT_FRAME,
+  EVENT_READING
+};
+
+struct Event
+{
+  uint8_t type;
+  uint16_t frame;
+  int32_t deci;
+};
+
+struct Events
+{
+  Event ring[EVENTS_RING];
+  uint32_t seq; // of the next event
+  bool framed;  // lastFrame is valid
+  uint16_t lastFrame;
+  bool hasReading;
+  int32_t lastDeci;
+  int subscribers;
+  unsigned long subscribed;
+  unsigned long refused; // all slots taken
+  unsigned long dropped; // fell a ring behind
+  unsigned long closed;  // connection ended (client gone, write timeout)
+  unsigned long sent;    // events written to subscribers
+};
+
+static Events ev = {};
+
+static void publish(EventType type, uint16_t frame, int32_t deci)
+{
+  Event &e = ev.ring[ev.seq % EVENTS_RING];
+  e.type = type;
+  e.frame = frame;
+  e.deci = deci;
+  ev.seq++;
+}
+
+void eventsReading(int32_t deci)
+{
+  ev.hasReading = true;
+  ev.lastDeci = deci;
+  publish(EVENT_READING, 0, deci);
+}
+
+void eventsPoll()
+{
+  uint16_t frame = displayFrame();
+  if (ev.framed && frame == ev.lastFrame)
+    return;
+  ev.framed = true;
+  ev.lastFrame = frame;
+  publish(EVENT_FRAME, frame, 0);
+}
+
+bool eventsSubscribe(EventsSub &s)
+{
+  if (ev.subscribers >= EVENTS_MAX_SUBSCRIBERS)
+  {
+    ev.refused++;
+    return false;
+  }
+  ev.subscribers++;
+  ev.subscribed++;
+  memset(&s, 0, sizeof(s));
+  s.next = ev.seq;
+  s.sentMs = halMillis();
+  return true;
+}
+
+/// @brief One event in SSE framing
+static size_t eventText(char *buf, size_t len, uint32_t id, const Event &e)
+{
+  char data[32];
+  ApiJson w;
+  apiJsonBegin(w, data, sizeof(data));
+  if (e.type == EVENT_FRAME)
+    apiJsonUint(w, "frame", e.frame);
+  else
+    apiJsonDeci(w, "temp", e.deci);
+  apiJsonFinish(w);
+  int n = snprintf(buf, len, "id: %lu\nevent: %s\ndata: %s\n\n", (unsigned long)id,
+                   e.type == EVENT_FRAME ? "frame" : "reading", data);
+  return n < 0 || (size_t)n >= len ? 0 : (size_t)n;
+}
+
+int eventsFill(void *ctx, uint8_t *buf, size_t len)
+{
+  EventsSub &s = *(EventsSub *)ctx;
+  if (buf == nullptr)
+  {
+    ev.subscribers--;
+    ev.closed++;
+    return -1;
+  }
+  if (ev.seq - s.next > (uint32_t)EVENTS_RING)
+  {
+    ev.subscribers--;
+    ev.dropped++;
+    return -1;
+  }
+
+  char *out = (char *)buf;
+  size_t n = 0;
+  if (!s.snapshot)
+  {
+    // reconnect delay for EventSource, then the state a new dashboard starts from
+    s.snapshot = true;
+    n += snprintf(out, len, "retry: 5000\n\n");
+    Event e;
+    e.type = EVENT_FRAME;
+    e.frame = displayFrame();
+    n += eventText(out + n, len - n, ev.seq, e);
+    if (ev.hasReading)
+    {
+      e.type = EVENT_READING;
+      e.deci = ev.lastDeci;
+      n += eventText(out + n, len - n, ev.seq, e);
+    }
+  }
+  for (; s.next != ev.seq && len - n > EVENT_TEXT_MAX; s.next++)
+  {
+    n += eventText(out + n, len - n, s.next + 1, ev.ring[s.next % EVENTS_RING]);
+    ev.sent++;
+  }
+  unsigned long now = halMillis();
+  if (n == 0 && now - s.sentMs >= EVENTS_HEARTBEAT_MS)
+    n = snprintf(out, len, ": ping\n\n");
+  if (n)
+    s.sentMs = now;
+  return (int)n;
+}
+
+size_t eventsReport(char *buf, size_t len)
+{
+  int n = snprintf(buf, len,
+                   "events %lu published, %lu sent; subscribers %d of %d, %lu subscribed, %lu refused, "
+                   "%lu dropped (slow), %lu closed\n",
+                   (unsigned long)ev.seq, ev.sent, ev.subscribers, EVENTS_MAX_SUBSCRIBERS, ev.subscribed, ev.refused,
+                   ev.dropped, ev.closed);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
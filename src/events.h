@@ -0,0 +1,44 @@
+// Live events for dashboards: Server-Sent Events stream of latched frames and new readings
+// Events go into a ring of EVENTS_RING entries with a running sequence number. Each subscriber
+// (an /api/events connection) keeps only the sequence number of the next event it needs; its fill
+// callback (web_server.h) formats whatever is new into the connection's transmit buffer.
+// At most EVENTS_MAX_SUBSCRIBERS streams are open at once, the rest of the connection slots stay
+// free for requests. A stream holds its slot for as long as it is open, so the root page does not
+// subscribe; it polls /api/state while visible and the streams are left to dashboards. A subscriber that falls a whole ring behind (its socket does not drain) is
+// dropped: the stream ends and the client's EventSource reconnects and starts from the current state.
+// A comment line every EVENTS_HEARTBEAT_MS keeps proxies from closing an idle stream and finds
+// subscribers that went away.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const int EVENTS_RING = 16;
+const int EVENTS_MAX_SUBSCRIBERS = 2;
+const unsigned long EVENTS_HEARTBEAT_MS = 15000;
+
+/// @brief Position of one subscriber, copied into its connection
+struct EventsSub
+{
+  uint32_t next;        // sequence number of the next event to send
+  unsigned long sentMs; // last write, for the heartbeat
+  bool snapshot;        // current state sent
+};
+
+/// @brief A new displayed reading (deci-degrees)
+void eventsReading(int32_t deci);
+
+/// @brief Publish the panel frame when the display task latched a new one (call every loop)
+void eventsPoll();
+
+/// @brief Take a subscriber slot
+/// @return false if all EVENTS_MAX_SUBSCRIBERS are taken
+bool eventsSubscribe(EventsSub &s);
+
+/// @brief WebFill for the stream: snapshot, then new events as "event: frame|reading" with JSON data
+int eventsFill(void *ctx, uint8_t *buf, size_t len);
+
+/// @brief Write subscriber and event counts as text
+/// @return Number of chars written
+size_t eventsReport(char *buf, size_t len);
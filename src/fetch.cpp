@@ -0,0 +1,337 @@
+// Thermometer fetch, see fetch.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "fetch.h"
+#include "trace.h"
+#include "temp_json.h"
+#include "sources.h"
+
+// latency window for the p95 hedge delay
+const int FETCH_LATENCY_WINDOW = 32;
+
+struct FetchStats
+{
+  unsigned long requests;
+  unsigned long failures;
+  unsigned long won;
+  unsigned long cancelled;
+  unsigned long busy; // skipped, slot still held by a cancelled request
+  unsigned long newConn;
+  unsigned long reusedConn;
+  uint64_t newUsTotal;
+  uint64_t reusedUsTotal;
+  unsigned long maxUs;
+  unsigned long latencyMs[FETCH_LATENCY_WINDOW]; // successful requests, ring
+  int latencyCount;
+  int latencyNext;
+};
+
+// one fetch in progress
+struct FetchRun
+{
+  bool running;
+  const char *urls[SENSOR_SOURCE_COUNT];
+  bool started[SENSOR_SOURCE_COUNT];
+  bool active[SENSOR_SOURCE_COUNT];
+  uint32_t id[SENSOR_SOURCE_COUNT]; // HAL request id
+  unsigned long startUs[SENSOR_SOURCE_COUNT];
+  unsigned long t0;
+};
+
+static FetchStats fetchStats[SENSOR_SOURCE_COUNT];
+static FetchRun run;
+static FetchMode mode = FETCH_HEDGED;
+static unsigned long connectTimeout = FETCH_CONNECT_TIMEOUT;
+static unsigned long readTimeout = FETCH_READ_TIMEOUT;
+static HalHttpResult result;
+// one payload reader per source, fed from the request's worker
+static TempJsonParser parsers[SENSOR_SOURCE_COUNT];
+
+static const char *const SOURCE_NAMES[SENSOR_SOURCE_COUNT] = {"primary", "fallback"};
+static const char *const MODE_NAMES[FETCH_MODE_COUNT] = {"sequential", "race", "hedged"};
+
+void fetchSetMode(FetchMode m)
+{
+  mode = m;
+}
+
+FetchMode fetchGetMode()
+{
+  return mode;
+}
+
+void fetchSetTimeouts(unsigned long connectMs, unsigned long readMs)
+{
+  connectTimeout = connectMs;
+  readTimeout = readMs;
+}
+
+const char *fetchModeName(FetchMode m)
+{
+  return MODE_NAMES[m];
+}
+
+bool fetchModeFromName(const char *name, FetchMode &m)
+{
+  for (int i = 0; i < FETCH_MODE_COUNT; i++)
+  {
+    if (strcmp(name, MODE_NAMES[i]) == 0)
+    {
+      m = (FetchMode)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void fetchUrlForIp(uint32_t ip, char *buf, size_t len)
+{
+  snprintf(buf, len, "http://%u.%u.%u.%u/json", (unsigned)(ip & 0xff), (unsigned)((ip >> 8) & 0xff),
+           (unsigned)((ip >> 16) & 0xff), (unsigned)(ip >> 24));
+}
+
+unsigned long fetchHedgeDelay()
+{
+  const FetchStats &st = fetchStats[SENSOR_PRIMARY];
+  if (st.latencyCount < FETCH_HEDGE_SAMPLES)
+    return FETCH_HEDGE_DEFAULT;
+
+  // p95 by insertion sort of a copy, window is small
+  unsigned long v[FETCH_LATENCY_WINDOW];
+  int n = st.latencyCount;
+  for (int i = 0; i < n; i++)
+  {
+    unsigned long x = st.latencyMs[i];
+    int j = i;
+    for (; j > 0 && v[j - 1] > x; j--)
+      v[j] = v[j - 1];
+    v[j] = x;
+  }
+  unsigned long p95 = v[(n * 95 + 99) / 100 - 1];
+  return p95 < FETCH_HEDGE_MIN ? FETCH_HEDGE_MIN : p95;
+}
+
+static bool configured(int i)
+{
+  return run.urls[i] != nullptr && run.urls[i][0] != '\0';
+}
+
+/// @brief HTTP body sink: streams the payload into the source's reader
+static bool fetchSink(void *ctx, const char *data, size_t len)
+{
+  TempJsonParser &p = *(TempJsonParser *)ctx;
+  if (data == nullptr)
+  {
+    tempJsonInit(p);
+    return true;
+  }
+  return tempJsonFeed(p, data, len) == TEMP_JSON_MORE;
+}
+
+static void sourceStart(int i)
+{
+  run.started[i] = true;
+  run.startUs[i] = halMicros();
+  run.id[i] = halHttpStart(i, run.urls[i], connectTimeout, readTimeout, fetchSink, &parsers[i]);
+  run.active[i] = run.id[i] != 0;
+  // slot still busy with a request cancelled in an earlier round: skip the source this round,
+  // it lost a race and says nothing about the source's health
+  if (run.active[i])
+    fetchStats[i].requests++;
+  else
+    fetchStats[i].busy++;
+}
+
+/// @brief Next configured source not started yet
+/// @return -1 if none
+static int nextSource()
+{
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
+  {
+    if (configured(i) && !run.started[i])
+      return i;
+  }
+  return -1;
+}
+
+static bool anyActive()
+{
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
+  {
+    if (run.active[i])
+      return true;
+  }
+  return false;
+}
+
+/// @brief Collect finished request of source i
+/// @return Valid temperature or error code <= -100
+static float sourceCollect(int i, unsigned long us, int httpCode, bool reused)
+{
+  FetchStats &st = fetchStats[i];
+  if (us > st.maxUs)
+    st.maxUs = us;
+
+  int src = sourceFind(SOURCE_HTTP, i);
+  if (httpCode != 200)
+  {
+    st.failures++;
+    sourceFailure(src);
+    return -101.0f; // error: HTTP fail
+  }
+
+  if (reused)
+  {
+    st.reusedConn++;
+    st.reusedUsTotal += us;
+  }
+  else
+  {
+    st.newConn++;
+    st.newUsTotal += us;
+  }
+  st.latencyMs[st.latencyNext] = us / 1000;
+  st.latencyNext = (st.latencyNext + 1) % FETCH_LATENCY_WINDOW;
+  if (st.latencyCount < FETCH_LATENCY_WINDOW)
+    st.latencyCount++;
+
+  if (tempJsonFinish(parsers[i]) != TEMP_JSON_FOUND)
+  {
+    st.failures++;
+    sourceFailure(src);
+    return -101.0f; // error: no temperature field
+  }
+  if (!sourceReading(src, parsers[i].deci, us >= 1000 ? us / 1000 : 1))
+  {
+    st.failures++;
+    return -101.0f; // error: out of range, let the next source try
+  }
+  return parsers[i].deci / 10.0f;
+}
+
+static void fetchFinish()
+{
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
+  {
+    if (run.active[i])
+    {
+      halHttpCancel(i);
+      fetchStats[i].cancelled++;
+      run.active[i] = false;
+    }
+  }
+  run.running = false;
+
+#if TRACE_ENABLED
+  traceRecord(TRACE_FETCH, (halMicros() - run.t0) * halCyclesPerUs());
+#endif
+}
+
+void fetchStart(const char *const urls[SENSOR_SOURCE_COUNT])
+{
+  if (run.running)
+    fetchFinish();
+
+  // results of cancelled requests that finished meanwhile
+  while (halHttpResult(result))
+    ;
+
+  memset(&run, 0, sizeof(run));
+  run.running = true;
+  run.t0 = halMicros();
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
+    run.urls[i] = urls[i];
+
+  if (halWifiStatus() != HAL_WIFI_CONNECTED)
+    return; // fetchPoll() reports the error
+
+  int first = nextSource();
+  if (first >= 0)
+    sourceStart(first);
+  for (int i = nextSource(); mode == FETCH_RACE && i >= 0; i = nextSource())
+    sourceStart(i);
+}
+
+bool fetchPoll(float &temp, int &source)
+{
+  if (!run.running)
+    return false;
+
+  temp = -101.0f;
+  source = -1;
+
+  if (halWifiStatus() != HAL_WIFI_CONNECTED)
+  {
+    temp = -102.0f; // error: no WiFi
+    fetchFinish();
+    return true;
+  }
+
+  while (halHttpResult(result))
+  {
+    int i = result.slot;
+    if (i < 0 || i >= SENSOR_SOURCE_COUNT || !run.active[i] || run.id[i] != result.id)
+      continue; // stale result of a cancelled request
+
+    run.active[i] = false;
+    float t = sourceCollect(i, halMicros() - run.startUs[i], result.code, result.reused);
+    if (t > -100.0f)
+    {
+      temp = t;
+      source = i;
+      fetchStats[i].won++;
+      fetchFinish();
+      return true;
+    }
+  }
+
+  // bring in the next source: after a failure, or (hedged) when the primary is slow
+  int next = nextSource();
+  if (next >= 0 && (!anyActive() || (mode == FETCH_HEDGED && halMicros() - run.t0 >= fetchHedgeDelay() * 1000UL)))
+  {
+    sourceStart(next);
+    return false;
+  }
+
+  if (anyActive())
+    return false;
+
+  bool any = false;
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
+    any = any || configured(i);
+  if (!any)
+    temp = -103.0f; // error: no source address known
+  fetchFinish();
+  return true;
+}
+
+void fetchCounters(int source, FetchCounters &c)
+{
+  const FetchStats &st = fetchStats[source];
+  c.name = SOURCE_NAMES[source];
+  c.requests = st.requests;
+  c.failures = st.failures;
+  c.cancelled = st.cancelled;
+  c.responses = st.newConn + st.reusedConn;
+  c.latencyUs = st.newUsTotal + st.reusedUsTotal;
+  c.maxUs = st.maxUs;
+}
+
+size_t fetchStatsReport(char *buf, size_t len)
+{
+  size_t n = snprintf(buf, len, "mode %s, hedge delay %lu ms, timeouts connect %lu ms read %lu ms\n%-9s %8s %8s %6s %9s %6s %8s %12s %12s %10s\n",
+                      fetchModeName(mode), fetchHedgeDelay(), connectTimeout, readTimeout, "source", "requests", "failed", "won", "cancelled",
+                      "busy", "reused", "new_avg_us", "reuse_avg_us", "max_us");
+  for (int i = 0; i < SENSOR_SOURCE_COUNT && n < len; i++)
+  {
+    const FetchStats &st = fetchStats[i];
+    unsigned long newAvg = st.newConn ? (unsigned long)(st.newUsTotal / st.newConn) : 0;
+    unsigned long reusedAvg = st.reusedConn ? (unsigned long)(st.reusedUsTotal / st.reusedConn) : 0;
+    n += snprintf(buf + n, len - n, "%-9s %8lu %8lu %6lu %9lu %6lu %8lu %12lu %12lu %10lu\n", SOURCE_NAMES[i],
+                  st.requests, st.failures, st.won, st.cancelled, st.busy, st.reusedConn, newAvg, reusedAvg, st.maxUs);
+  }
+  return n < len ? n : len - 1;
+}
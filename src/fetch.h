@@ -0,0 +1,81 @@
+// Thermometer fetch over persistent keep-alive connections (one per source)
+// Requests run in the background (halHttpStart), results come back through the HAL result queue. Depending on the mode the sources
+// are tried one after another, raced, or the fallback is hedged in after the primary's p95 latency;
+// the first valid reading wins and the other requests are cancelled.
+// Keeps per-source latency stats split by new vs reused connection; every result is also reported
+// to the source registry (sources.h, kind SOURCE_HTTP, id = SensorSource).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// thermometer sources, also HAL HTTP slot numbers
+enum SensorSource
+{
+  SENSOR_PRIMARY,  // thermometer behind the mDNS name (resolver cache address)
+  SENSOR_FALLBACK, // second thermometer, optional
+  SENSOR_SOURCE_COUNT
+};
+
+enum FetchMode
+{
+  FETCH_SEQUENTIAL, // fallback only after primary failed
+  FETCH_RACE,       // all sources at once
+  FETCH_HEDGED,     // fallback once primary is slower than its p95 latency
+  FETCH_MODE_COUNT
+};
+
+// hedge delay while fewer than FETCH_HEDGE_SAMPLES latencies are known
+const unsigned long FETCH_HEDGE_DEFAULT = 1000; // ms
+const unsigned long FETCH_HEDGE_MIN = 20;       // ms
+const int FETCH_HEDGE_SAMPLES = 8;
+
+// default request deadlines, the thermometer is on the LAN
+const unsigned long FETCH_CONNECT_TIMEOUT = 1000; // ms
+const unsigned long FETCH_READ_TIMEOUT = 2000;    // ms
+
+void fetchSetMode(FetchMode mode);
+FetchMode fetchGetMode();
+const char *fetchModeName(FetchMode mode);
+/// @return false if name is unknown
+bool fetchModeFromName(const char *name, FetchMode &mode);
+
+/// @brief Set request deadlines
+/// @param connectMs  TCP connect (new connection only)
+/// @param readMs     Response after the request is sent
+void fetchSetTimeouts(unsigned long connectMs, unsigned long readMs);
+
+/// @brief Build thermometer JSON url for an address (network byte order as in IPAddress)
+void fetchUrlForIp(uint32_t ip, char *buf, size_t len);
+
+/// @brief Start reading outdoor temperature from the configured sources
+/// @param urls  Url per source, nullptr or "" = source not configured
+void fetchStart(const char *const urls[SENSOR_SOURCE_COUNT]);
+
+/// @brief Drive running fetch, call every loop turn
+/// @param temp    Output: temperature in Celsius or negative error code <= -100
+/// @param source  Output: source of the reading
+/// @return true once finished
+bool fetchPoll(float &temp, int &source);
+
+/// @brief Current hedge delay (primary p95 latency)
+unsigned long fetchHedgeDelay();
+
+/// @brief Request counters of one source
+struct FetchCounters
+{
+  const char *name; // "primary", "fallback"
+  unsigned long requests;
+  unsigned long failures;
+  unsigned long cancelled;
+  unsigned long responses; // valid HTTP responses, timed
+  uint64_t latencyUs;      // sum over responses
+  unsigned long maxUs;
+};
+
+void fetchCounters(int source, FetchCounters &c);
+
+/// @brief Write per-source fetch stats as text
+/// @return Number of chars written
+size_t fetchStatsReport(char *buf, size_t len);
@@ -0,0 +1,200 @@
+// Hardware abstraction layer
+// Thin interface over everything the firmware needs from the platform: clock, open-drain GPIO,
+// serial log, NVS, WiFi, mDNS, UDP, HTTP client, TCP stream client and TCP server.
+// Backends: hal_arduino.cpp (ESP32 / Arduino) and hal_host.cpp (Linux, virtual clock).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#define HAL_RTC_DATA RTC_DATA_ATTR
+#define HAL_RTC_NOINIT RTC_NOINIT_ATTR
+#else
+#define HAL_RTC_DATA
+#define HAL_RTC_NOINIT
+#endif
+
+#if defined(__GNUC__)
+#define HAL_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define HAL_PRINTF(fmt, args)
+#endif
+
+// ===== Clock =====
+unsigned long halMillis();
+unsigned long halMicros();
+void halDelay(unsigned long ms);
+void halDelayMicroseconds(unsigned int us);
+/// @brief CPU cycle counter (wraps), see halCyclesPerUs()
+uint32_t halCycles();
+uint32_t halCyclesPerUs();
+
+// ===== Heap =====
+/// @brief Free heap and largest allocatable block (fragmentation shows as largest << free)
+/// @param minFree  Lowest free heap since boot
+/// @return false if the platform does not report them (host)
+bool halHeapStats(size_t &freeBytes, size_t &largestBlock, size_t &minFree);
+
+// ===== Open-drain GPIO =====
+/// @brief Drive line LOW
+void halPinLow(int pin);
+/// @brief Release line (high-Z, pull-up pulls it HIGH)
+void halPinRelease(int pin);
+/// @brief Read line level
+/// @return true if HIGH
+bool halPinRead(int pin);
+
+// ===== Serial =====
+void halSerialBegin(unsigned long baud);
+/// @brief printf-style log line(s) to serial
+void halLog(const char *fmt, ...) HAL_PRINTF(1, 2);
+/// @brief Write raw text to serial
+void halSerialWrite(const char *text);
+/// @brief Write raw bytes to serial (binary protocol frames)
+void halSerialWriteBytes(const uint8_t *data, size_t len);
+/// @brief Take received bytes (drains the UART driver's receive buffer, never waits)
+/// @return Bytes copied, 0 if none available
+size_t halSerialReadBytes(uint8_t *buf, size_t len);
+
+// ===== Persistent storage (NVS) =====
+/// @brief Read blob, succeeds only if stored size equals len
+bool halStoreRead(const char *ns, const char *key, void *buf, size_t len);
+bool halStoreWrite(const char *ns, const char *key, const void *buf, size_t len);
+void halStoreRemove(const char *ns, const char *key);
+
+// ===== WiFi (station) =====
+enum HalWifiStatus
+{
+  HAL_WIFI_IDLE,
+  HAL_WIFI_NO_SSID,
+  HAL_WIFI_CONNECT_FAILED,
+  HAL_WIFI_CONNECTION_LOST,
+  HAL_WIFI_DISCONNECTED,
+  HAL_WIFI_CONNECTED,
+  HAL_WIFI_UNKNOWN
+};
+
+// parameters of an established link, also used as target for fast connect
+struct HalWifiLink
+{
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t ip; // network byte order as in IPAddress, 0 = DHCP
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+/// @brief Station mode, hostname, auto reconnect, no modem sleep
+void halWifiInit(const char *hostname);
+/// @brief Start connecting
+/// @param target  Targeted connect (BSSID + channel, static IP if ip != 0), nullptr = full scan + DHCP
+void halWifiBegin(const char *ssid, const char *password, const HalWifiLink *target);
+/// @brief Drop connection, keep radio on
+void halWifiDisconnect();
+/// @brief Drop connection and turn radio off
+void halWifiOff();
+HalWifiStatus halWifiStatus();
+/// @brief Parameters of current connection
+/// @return false if not connected
+bool halWifiGetLink(HalWifiLink &link);
+
+// ===== mDNS =====
+// one query at a time, resolved in the background
+enum HalMdnsState
+{
+  HAL_MDNS_FAILED = -1, // no responder answered (or no query started)
+  HAL_MDNS_PENDING = 0,
+  HAL_MDNS_OK = 1
+};
+
+/// @brief Start resolving "<name>.local" by multicast query
+/// @return false if a query is still running
+bool halMdnsStart(const char *host, unsigned long timeoutMs);
+/// @brief Poll query started by halMdnsStart(), result is reported once
+/// @param ip   Output: address, network byte order as in IPAddress
+/// @param ttl  Output: record TTL in seconds, 0 if the resolver does not report it
+HalMdnsState halMdnsPoll(uint32_t &ip, uint32_t &ttl);
+
+// ===== HTTP client =====
+// one long-lived keep-alive connection per slot (one slot per sensor source); requests run in
+// the background, the body is streamed to a sink in small chunks (never buffered whole) and
+// finished requests are posted to a result queue read by halHttpResult()
+const int HAL_HTTP_SLOTS = 4;
+
+// body consumer, called from the request's worker: (nullptr, 0) when a 200 response body starts,
+// then consecutive chunks; return false when no more data is wanted
+typedef bool (*HalHttpSink)(void *ctx, const char *data, size_t len);
+
+// result code: response body framing (Transfer-Encoding: chunked) could not be decoded
+const int HAL_HTTP_BAD_FRAMING = -20;
+
+struct HalHttpResult
+{
+  uint32_t id; // as returned by halHttpStart()
+  int slot;
+  int code;    // HTTP status code or negative error
+  bool reused; // request went over an already open connection
+};
+
+/// @brief Start GET on slot's persistent connection
+/// @param connectTimeoutMs  TCP connect deadline (new connection only)
+/// @param readTimeoutMs     Deadline for the response once the request is sent
+/// @param sink              Body consumer, ctx is passed through
+/// @return Request id, 0 if the slot is still busy with a previous (cancelled) request
+uint32_t halHttpStart(int slot, const char *url, unsigned long connectTimeoutMs, unsigned long readTimeoutMs,
+                      HalHttpSink sink, void *ctx);
+/// @brief Take next finished request from the result queue (non-blocking)
+/// @return false if queue is empty
+bool halHttpResult(HalHttpResult &result);
+/// @brief Abandon running request, it posts no result
+void halHttpCancel(int slot);
+
+// ===== TCP stream client =====
+// one raw connection (MQTT), connected in the background, reads and writes never block
+enum HalTcpState
+{
+  HAL_TCP_CLOSED, // never connected, connect failed or connection lost
+  HAL_TCP_CONNECTING,
+  HAL_TCP_CONNECTED
+};
+
+/// @brief Start connecting, an open connection is closed first
+/// @return false if a connect is still running
+bool halTcpConnect(const char *host, uint16_t port, unsigned long timeoutMs);
+HalTcpState halTcpState();
+/// @brief Queue data for sending
+/// @return false if not connected or the send buffer is full (connection is closed then)
+bool halTcpWrite(const uint8_t *data, size_t len);
+/// @brief Take received data (non-blocking)
+/// @return Bytes copied, 0 if none
+size_t halTcpRead(uint8_t *buf, size_t len);
+void halTcpClose();
+
+// ===== UDP =====
+/// @brief Listen for datagrams on port
+/// @param group  Multicast group to join as well (network byte order as in IPAddress), 0 = none
+bool halUdpBegin(uint16_t port, uint32_t group);
+/// @brief Take next received datagram (non-blocking)
+/// @return Datagram length (truncated to len), 0 if none
+size_t halUdpRead(uint8_t *buf, size_t len);
+
+// ===== TCP server (non-blocking, for web_server.h) =====
+/// @brief Listen for connections on port
+bool halListen(uint16_t port);
+/// @brief Take the next pending connection
+/// @return Connection id >= 0, -1 if none
+int halAccept();
+/// @brief Take received data
+/// @return Bytes copied, 0 if none yet, -1 if the peer closed or the connection failed
+int halConnRead(int conn, uint8_t *buf, size_t len);
+/// @brief Queue data for sending
+/// @return Bytes taken (may be fewer than len), 0 if the send buffer is full, -1 if the connection failed
+int halConnWrite(int conn, const uint8_t *data, size_t len);
+/// @brief Close, data already taken is still sent
+void halConnClose(int conn);
+/// @brief IPv4 address of the client (network byte order), 0 if unknown
+uint32_t halConnPeer(int conn);
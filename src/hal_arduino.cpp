@@ -0,0 +1,658 @@
+// HAL backend for ESP32 / Arduino, see hal.h
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include "hal.h"
+#include "http_chunked.h"
+
+static WiFiUDP udp;
+
+static const char *wifiHostname = "";
+static bool mdnsStarted = false;
+
+// ===== Clock =====
+unsigned long halMillis() { return millis(); }
+unsigned long halMicros() { return micros(); }
+void halDelay(unsigned long ms) { delay(ms); }
+void halDelayMicroseconds(unsigned int us) { delayMicroseconds(us); }
+uint32_t halCycles() { return ESP.getCycleCount(); }
+uint32_t halCyclesPerUs() { return ESP.getCpuFreqMHz(); }
+
+// ===== Heap =====
+bool halHeapStats(size_t &freeBytes, size_t &largestBlock, size_t &minFree)
+{
+  freeBytes = ESP.getFreeHeap();
+  largestBlock = ESP.getMaxAllocHeap();
+  minFree = ESP.getMinFreeHeap();
+  return true;
+}
+
+// ===== Open-drain GPIO =====
+void halPinLow(int pin)
+{
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
+}
+
+void halPinRelease(int pin)
+{
+  pinMode(pin, INPUT); // high-Z, pull-up will pull line HIGH
+}
+
+bool halPinRead(int pin)
+{
+  return digitalRead(pin) == HIGH;
+}
+
+// ===== Serial =====
+void halSerialBegin(unsigned long baud)
+{
+  // room for a burst of protocol frames while the loop is busy elsewhere (filled by the UART ISR)
+  Serial.setRxBufferSize(1024);
+  Serial.begin(baud);
+}
+
+void halLog(const char *fmt, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  Serial.print(buf);
+}
+
+void halSerialWrite(const char *text)
+{
+  Serial.print(text);
+}
+
+void halSerialWriteBytes(const uint8_t *data, size_t len)
+{
+  Serial.write(data, len);
+}
+
+size_t halSerialReadBytes(uint8_t *buf, size_t len)
+{
+  int n = Serial.available();
+  if (n <= 0)
+    return 0;
+  return Serial.readBytes(buf, (size_t)n < len ? (size_t)n : len);
+}
+
+// ===== Persistent storage (NVS) =====
+bool halStoreRead(const char *ns, const char *key, void *buf, size_t len)
+{
+  Preferences prefs;
+  if (!prefs.begin(ns, true))
+    return false;
+  bool ok = prefs.getBytesLength(key) == len && prefs.getBytes(key, buf, len) == len;
+  prefs.end();
+  return ok;
+}
+
+bool halStoreWrite(const char *ns, const char *key, const void *buf, size_t len)
+{
+  Preferences prefs;
+  if (!prefs.begin(ns, false))
+    return false;
+  bool ok = prefs.putBytes(key, buf, len) == len;
+  prefs.end();
+  return ok;
+}
+
+void halStoreRemove(const char *ns, const char *key)
+{
+  Preferences prefs;
+  if (!prefs.begin(ns, false))
+    return;
+  prefs.remove(key);
+  prefs.end();
+}
+
+// ===== WiFi =====
+void halWifiInit(const char *hostname)
+{
+  wifiHostname = hostname;
+  WiFi.setHostname(hostname);
+  WiFi.setAutoConnect(true);
+  WiFi.setAutoReconnect(true);
+  WiFi.setSleep(false);
+  WiFi.mode(WIFI_STA);
+}
+
+void halWifiBegin(const char *ssid, const char *password, const HalWifiLink *target)
+{
+  WiFi.mode(WIFI_STA);
+
+  if (target == nullptr)
+  {
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // DHCP
+    WiFi.begin(ssid, password);
+    return;
+  }
+
+  if (target->ip != 0)
+    WiFi.config(IPAddress(target->ip), IPAddress(target->gateway), IPAddress(target->subnet), IPAddress(target->dns));
+  else
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+  WiFi.begin(ssid, password, target->channel, target->bssid);
+}
+
+void halWifiDisconnect()
+{
+  WiFi.disconnect(false, false);
+}
+
+void halWifiOff()
+{
+  WiFi.disconnect(true, true);
+  WiFi.mode(WIFI_OFF);
+}
+
+HalWifiStatus halWifiStatus()
+{
+  switch (WiFi.status())
+  {
+  case WL_CONNECTED:
+    return HAL_WIFI_CONNECTED;
+  case WL_NO_SSID_AVAIL:
+    return HAL_WIFI_NO_SSID;
+  case WL_CONNECT_FAILED:
+    return HAL_WIFI_CONNECT_FAILED;
+  case WL_CONNECTION_LOST:
+    return HAL_WIFI_CONNECTION_LOST;
+  case WL_DISCONNECTED:
+    return HAL_WIFI_DISCONNECTED;
+  case WL_IDLE_STATUS:
+    return HAL_WIFI_IDLE;
+  default:
+    return HAL_WIFI_UNKNOWN;
+  }
+}
+
+bool halWifiGetLink(HalWifiLink &link)
+{
+  const uint8_t *bssid = WiFi.BSSID();
+  if (WiFi.status() != WL_CONNECTED || bssid == nullptr)
+    return false;
+
+  memcpy(link.bssid, bssid, sizeof(link.bssid));
+  link.channel = (uint8_t)WiFi.channel();
+  link.ip = (uint32_t)WiFi.localIP();
+  link.gateway = (uint32_t)WiFi.gatewayIP();
+  link.subnet = (uint32_t)WiFi.subnetMask();
+  link.dns = (uint32_t)WiFi.dnsIP();
+  return true;
+}
+
+// ===== mDNS =====
+// queryHost() blocks for up to the timeout, so queries run in a worker task
+const uint32_t MDNS_WORKER_STACK = 3072;
+
+struct MdnsJob
+{
+  TaskHandle_t task; // created on first query
+  volatile HalMdnsState state;
+  volatile bool running;
+  char name[64]; // without ".local"
+  unsigned long timeoutMs;
+  uint32_t ip;
+};
+
+static MdnsJob mdnsJob = {nullptr, HAL_MDNS_FAILED, false, "", 0, 0};
+
+static void mdnsWorker(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!mdnsStarted)
+      mdnsStarted = MDNS.begin(wifiHostname);
+    mdnsJob.ip = mdnsStarted ? (uint32_t)MDNS.queryHost(mdnsJob.name, mdnsJob.timeoutMs) : 0;
+    mdnsJob.state = mdnsJob.ip != 0 ? HAL_MDNS_OK : HAL_MDNS_FAILED;
+    mdnsJob.running = false;
+  }
+}
+
+bool halMdnsStart(const char *host, unsigned long timeoutMs)
+{
+  if (mdnsJob.running)
+    return false;
+  if (mdnsJob.task == nullptr &&
+      xTaskCreate(mdnsWorker, "mdns", MDNS_WORKER_STACK, nullptr, 1, &mdnsJob.task) != pdPASS)
+  {
+    mdnsJob.task = nullptr;
+    return false;
+  }
+
+  // responder wants the bare name
+  strncpy(mdnsJob.name, host, sizeof(mdnsJob.name) - 1);
+  mdnsJob.name[sizeof(mdnsJob.name) - 1] = '\0';
+  char *suffix = strstr(mdnsJob.name, ".local");
+  if (suffix != nullptr && suffix[6] == '\0')
+    *suffix = '\0';
+
+  mdnsJob.timeoutMs = timeoutMs;
+  mdnsJob.state = HAL_MDNS_PENDING;
+  mdnsJob.running = true;
+  xTaskNotifyGive(mdnsJob.task);
+  return true;
+}
+
+HalMdnsState halMdnsPoll(uint32_t &ip, uint32_t &ttl)
+{
+  if (mdnsJob.running)
+    return HAL_MDNS_PENDING;
+  HalMdnsState state = mdnsJob.state;
+  mdnsJob.state = HAL_MDNS_FAILED; // report once
+  ip = mdnsJob.ip;
+  ttl = 0; // MDNS.queryHost() does not report the record's TTL
+  return state;
+}
+
+// ===== HTTP client =====
+// HTTPClient with setReuse(true) keeps the TCP connection open after end() as long as the
+// server allows keep-alive; begin() to the same host:port then skips DNS/mDNS and the handshake.
+// HTTPClient blocks, so every slot runs its requests in a small worker task that posts the result
+// to a queue; the loop only starts requests and reads results. A cancelled request posts nothing
+// and stops reading its body at once (the connection is dropped); one still waiting for the
+// response head blocks in HTTPClient until its deadline, halHttpStart() reports the slot busy.
+// The body is read straight from the socket in HTTP_CHUNK pieces (no getString() heap copy);
+// a chunked body is de-chunked in place on the way (http_chunked.h).
+const uint32_t HTTP_WORKER_STACK = 4096;
+const size_t HTTP_CHUNK = 64;
+// every slot has at most one request in flight, room for stale ones as well
+const int HTTP_RESULT_QUEUE_LEN = HAL_HTTP_SLOTS * 2;
+
+struct HttpJob
+{
+  TaskHandle_t task; // created on first use of the slot
+  volatile bool running;
+  volatile bool cancelled;
+  uint32_t id;
+  char url[128];
+  unsigned long connectTimeoutMs;
+  unsigned long readTimeoutMs;
+  HalHttpSink sink;
+  void *ctx;
+};
+
+static WiFiClient httpClients[HAL_HTTP_SLOTS];
+static HTTPClient httpSessions[HAL_HTTP_SLOTS];
+static HttpJob httpJobs[HAL_HTTP_SLOTS];
+static QueueHandle_t httpResults = nullptr;
+static uint32_t httpNextId = 1;
+
+static const char *const HTTP_HEADER_KEYS[] = {"Transfer-Encoding"};
+static bool httpHeadersCollected[HAL_HTTP_SLOTS];
+
+/// @brief Stream response body to the sink, drain what the sink does not want
+/// @param badFraming  Output: chunked framing could not be decoded
+/// @return true if the whole body was read (connection can be reused)
+static bool httpStreamBody(HTTPClient &http, const HttpJob &job, bool &badFraming)
+{
+  WiFiClient *stream = http.getStreamPtr();
+  int remaining = http.getSize(); // -1: no Content-Length (chunked or until close)
+  bool chunked = http.header(HTTP_HEADER_KEYS[0]).equalsIgnoreCase("chunked");
+  HttpChunked dechunk;
+  httpChunkedInit(dechunk);
+  char chunk[HTTP_CHUNK];
+  bool wanted = true;
+  unsigned long lastData = millis();
+  badFraming = false;
+
+  job.sink(job.ctx, nullptr, 0);
+  while (remaining != 0 && stream != nullptr && (stream->connected() || stream->available()))
+  {
+    if (job.cancelled)
+      return false; // lost the race, rest of the body is not wanted
+    int avail = stream->available();
+    if (avail <= 0)
+    {
+      if (millis() - lastData >= job.readTimeoutMs)
+        return false;
+      delay(1);
+      continue;
+    }
+
+    size_t want = (size_t)avail < sizeof(chunk) ? (size_t)avail : sizeof(chunk);
+    if (remaining > 0 && (size_t)remaining < want)
+      want = remaining;
+    int n = stream->read((uint8_t *)chunk, want);
+    if (n <= 0)
+      return false;
+    lastData = millis();
+    if (remaining > 0)
+      remaining -= n;
+
+    size_t got = n, used = n;
+    if (chunked)
+    {
+      n = httpChunkedFeed(dechunk, chunk, n, used);
+      if (dechunk.status == HTTP_CHUNKED_ERROR)
+      {
+        badFraming = true;
+        return false;
+      }
+    }
+    if (wanted)
+      wanted = job.sink(job.ctx, chunk, n);
+    else if (remaining < 0 && !chunked)
+      return false; // unknown length: cannot drain, drop the connection instead
+    if (dechunk.status == HTTP_CHUNKED_DONE)
+      return used == got; // bytes past the body: server is out of step, drop the connection
+  }
+  return remaining == 0;
+}
+
+/// @brief Blocking GET on slot's persistent connection (worker task)
+static int httpGet(int slot, const HttpJob &job, bool *reused)
+{
+  *reused = false;
+
+  WiFiClient &client = httpClients[slot];
+  HTTPClient &http = httpSessions[slot];
+  int httpCode = -1;
+
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    *reused = client.connected();
+    http.setReuse(true);
+    if (!httpHeadersCollected[slot])
+    {
+      http.collectHeaders(HTTP_HEADER_KEYS, 1); // kept across begin()/end() of the session
+      httpHeadersCollected[slot] = true;
+    }
+    http.setConnectTimeout(job.connectTimeoutMs);
+    http.setTimeout(job.readTimeoutMs);
+    http.begin(client, job.url);
+    httpCode = http.GET();
+    if (httpCode > 0 || !*reused)
+      break;
+    // server closed the idle connection meanwhile -> reconnect once
+    http.end();
+    client.stop();
+  }
+
+  if (httpCode != 200)
+  {
+    http.end();
+    return httpCode;
+  }
+  if (job.cancelled)
+  {
+    // body still on the wire
+    http.end();
+    client.stop();
+    return httpCode;
+  }
+
+  bool badFraming;
+  if (!httpStreamBody(http, job, badFraming))
+  {
+    // rest of the body still on the wire
+    http.end();
+    client.stop();
+    return badFraming ? HAL_HTTP_BAD_FRAMING : httpCode;
+  }
+  http.end(); // keeps connection open for reuse
+  return httpCode;
+}
+
+static void httpWorker(void *arg)
+{
+  int slot = (int)(intptr_t)arg;
+  HttpJob &job = httpJobs[slot];
+  HalHttpResult r;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    r.id = job.id;
+    r.slot = slot;
+    r.code = httpGet(slot, job, &r.reused);
+    if (!job.cancelled)
+      xQueueSend(httpResults, &r, 0); // full queue: result is lost, fetch runs into its deadline
+    job.running = false;
+  }
+}
+
+uint32_t halHttpStart(int slot, const char *url, unsigned long connectTimeoutMs, unsigned long readTimeoutMs,
+                      HalHttpSink sink, void *ctx)
+{
+  if (slot < 0 || slot >= HAL_HTTP_SLOTS)
+    return 0;
+  HttpJob &job = httpJobs[slot];
+  if (job.running)
+    return 0; // previous (cancelled) request still running
+
+  if (httpResults == nullptr)
+    httpResults = xQueueCreate(HTTP_RESULT_QUEUE_LEN, sizeof(HalHttpResult));
+  if (httpResults == nullptr)
+    return 0;
+  if (job.task == nullptr &&
+      xTaskCreate(httpWorker, "http", HTTP_WORKER_STACK, (void *)(intptr_t)slot, 1, &job.task) != pdPASS)
+  {
+    job.task = nullptr;
+    return 0;
+  }
+
+  strncpy(job.url, url, sizeof(job.url) - 1);
+  job.url[sizeof(job.url) - 1] = '\0';
+  job.connectTimeoutMs = connectTimeoutMs;
+  job.readTimeoutMs = readTimeoutMs;
+  job.sink = sink;
+  job.ctx = ctx;
+  job.id = httpNextId++;
+  if (httpNextId == 0)
+    httpNextId = 1;
+  job.cancelled = false;
+  job.running = true;
+  xTaskNotifyGive(job.task);
+  return job.id;
+}
+
+bool halHttpResult(HalHttpResult &result)
+{
+  return httpResults != nullptr && xQueueReceive(httpResults, &result, 0) == pdTRUE;
+}
+
+void halHttpCancel(int slot)
+{
+  if (slot < 0 || slot >= HAL_HTTP_SLOTS)
+    return;
+  if (httpJobs[slot].running)
+    httpJobs[slot].cancelled = true;
+}
+
+// ===== TCP stream client =====
+// WiFiClient::connect() blocks up to the timeout, so it runs in a worker task like mDNS queries;
+// once connected, available() / read() / write() on the lwIP socket do not block the loop
+const uint32_t TCP_WORKER_STACK = 3072;
+
+struct TcpJob
+{
+  TaskHandle_t task; // created on first connect
+  volatile bool running;
+  volatile bool connected;
+  char host[64];
+  uint16_t port;
+  unsigned long timeoutMs;
+};
+
+static WiFiClient tcpClient;
+static TcpJob tcpJob = {nullptr, false, false, "", 0, 0};
+
+static void tcpWorker(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    tcpJob.connected = tcpClient.connect(tcpJob.host, tcpJob.port, (int32_t)tcpJob.timeoutMs) == 1;
+    if (tcpJob.connected)
+      tcpClient.setNoDelay(true);
+    tcpJob.running = false;
+  }
+}
+
+bool halTcpConnect(const char *host, uint16_t port, unsigned long timeoutMs)
+{
+  if (tcpJob.running)
+    return false;
+  if (tcpJob.task == nullptr &&
+      xTaskCreate(tcpWorker, "tcp", TCP_WORKER_STACK, nullptr, 1, &tcpJob.task) != pdPASS)
+  {
+    tcpJob.task = nullptr;
+    return false;
+  }
+  halTcpClose();
+  strncpy(tcpJob.host, host, sizeof(tcpJob.host) - 1);
+  tcpJob.host[sizeof(tcpJob.host) - 1] = '\0';
+  tcpJob.port = port;
+  tcpJob.timeoutMs = timeoutMs;
+  tcpJob.running = true;
+  xTaskNotifyGive(tcpJob.task);
+  return true;
+}
+
+HalTcpState halTcpState()
+{
+  if (tcpJob.running)
+    return HAL_TCP_CONNECTING;
+  if (tcpJob.connected && !tcpClient.connected())
+    tcpJob.connected = false;
+  return tcpJob.connected ? HAL_TCP_CONNECTED : HAL_TCP_CLOSED;
+}
+
+bool halTcpWrite(const uint8_t *data, size_t len)
+{
+  if (halTcpState() != HAL_TCP_CONNECTED)
+    return false;
+  if (tcpClient.write(data, len) == len)
+    return true;
+  halTcpClose();
+  return false;
+}
+
+size_t halTcpRead(uint8_t *buf, size_t len)
+{
+  if (halTcpState() != HAL_TCP_CONNECTED || tcpClient.available() <= 0)
+    return 0;
+  int n = tcpClient.read(buf, len);
+  return n > 0 ? (size_t)n : 0;
+}
+
+void halTcpClose()
+{
+  if (tcpJob.running)
+    return; // worker owns the client until connect() returns
+  tcpClient.stop();
+  tcpJob.connected = false;
+}
+
+// ===== UDP =====
+bool halUdpBegin(uint16_t port, uint32_t group)
+{
+  // multicast socket is bound to INADDR_ANY, so unicast and broadcast still arrive
+  if (group != 0)
+    return udp.beginMulticast(IPAddress(group), port) == 1;
+  return udp.begin(port) == 1;
+}
+
+size_t halUdpRead(uint8_t *buf, size_t len)
+{
+  int size = udp.parsePacket();
+  if (size <= 0)
+    return 0;
+  int n = udp.read(buf, len);
+  udp.flush(); // drop the truncated rest
+  return n > 0 ? (size_t)n : 0;
+}
+
+// ===== TCP server =====
+// lwIP BSD sockets, non-blocking; the connection id is the socket
+static int listenFd = -1;
+
+bool halListen(uint16_t port)
+{
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0)
+    return false;
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 4) != 0)
+  {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+int halAccept()
+{
+  if (listenFd < 0)
+    return -1;
+  int fd = accept(listenFd, nullptr, nullptr);
+  if (fd < 0)
+    return -1;
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+int halConnRead(int conn, uint8_t *buf, size_t len)
+{
+  int n = recv(conn, buf, len, MSG_DONTWAIT);
+  if (n > 0)
+    return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return 0;
+  return -1; // 0 = peer closed
+}
+
+int halConnWrite(int conn, const uint8_t *data, size_t len)
+{
+  int n = send(conn, data, len, MSG_DONTWAIT);
+  if (n >= 0)
+    return n;
+  return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+uint32_t halConnPeer(int conn)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (getpeername(conn, (struct sockaddr *)&addr, &len) != 0 || addr.sin_family != AF_INET)
+    return 0;
+  return addr.sin_addr.s_addr;
+}
+
+void halConnClose(int conn)
+{
+  close(conn);
+}
+
+#endif
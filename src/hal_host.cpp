@@ -0,0 +1,1337 @@
+// HAL backend for host (Linux) builds, see hal.h and hal_host.h
+// Everything runs against a virtual clock: delays advance it instead of sleeping, so a day of
+// firmware time runs in seconds.
+
+#ifndef ARDUINO
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <termios.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hal.h"
+#include "hal_host.h"
+#include "http_chunked.h"
+
+// simulated CPU clock for halCycles()
+const uint32_t HOST_CYCLES_PER_US = 160;
+// display powers bus pull-ups this long after power-on
+const uint64_t HOST_BUS_READY_US = 40000;
+
+// WiFi timings
+const uint64_t HOST_WIFI_TARGETED_US = 250000;
+const uint64_t HOST_WIFI_SCAN_US = 2300000;
+const uint64_t HOST_WIFI_DHCP_US = 700000;
+
+// thermometer timings
+const uint64_t HOST_HTTP_CONNECT_US = 30000; // TCP handshake + accept on the sensor
+const uint64_t HOST_HTTP_US = 15000;         // request / response on open connection
+const size_t HOST_HTTP_CHUNK = 64;          // body chunk handed to the sink, as on the device
+const uint64_t HOST_HTTP_SLOW_US = 400000;   // occasional slow response (sensor busy measuring)
+const unsigned HOST_HTTP_SLOW_PERCENT = 3;
+const uint64_t HOST_MDNS_US = 120000;
+const uint32_t HOST_MDNS_TTL = 120; // s
+const uint64_t HOST_SENSOR_KEEPALIVE_US = 600000000ULL; // sensor closes idle connection after 10 min
+
+#define HOST_SENSOR_MDNS_HOST "temperatura_na_balkonie.local"
+#define HOST_SENSOR_IP_HOST "192.168.1.35"
+#define HOST_SENSOR_FALLBACK_HOST "192.168.1.36"
+#define HOST_BROKER_HOST "192.168.1.40"
+
+struct HostOutage
+{
+  unsigned long startMs;
+  unsigned long endMs;
+  HostSensorTarget target;
+};
+
+static uint64_t nowUs = 0;
+static bool quiet = false;
+static HostStats stats;
+
+// ===== Clock =====
+void hostAdvanceUs(uint64_t us) { nowUs += us; }
+uint64_t hostNowUs() { return nowUs; }
+void hostSetQuiet(bool q) { quiet = q; }
+
+unsigned long halMillis() { return (unsigned long)(nowUs / 1000); }
+unsigned long halMicros() { return (unsigned long)nowUs; }
+static bool realTime = false;
+void hostSetRealTime(bool real) { realTime = real; }
+
+void halDelay(unsigned long ms)
+{
+  nowUs += (uint64_t)ms * 1000;
+  if (realTime)
+  {
+    struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, nullptr);
+  }
+}
+void halDelayMicroseconds(unsigned int us) { nowUs += us; }
+uint32_t halCycles() { return (uint32_t)(nowUs * HOST_CYCLES_PER_US); }
+uint32_t halCyclesPerUs() { return HOST_CYCLES_PER_US; }
+
+// ===== Heap =====
+bool halHeapStats(size_t &freeBytes, size_t &largestBlock, size_t &minFree)
+{
+  // the host allocator says nothing about an ESP32 heap
+  freeBytes = 0;
+  largestBlock = 0;
+  minFree = 0;
+  return false;
+}
+
+// ===== Open-drain GPIO + display bus decoder =====
+// pins 2 (latch), 3 (data), 4 (clock); bits are shifted in on clock rising edge and
+// the frame is taken on latch rising edge
+const int HOST_PIN_LATCH = 2;
+const int HOST_PIN_DATA = 3;
+const int HOST_PIN_CLOCK = 4;
+const int HOST_PIN_COUNT = 8;
+
+static bool pinReleased[HOST_PIN_COUNT] = {true, true, true, true, true, true, true, true};
+static uint16_t shiftReg = 0;
+static int shiftCount = 0;
+
+static bool pinLevel(int pin)
+{
+  // released lines float LOW until the display powers its pull-ups
+  return pinReleased[pin] && nowUs >= HOST_BUS_READY_US;
+}
+
+static void pinSet(int pin, bool release)
+{
+  if (pin < 0 || pin >= HOST_PIN_COUNT)
+    return;
+  bool wasHigh = pinLevel(pin);
+  pinReleased[pin] = release;
+  bool rising = !wasHigh && pinLevel(pin);
+  if (!rising)
+    return;
+
+  if (pin == HOST_PIN_CLOCK)
+  {
+    if (shiftCount < 16 && pinLevel(HOST_PIN_DATA))
+      shiftReg |= (uint16_t)(1u << shiftCount);
+    shiftCount++;
+  }
+  else if (pin == HOST_PIN_LATCH && shiftCount >= 16)
+  {
+    stats.framesLatched++;
+    stats.lastLatchUs = nowUs;
+    stats.lastFrame = shiftReg;
+    shiftReg = 0;
+    shiftCount = 0;
+  }
+  else if (pin == HOST_PIN_LATCH)
+  {
+    shiftReg = 0;
+    shiftCount = 0;
+  }
+}
+
+void halPinLow(int pin) { pinSet(pin, false); }
+void halPinRelease(int pin) { pinSet(pin, true); }
+bool halPinRead(int pin) { return pin >= 0 && pin < HOST_PIN_COUNT && pinLevel(pin); }
+
+// ===== Serial =====
+void halSerialBegin(unsigned long baud) { (void)baud; }
+
+void halLog(const char *fmt, ...)
+{
+  if (quiet)
+    return;
+  unsigned long ms = halMillis();
+  printf("[%2lud %02lu:%02lu:%02lu.%03lu] ", ms / 86400000UL, ms / 3600000UL % 24, ms / 60000UL % 60, ms / 1000UL % 60,
+         ms % 1000);
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+}
+
+// --serial-pty: serial data goes through a pseudo-terminal, its slave is the device's port; log
+// lines stay on stdout. The slave is held open in raw mode, so clients find it configured and the
+// master does not see a hangup between them.
+static int serialMaster = -1;
+static int serialSlave = -1;
+
+const char *hostSetSerialPty()
+{
+  serialMaster = posix_openpt(O_RDWR | O_NOCTTY);
+  if (serialMaster < 0 || grantpt(serialMaster) != 0 || unlockpt(serialMaster) != 0)
+    return nullptr;
+  const char *path = ptsname(serialMaster);
+  serialSlave = path ? open(path, O_RDWR | O_NOCTTY) : -1;
+  if (serialSlave < 0)
+    return nullptr;
+  struct termios tio;
+  tcgetattr(serialSlave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(serialSlave, TCSANOW, &tio);
+  fcntl(serialMaster, F_SETFL, O_NONBLOCK);
+  return path;
+}
+
+void halSerialWrite(const char *text)
+{
+  if (serialMaster >= 0)
+    halSerialWriteBytes((const uint8_t *)text, strlen(text));
+  else if (!quiet)
+    fputs(text, stdout);
+}
+
+void halSerialWriteBytes(const uint8_t *data, size_t len)
+{
+  // a UART drops nothing, but a client that stopped reading must not stall the loop
+  if (serialMaster >= 0 && write(serialMaster, data, len) < 0 && errno != EAGAIN)
+    fprintf(stderr, "[host] serial write failed\n");
+}
+
+size_t halSerialReadBytes(uint8_t *buf, size_t len)
+{
+  if (serialMaster < 0)
+    return 0;
+  ssize_t n = read(serialMaster, buf, len);
+  return n > 0 ? (size_t)n : 0;
+}
+
+// ===== Persistent storage (NVS) =====
+static std::map<std::string, std::vector<uint8_t> > store;
+
+static std::string storeKey(const char *ns, const char *key)
+{
+  return std::string(ns) + "/" + key;
+}
+
+bool halStoreRead(const char *ns, const char *key, void *buf, size_t len)
+{
+  std::map<std::string, std::vector<uint8_t> >::const_iterator it = store.find(storeKey(ns, key));
+  if (it == store.end() || it->second.size() != len)
+    return false;
+  memcpy(buf, it->second.data(), len);
+  return true;
+}
+
+bool halStoreWrite(const char *ns, const char *key, const void *buf, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  store[storeKey(ns, key)] = std::vector<uint8_t>(p, p + len);
+  return true;
+}
+
+void halStoreRemove(const char *ns, const char *key)
+{
+  store.erase(storeKey(ns, key));
+}
+
+// file format: per entry "<key>\n<len>\n<len bytes>"
+bool hostStoreLoad(const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr)
+    return false;
+  char key[128];
+  unsigned long len;
+  // exactly one newline before the data: "\n" in the format would also eat leading whitespace bytes of a blob
+  while (fscanf(f, "%127s\n%lu", key, &len) == 2 && fgetc(f) == '\n')
+  {
+    std::vector<uint8_t> v(len);
+    if (len && fread(v.data(), 1, len, f) != len)
+      break;
+    store[key] = v;
+  }
+  fclose(f);
+  return true;
+}
+
+bool hostStoreSave(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr)
+    return false;
+  for (std::map<std::string, std::vector<uint8_t> >::const_iterator it = store.begin(); it != store.end(); ++it)
+  {
+    fprintf(f, "%s\n%lu\n", it->first.c_str(), (unsigned long)it->second.size());
+    fwrite(it->second.data(), 1, it->second.size(), f);
+  }
+  fclose(f);
+  return true;
+}
+
+// ===== Outages =====
+static std::vector<HostOutage> wifiOutages;
+static std::vector<HostOutage> sensorOutages;
+
+void hostAddWifiOutage(unsigned long startMs, unsigned long durationMs)
+{
+  HostOutage o = {startMs, startMs + durationMs, HOST_SENSOR_ALL};
+  wifiOutages.push_back(o);
+}
+
+void hostAddSensorOutage(unsigned long startMs, unsigned long durationMs, HostSensorTarget target)
+{
+  HostOutage o = {startMs, startMs + durationMs, target};
+  sensorOutages.push_back(o);
+}
+
+static const HostOutage *findOutage(const std::vector<HostOutage> &list, unsigned long ms)
+{
+  for (size_t i = 0; i < list.size(); i++)
+  {
+    if (ms >= list[i].startMs && ms < list[i].endMs)
+      return &list[i];
+  }
+  return nullptr;
+}
+
+/// @brief Thermometer (mDNS responder or HTTP host) is down at given time
+static bool sensorDown(HostSensorTarget who, unsigned long ms)
+{
+  for (size_t i = 0; i < sensorOutages.size(); i++)
+  {
+    const HostOutage &o = sensorOutages[i];
+    if (ms < o.startMs || ms >= o.endMs)
+      continue;
+    // a dead primary thermometer does not answer mDNS either
+    if ((o.target == HOST_SENSOR_ALL && who != HOST_SENSOR_BROKER) || o.target == who ||
+        (who == HOST_SENSOR_MDNS && o.target == HOST_SENSOR_PRIMARY))
+      return true;
+  }
+  return false;
+}
+
+// ===== WiFi =====
+enum HostWifiState
+{
+  HOST_WIFI_OFF,
+  HOST_WIFI_CONNECTING,
+  HOST_WIFI_UP,
+  HOST_WIFI_LOST
+};
+
+static const uint8_t HOST_AP_BSSID[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+static const uint8_t HOST_AP_CHANNEL = 6;
+
+static HostWifiState wifiState = HOST_WIFI_OFF;
+static uint64_t wifiReadyAtUs = 0;
+static bool wifiTargetOk = true;
+static uint32_t wifiStaticIp = 0;
+
+static uint32_t ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+  // same layout as IPAddress -> uint32_t on ESP32
+  return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+static bool wifiInOutage()
+{
+  return findOutage(wifiOutages, halMillis()) != nullptr;
+}
+
+static void wifiUpdate()
+{
+  bool outage = wifiInOutage();
+
+  if (wifiState == HOST_WIFI_UP && outage)
+  {
+    wifiState = HOST_WIFI_LOST;
+    return;
+  }
+  if (wifiState == HOST_WIFI_LOST && !outage)
+  {
+    // driver auto reconnect
+    wifiState = HOST_WIFI_CONNECTING;
+    wifiTargetOk = true;
+    wifiReadyAtUs = nowUs + HOST_WIFI_SCAN_US + HOST_WIFI_DHCP_US;
+    return;
+  }
+  if (wifiState == HOST_WIFI_CONNECTING && !outage && wifiTargetOk && nowUs >= wifiReadyAtUs)
+  {
+    wifiState = HOST_WIFI_UP;
+    stats.wifiConnects++;
+  }
+}
+
+void halWifiInit(const char *hostname)
+{
+  (void)hostname;
+  wifiState = HOST_WIFI_OFF;
+}
+
+void halWifiBegin(const char *ssid, const char *password, const HalWifiLink *target)
+{
+  (void)ssid;
+  (void)password;
+  wifiState = HOST_WIFI_CONNECTING;
+
+  if (target == nullptr)
+  {
+    wifiTargetOk = true;
+    wifiStaticIp = 0;
+    wifiReadyAtUs = nowUs + HOST_WIFI_SCAN_US + HOST_WIFI_DHCP_US;
+    return;
+  }
+
+  // wrong BSSID / channel never associates
+  wifiTargetOk = memcmp(target->bssid, HOST_AP_BSSID, 6) == 0 && target->channel == HOST_AP_CHANNEL;
+  wifiStaticIp = target->ip;
+  wifiReadyAtUs = nowUs + HOST_WIFI_TARGETED_US + (wifiStaticIp ? 0 : HOST_WIFI_DHCP_US);
+}
+
+void halWifiDisconnect()
+{
+  wifiState = HOST_WIFI_OFF;
+}
+
+void halWifiOff()
+{
+  wifiState = HOST_WIFI_OFF;
+}
+
+HalWifiStatus halWifiStatus()
+{
+  wifiUpdate();
+  switch (wifiState)
+  {
+  case HOST_WIFI_UP:
+    return HAL_WIFI_CONNECTED;
+  case HOST_WIFI_LOST:
+    return HAL_WIFI_CONNECTION_LOST;
+  case HOST_WIFI_CONNECTING:
+    return wifiInOutage() ? HAL_WIFI_NO_SSID : HAL_WIFI_DISCONNECTED;
+  default:
+    return HAL_WIFI_IDLE;
+  }
+}
+
+bool halWifiGetLink(HalWifiLink &link)
+{
+  if (halWifiStatus() != HAL_WIFI_CONNECTED)
+    return false;
+  memcpy(link.bssid, HOST_AP_BSSID, sizeof(link.bssid));
+  link.channel = HOST_AP_CHANNEL;
+  link.ip = wifiStaticIp ? wifiStaticIp : ipv4(192, 168, 1, 50);
+  link.gateway = ipv4(192, 168, 1, 1);
+  link.subnet = ipv4(255, 255, 255, 0);
+  link.dns = ipv4(192, 168, 1, 1);
+  return true;
+}
+
+// ===== HTTP client =====
+// Simulated thermometer by default. With hostSetSensorServer() the thermometer host names are
+// mapped to a real HTTP server and requests go over real sockets (keep-alive per slot); the
+// virtual clock is advanced by the measured wall time.
+
+float hostSensorTemperature(unsigned long ms)
+{
+  // daily sine, minimum around 4:00, plus a slow ripple
+  double h = ms / 3600000.0;
+  return (float)(9.0 + 7.0 * sin(2.0 * M_PI * (h - 10.0) / 24.0) + 0.4 * sin(2.0 * M_PI * h / 0.7));
+}
+
+/// @brief Split "http://host[:port]/path" into host, port and path
+static bool parseUrl(const char *url, char *host, size_t hostLen, uint16_t &port, const char *&path)
+{
+  const char *p = strstr(url, "://");
+  p = p ? p + 3 : url;
+  size_t n = strcspn(p, ":/");
+  if (n == 0 || n >= hostLen)
+    return false;
+  memcpy(host, p, n);
+  host[n] = '\0';
+  p += n;
+  port = 80;
+  if (*p == ':')
+    port = (uint16_t)strtoul(p + 1, (char **)&p, 10);
+  path = *p ? p : "/";
+  return true;
+}
+
+static char realHost[64] = "";
+static uint16_t realPort = 0;
+static uint64_t simKeepAliveUs = HOST_SENSOR_KEEPALIVE_US;
+static uint32_t simMdnsTtl = HOST_MDNS_TTL;
+
+struct HostHttpConn
+{
+  int fd;             // real socket, -1 = closed
+  uint64_t idleUntil; // simulated connection: open until
+  char host[64];
+  // request in flight, completes at doneAt on the virtual clock
+  bool busy;
+  bool cancelled;
+  uint32_t id;
+  uint64_t doneAt;
+  int code;
+  bool reused;
+};
+
+static HostHttpConn conns[HAL_HTTP_SLOTS];
+static bool connsInit = false;
+
+bool hostSetSensorServer(const char *hostPort)
+{
+  if (sscanf(hostPort, "%63[^:]:%hu", realHost, &realPort) != 2)
+  {
+    realHost[0] = '\0';
+    return false;
+  }
+  return true;
+}
+
+void hostSetSensorKeepAlive(unsigned long seconds)
+{
+  simKeepAliveUs = (uint64_t)seconds * 1000000ULL;
+}
+
+void hostSetMdnsTtl(unsigned long seconds)
+{
+  simMdnsTtl = (uint32_t)seconds;
+}
+
+// query in flight, answered at mdnsDoneAt on the virtual clock
+static bool mdnsBusy = false;
+static uint64_t mdnsDoneAt = 0;
+static bool mdnsOk = false;
+
+bool halMdnsStart(const char *host, unsigned long timeoutMs)
+{
+  if (mdnsBusy)
+    return false;
+  stats.mdnsQueries++;
+  mdnsBusy = true;
+  mdnsOk = halWifiStatus() == HAL_WIFI_CONNECTED && strcmp(host, HOST_SENSOR_MDNS_HOST) == 0 &&
+           !sensorDown(HOST_SENSOR_MDNS, halMillis());
+  mdnsDoneAt = nowUs + (mdnsOk ? HOST_MDNS_US : (uint64_t)timeoutMs * 1000);
+  return true;
+}
+
+HalMdnsState halMdnsPoll(uint32_t &ip, uint32_t &ttl)
+{
+  if (!mdnsBusy)
+    return HAL_MDNS_FAILED;
+  if (nowUs < mdnsDoneAt)
+    return HAL_MDNS_PENDING;
+  mdnsBusy = false;
+  if (!mdnsOk)
+    return HAL_MDNS_FAILED;
+  ip = ipv4(192, 168, 1, 35); // HOST_SENSOR_IP_HOST
+  ttl = simMdnsTtl;
+  return HAL_MDNS_OK;
+}
+
+static uint64_t wallUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void realClose(HostHttpConn &c)
+{
+  if (c.fd >= 0)
+    close(c.fd);
+  c.fd = -1;
+}
+
+/// @brief Blocking TCP connect with deadline
+/// @return Socket, -1 on failure
+static int socketConnect(const char *host, uint16_t port, unsigned long connectTimeoutMs)
+{
+  char portStr[8];
+  snprintf(portStr, sizeof(portStr), "%u", port);
+  struct addrinfo hints, *res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host, portStr, &hints, &res) != 0 || res == nullptr)
+    return -1;
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  // on Linux SO_SNDTIMEO also bounds connect()
+  struct timeval tv = {(time_t)(connectTimeoutMs / 1000), (suseconds_t)(connectTimeoutMs % 1000) * 1000};
+  if (fd >= 0)
+  {
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  bool ok = fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+  freeaddrinfo(res);
+  if (!ok && fd >= 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+  return fd;
+}
+
+static bool realConnect(HostHttpConn &c, unsigned long connectTimeoutMs)
+{
+  c.fd = socketConnect(realHost, realPort, connectTimeoutMs);
+  return c.fd >= 0;
+}
+
+/// @brief Hand data to the sink in HOST_HTTP_CHUNK pieces until it wants no more
+static void sinkFeed(HalHttpSink sink, void *ctx, const char *data, size_t len, bool &wanted)
+{
+  for (size_t off = 0; wanted && off < len; off += HOST_HTTP_CHUNK)
+    wanted = sink(ctx, data + off, len - off < HOST_HTTP_CHUNK ? len - off : HOST_HTTP_CHUNK);
+}
+
+/// @brief One request on an open socket, body goes to the sink
+/// @return HTTP status, -1 on error before any response byte, -2 on later error
+static int realRequest(HostHttpConn &c, const char *host, const char *path, HalHttpSink sink, void *ctx,
+                       unsigned long readTimeoutMs)
+{
+  struct timeval tv = {(time_t)(readTimeoutMs / 1000), (suseconds_t)(readTimeoutMs % 1000) * 1000};
+  setsockopt(c.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  char req[256];
+  int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n", path, host);
+  if (send(c.fd, req, n, MSG_NOSIGNAL) != n)
+    return -1;
+
+  char head[1024];
+  size_t got = 0;
+  char *end = nullptr;
+  while (end == nullptr)
+  {
+    if (got == sizeof(head) - 1)
+      return -2;
+    ssize_t r = recv(c.fd, head + got, sizeof(head) - 1 - got, 0);
+    if (r <= 0)
+      return got == 0 ? -1 : -2;
+    got += r;
+    head[got] = '\0';
+    end = strstr(head, "\r\n\r\n");
+  }
+
+  int status = 0;
+  if (sscanf(head, "HTTP/%*d.%*d %d", &status) != 1)
+    return -2;
+  const char *cl = strcasestr(head, "\r\nContent-Length:");
+  long contentLength = cl ? strtol(cl + 17, nullptr, 10) : -1;
+  const char *te = strcasestr(head, "\r\nTransfer-Encoding:");
+  bool chunked = te != nullptr && te < end && strncasecmp(te + 21 + strspn(te + 21, " "), "chunked", 7) == 0;
+  bool keepAlive = strcasestr(head, "\r\nConnection: close") == nullptr && (contentLength >= 0 || chunked);
+  HttpChunked dechunk;
+  httpChunkedInit(dechunk);
+
+  // body: part already received, then the rest; drain what the sink does not want
+  size_t want = contentLength >= 0 && !chunked ? (size_t)contentLength : (size_t)-1;
+  size_t total = got - (end + 4 - head);
+  size_t len = total;
+  char *data = end + 4;
+  char chunk[HOST_HTTP_CHUNK];
+  bool wanted = true;
+  if (status == 200)
+    sink(ctx, nullptr, 0);
+  for (;;)
+  {
+    if (chunked)
+    {
+      size_t used;
+      size_t body = httpChunkedFeed(dechunk, data, len, used);
+      if (dechunk.status == HTTP_CHUNKED_ERROR)
+      {
+        realClose(c);
+        return HAL_HTTP_BAD_FRAMING;
+      }
+      if (dechunk.status == HTTP_CHUNKED_DONE && used != len)
+        keepAlive = false; // bytes past the body: out of step
+      len = body;
+    }
+    if (status == 200)
+      sinkFeed(sink, ctx, data, len, wanted);
+    if (total >= want || dechunk.status == HTTP_CHUNKED_DONE)
+      break;
+    if (!wanted && contentLength < 0 && !chunked)
+    {
+      keepAlive = false; // unknown length: cannot drain
+      break;
+    }
+
+    ssize_t r = recv(c.fd, chunk, sizeof(chunk), 0);
+    if (r <= 0)
+    {
+      keepAlive = false;
+      break;
+    }
+    total += r;
+    data = chunk;
+    len = r;
+  }
+
+  if (!keepAlive)
+    realClose(c);
+  return status;
+}
+
+/// @brief Blocking request on a real socket
+/// @param elapsedUs  Output: wall time taken
+static int realHttpGet(HostHttpConn &c, const char *host, const char *path, HalHttpSink sink, void *ctx, bool *reused,
+                       unsigned long connectTimeoutMs, unsigned long readTimeoutMs, uint64_t &elapsedUs)
+{
+  uint64_t t0 = wallUs();
+  int code = -1;
+
+  // reuse open socket, reconnect transparently if server has closed it meanwhile
+  for (int attempt = 0; attempt < 2 && code == -1; attempt++)
+  {
+    *reused = c.fd >= 0;
+    if (c.fd < 0 && !realConnect(c, connectTimeoutMs))
+      break;
+    code = realRequest(c, host, path, sink, ctx, readTimeoutMs);
+    if (code < 0)
+      realClose(c);
+    if (!*reused)
+      break;
+  }
+  elapsedUs = wallUs() - t0;
+  return code;
+}
+
+/// @brief Deterministic pseudo random number for simulated latency jitter
+static uint32_t simRandom()
+{
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static uint32_t httpNextId = 1;
+
+static uint32_t httpFinish(HostHttpConn &c, int code, uint64_t latencyUs)
+{
+  c.busy = true;
+  c.cancelled = false;
+  c.code = code;
+  c.doneAt = nowUs + latencyUs;
+  c.id = httpNextId++;
+  return c.id;
+}
+
+uint32_t halHttpStart(int slot, const char *url, unsigned long connectTimeoutMs, unsigned long readTimeoutMs,
+                      HalHttpSink sink, void *ctx)
+{
+  if (slot < 0 || slot >= HAL_HTTP_SLOTS)
+    return 0;
+  if (!connsInit)
+  {
+    for (int i = 0; i < HAL_HTTP_SLOTS; i++)
+      conns[i].fd = -1;
+    connsInit = true;
+  }
+
+  HostHttpConn &c = conns[slot];
+  if (c.busy && nowUs < c.doneAt)
+    return 0; // previous (cancelled) request still running
+
+  stats.httpRequests++;
+  c.reused = false;
+
+  char host[64];
+  uint16_t port;
+  const char *path;
+  HostSensorTarget who = HOST_SENSOR_PRIMARY;
+  if (!parseUrl(url, host, sizeof(host), port, path) || halWifiStatus() != HAL_WIFI_CONNECTED)
+    return httpFinish(c, -1, 0);
+
+  bool mdns = strcmp(host, HOST_SENSOR_MDNS_HOST) == 0;
+  if (strcmp(host, HOST_SENSOR_FALLBACK_HOST) == 0)
+    who = HOST_SENSOR_FALLBACK;
+  else if (!mdns && strcmp(host, HOST_SENSOR_IP_HOST) != 0)
+    return httpFinish(c, -1, 0); // unknown host
+
+  c.reused = strcmp(c.host, host) == 0 && nowUs < c.idleUntil;
+  if (sensorDown(who, halMillis()) || (mdns && sensorDown(HOST_SENSOR_MDNS, halMillis())))
+  {
+    // new connection: SYN unanswered, kept-alive connection: request unanswered
+    uint64_t deadline = c.reused ? (uint64_t)readTimeoutMs * 1000 : (uint64_t)connectTimeoutMs * 1000;
+    realClose(c);
+    c.idleUntil = 0;
+    return httpFinish(c, -1, deadline);
+  }
+
+  if (realHost[0])
+  {
+    // real server answers right away, the reply is delivered after the measured wall time
+    uint64_t elapsedUs;
+    int code = realHttpGet(c, host, path, sink, ctx, &c.reused, connectTimeoutMs, readTimeoutMs, elapsedUs);
+    return httpFinish(c, code, elapsedUs);
+  }
+
+  // simulated: a kept-alive connection skips mDNS lookup and TCP handshake
+  uint64_t latency = HOST_HTTP_US + simRandom() % 5000;
+  if (simRandom() % 100 < HOST_HTTP_SLOW_PERCENT)
+    latency += HOST_HTTP_SLOW_US;
+  if (latency > (uint64_t)readTimeoutMs * 1000)
+  {
+    c.idleUntil = 0; // HTTPClient drops the connection on timeout
+    return httpFinish(c, -11, (uint64_t)readTimeoutMs * 1000); // HTTPC_ERROR_READ_TIMEOUT
+  }
+  if (!c.reused)
+    latency += HOST_HTTP_CONNECT_US + (mdns ? HOST_MDNS_US : 0);
+  snprintf(c.host, sizeof(c.host), "%s", host);
+  c.idleUntil = nowUs + latency + simKeepAliveUs;
+
+  // fallback thermometer hangs a bit lower on the wall
+  float temp = hostSensorTemperature(halMillis()) + (who == HOST_SENSOR_FALLBACK ? 0.3f : 0.0f);
+  char body[96];
+  int n = snprintf(body, sizeof(body), "{\"temperature\":%.2f,\"humidity\":61.4,\"uptime\":%lu}", temp,
+                   halMillis() / 1000);
+  bool wanted = true;
+  sink(ctx, nullptr, 0);
+  sinkFeed(sink, ctx, body, n, wanted);
+  return httpFinish(c, 200, latency);
+}
+
+bool halHttpResult(HalHttpResult &result)
+{
+  if (!connsInit)
+    return false;
+
+  // queue order: earliest finished first
+  int slot = -1;
+  for (int i = 0; i < HAL_HTTP_SLOTS; i++)
+  {
+    const HostHttpConn &c = conns[i];
+    if (c.busy && !c.cancelled && nowUs >= c.doneAt && (slot < 0 || c.doneAt < conns[slot].doneAt))
+      slot = i;
+  }
+  if (slot < 0)
+    return false;
+
+  HostHttpConn &c = conns[slot];
+  c.busy = false;
+  result.id = c.id;
+  result.slot = slot;
+  result.code = c.code;
+  result.reused = c.reused;
+  if (c.code != 200)
+    stats.httpFailures++;
+  return true;
+}
+
+void halHttpCancel(int slot)
+{
+  if (slot < 0 || slot >= HAL_HTTP_SLOTS || !connsInit)
+    return;
+  HostHttpConn &c = conns[slot];
+  if (!c.busy || c.cancelled)
+    return;
+  c.cancelled = true;
+  stats.httpCancelled++;
+  if (nowUs >= c.doneAt)
+    c.busy = false;
+}
+
+// ===== UDP (injected datagrams, optionally a real socket) =====
+const size_t HOST_UDP_QUEUE = 8; // lwIP drops beyond its receive mailbox as well
+
+static bool udpOpen = false;
+static bool udpReal = false;
+static int udpFd = -1;
+static std::vector<std::string> udpQueue;
+
+void hostSetUdpSocket(bool real)
+{
+  udpReal = real;
+}
+
+static bool udpOpenSocket(uint16_t port, uint32_t group)
+{
+  udpFd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (udpFd < 0)
+    return false;
+  int one = 1;
+  setsockopt(udpFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(udpFd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+  {
+    close(udpFd);
+    udpFd = -1;
+    return false;
+  }
+  if (group != 0)
+  {
+    // default interface for senders on the LAN, loopback for local test senders
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = group; // same byte order
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    bool joined = setsockopt(udpFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    joined = setsockopt(udpFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0 || joined;
+    if (!joined)
+      fprintf(stderr, "[host] cannot join multicast group, unicast only\n");
+  }
+  return true;
+}
+
+bool halUdpBegin(uint16_t port, uint32_t group)
+{
+  if (udpReal && !udpOpenSocket(port, group))
+    return false;
+  udpOpen = true;
+  return true;
+}
+
+size_t halUdpRead(uint8_t *buf, size_t len)
+{
+  if (udpQueue.empty())
+  {
+    if (udpFd < 0)
+      return 0;
+    ssize_t n = recv(udpFd, buf, len, MSG_DONTWAIT | MSG_TRUNC);
+    if (n <= 0)
+      return 0;
+    return (size_t)n < len ? (size_t)n : len;
+  }
+  std::string d = udpQueue.front();
+  udpQueue.erase(udpQueue.begin());
+  size_t n = d.size() < len ? d.size() : len;
+  memcpy(buf, d.data(), n);
+  return n;
+}
+
+bool hostUdpInject(const uint8_t *data, size_t len)
+{
+  if (!udpOpen || halWifiStatus() != HAL_WIFI_CONNECTED || udpQueue.size() >= HOST_UDP_QUEUE)
+    return false;
+  udpQueue.push_back(std::string((const char *)data, len));
+  return true;
+}
+
+// ===== TCP stream client =====
+// Simulated MQTT 3.1.1 broker at HOST_BROKER_HOST by default: answers CONNECT, SUBSCRIBE (exact
+// topic, QoS 0, retained message delivered), PINGREQ and DISCONNECT, and forwards what
+// hostMqttPublish() publishes. With hostSetMqttBroker() the connection goes to a real broker.
+const size_t HOST_TCP_BUFFER = 1024; // lwIP send buffer
+
+struct HostTcpChunk
+{
+  uint64_t at; // arrives on the virtual clock
+  std::string data;
+};
+
+struct HostTcp
+{
+  HalTcpState state;
+  uint64_t readyAt; // connect finishes
+  bool willConnect;
+  int fd; // real socket, -1 = simulated
+  std::string fromClient;
+  std::vector<HostTcpChunk> toClient;
+  std::string topic; // subscribed topic
+};
+
+static HostTcp tcp = {HAL_TCP_CLOSED, 0, false, -1, "", std::vector<HostTcpChunk>(), ""};
+static char brokerHost[64] = "";
+static uint16_t brokerPort = 0;
+static std::map<std::string, std::string> retained;
+
+bool hostSetMqttBroker(const char *hostPort)
+{
+  if (sscanf(hostPort, "%63[^:]:%hu", brokerHost, &brokerPort) != 2)
+  {
+    brokerHost[0] = '\0';
+    return false;
+  }
+  return true;
+}
+
+/// @brief Queue broker -> client packet, arrives after the network latency
+static void brokerSend(uint8_t type, const std::string &body)
+{
+  std::string p(1, (char)type);
+  size_t len = body.size();
+  do
+  {
+    uint8_t b = len & 0x7f;
+    len >>= 7;
+    p += (char)(len ? b | 0x80 : b);
+  } while (len);
+  p += body;
+  HostTcpChunk c = {nowUs + HOST_HTTP_US, p};
+  tcp.toClient.push_back(c);
+}
+
+static std::string mqttString(const std::string &s)
+{
+  return std::string(1, (char)(s.size() >> 8)) + (char)(s.size() & 0xff) + s;
+}
+
+static void brokerPublish(const std::string &topic, const std::string &payload, bool retain)
+{
+  brokerSend(retain ? 0x31 : 0x30, mqttString(topic) + payload);
+}
+
+/// @brief Serve complete client packets
+static void brokerReceive()
+{
+  for (;;)
+  {
+    const std::string &in = tcp.fromClient;
+    size_t len = 0, pos = 1;
+    int shift = 0;
+    for (;; pos++, shift += 7)
+    {
+      if (pos >= in.size())
+        return;
+      len |= (size_t)((uint8_t)in[pos] & 0x7f) << shift;
+      if (((uint8_t)in[pos] & 0x80) == 0)
+        break;
+    }
+    pos++;
+    if (in.size() < pos + len)
+      return;
+    uint8_t type = (uint8_t)in[0] >> 4;
+    std::string body = in.substr(pos, len);
+    tcp.fromClient.erase(0, pos + len);
+
+    if (type == 1) // CONNECT
+      brokerSend(0x20, std::string("\0\0", 2));
+    else if (type == 8 && body.size() >= 5) // SUBSCRIBE: packet id, topic filter, QoS
+    {
+      size_t n = ((uint8_t)body[2] << 8) | (uint8_t)body[3];
+      tcp.topic = body.substr(4, n);
+      brokerSend(0x90, body.substr(0, 2) + '\0');
+      std::map<std::string, std::string>::const_iterator r = retained.find(tcp.topic);
+      if (r != retained.end())
+        brokerPublish(r->first, r->second, true);
+    }
+    else if (type == 12) // PINGREQ
+      brokerSend(0xd0, "");
+    else if (type == 14) // DISCONNECT
+      tcp.state = HAL_TCP_CLOSED;
+  }
+}
+
+void hostMqttPublish(const char *topic, const char *payload, bool retain)
+{
+  if (retain)
+    retained[topic] = payload;
+  if (tcp.fd < 0 && tcp.state == HAL_TCP_CONNECTED && tcp.topic == topic)
+    brokerPublish(topic, payload, false);
+}
+
+static void tcpUpdate()
+{
+  if (tcp.state == HAL_TCP_CONNECTING && nowUs >= tcp.readyAt)
+  {
+    tcp.state = tcp.willConnect ? HAL_TCP_CONNECTED : HAL_TCP_CLOSED;
+    if (tcp.state == HAL_TCP_CONNECTED)
+      stats.tcpConnects++;
+  }
+  // simulated broker or AP went away: the connection is dead
+  if (tcp.fd < 0 && tcp.state == HAL_TCP_CONNECTED &&
+      (halWifiStatus() != HAL_WIFI_CONNECTED || sensorDown(HOST_SENSOR_BROKER, halMillis())))
+    tcp.state = HAL_TCP_CLOSED;
+}
+
+bool halTcpConnect(const char *host, uint16_t port, unsigned long timeoutMs)
+{
+  halTcpClose();
+  if (brokerHost[0] && halWifiStatus() == HAL_WIFI_CONNECTED)
+  {
+    // real broker: blocking connect, the virtual clock pays the measured time
+    uint64_t t0 = wallUs();
+    tcp.fd = socketConnect(brokerHost, brokerPort, timeoutMs);
+    nowUs += wallUs() - t0;
+    tcp.state = tcp.fd >= 0 ? HAL_TCP_CONNECTED : HAL_TCP_CLOSED;
+    if (tcp.fd >= 0)
+      stats.tcpConnects++;
+    return true;
+  }
+
+  (void)port;
+  tcp.willConnect = halWifiStatus() == HAL_WIFI_CONNECTED && strcmp(host, HOST_BROKER_HOST) == 0 &&
+                    !sensorDown(HOST_SENSOR_BROKER, halMillis());
+  tcp.readyAt = nowUs + (tcp.willConnect ? HOST_HTTP_CONNECT_US : (uint64_t)timeoutMs * 1000);
+  tcp.state = HAL_TCP_CONNECTING;
+  return true;
+}
+
+HalTcpState halTcpState()
+{
+  tcpUpdate();
+  return tcp.state;
+}
+
+bool halTcpWrite(const uint8_t *data, size_t len)
+{
+  if (halTcpState() != HAL_TCP_CONNECTED)
+    return false;
+  if (tcp.fd >= 0)
+  {
+    if (send(tcp.fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT) == (ssize_t)len)
+      return true;
+    halTcpClose();
+    return false;
+  }
+  if (tcp.fromClient.size() + len > HOST_TCP_BUFFER)
+  {
+    halTcpClose();
+    return false;
+  }
+  tcp.fromClient.append((const char *)data, len);
+  brokerReceive();
+  return true;
+}
+
+size_t halTcpRead(uint8_t *buf, size_t len)
+{
+  if (halTcpState() != HAL_TCP_CONNECTED)
+    return 0;
+  if (tcp.fd >= 0)
+  {
+    ssize_t n = recv(tcp.fd, buf, len, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+      halTcpClose();
+    return n > 0 ? (size_t)n : 0;
+  }
+  if (tcp.toClient.empty() || nowUs < tcp.toClient.front().at)
+    return 0;
+  std::string &d = tcp.toClient.front().data;
+  size_t n = d.size() < len ? d.size() : len;
+  memcpy(buf, d.data(), n);
+  d.erase(0, n);
+  if (d.empty())
+    tcp.toClient.erase(tcp.toClient.begin());
+  return n;
+}
+
+void halTcpClose()
+{
+  if (tcp.fd >= 0)
+    close(tcp.fd);
+  tcp.fd = -1;
+  tcp.state = HAL_TCP_CLOSED;
+  tcp.fromClient.clear();
+  tcp.toClient.clear();
+  tcp.topic.clear();
+}
+
+// ===== TCP server (injected requests, optionally a real socket) =====
+// hostWebQueue() requests arrive on a virtual connection that takes any amount of response data;
+// its response is parsed (status, de-chunked body) when the server closes it.
+const int HOST_WEB_VIRTUAL = 1 << 20; // connection id, above any real descriptor
+const uint32_t HOST_WEB_VIRTUAL_PEER = 0x3201A8C0; // 192.168.1.50, network byte order
+
+static int webListenPort = 0;
+static int webListenFd = -1;
+static bool webPending = false; // request waits for halAccept()
+static bool webActive = false;  // virtual connection open
+static std::string webRequest;
+static std::string webBody;
+static std::string webResponse;
+static int webLastStatus = 0;
+static std::string webLastBody;
+
+void hostSetWebListen(uint16_t port)
+{
+  webListenPort = port;
+}
+
+bool halListen(uint16_t port)
+{
+  if (webListenPort == 0)
+    return true; // injected requests only
+  (void)port;
+  webListenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (webListenFd < 0)
+    return false;
+  int one = 1;
+  setsockopt(webListenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(webListenPort);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(webListenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(webListenFd, 4) != 0)
+  {
+    fprintf(stderr, "[host] cannot listen on port %d\n", webListenPort);
+    close(webListenFd);
+    webListenFd = -1;
+    return false;
+  }
+  fcntl(webListenFd, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+int halAccept()
+{
+  if (webPending && !webActive)
+  {
+    webPending = false;
+    webActive = true;
+    if (!webBody.empty())
+    {
+      char length[48];
+      snprintf(length, sizeof(length), "Content-Length: %u\r\n", (unsigned)webBody.size());
+      webRequest += length;
+    }
+    webRequest += "\r\n" + webBody;
+    webResponse.clear();
+    return HOST_WEB_VIRTUAL;
+  }
+  if (webListenFd < 0)
+    return -1;
+  int fd = accept(webListenFd, nullptr, nullptr);
+  if (fd < 0)
+    return -1;
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+int halConnRead(int conn, uint8_t *buf, size_t len)
+{
+  if (conn == HOST_WEB_VIRTUAL)
+  {
+    size_t n = webRequest.size() < len ? webRequest.size() : len;
+    memcpy(buf, webRequest.data(), n);
+    webRequest.erase(0, n);
+    return (int)n;
+  }
+  ssize_t n = recv(conn, buf, len, MSG_DONTWAIT);
+  if (n > 0)
+    return (int)n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return 0;
+  return -1;
+}
+
+int halConnWrite(int conn, const uint8_t *data, size_t len)
+{
+  if (conn == HOST_WEB_VIRTUAL)
+  {
+    webResponse.append((const char *)data, len);
+    return (int)len;
+  }
+  ssize_t n = send(conn, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (n >= 0)
+    return (int)n;
+  return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+/// @brief Status and body of the virtual connection's response
+static void webParseResponse()
+{
+  webLastStatus = 0;
+  webLastBody.clear();
+  sscanf(webResponse.c_str(), "HTTP/1.1 %d", &webLastStatus);
+  size_t body = webResponse.find("\r\n\r\n");
+  if (body == std::string::npos)
+    return;
+  std::string head = webResponse.substr(0, body);
+  body += 4;
+  if (head.find("Transfer-Encoding: chunked") == std::string::npos)
+  {
+    webLastBody = webResponse.substr(body);
+    return;
+  }
+  for (;;)
+  {
+    unsigned long size = strtoul(webResponse.c_str() + body, nullptr, 16);
+    body = webResponse.find("\r\n", body);
+    if (size == 0 || body == std::string::npos)
+      return;
+    webLastBody.append(webResponse, body + 2, size);
+    body += 2 + size + 2;
+  }
+}
+
+void halConnClose(int conn)
+{
+  if (conn != HOST_WEB_VIRTUAL)
+  {
+    close(conn);
+    return;
+  }
+  webActive = false;
+  webParseResponse();
+  stats.webRequests++;
+  if (webLastStatus >= 400 || webLastStatus == 0)
+    stats.webErrors++;
+}
+
+uint32_t halConnPeer(int conn)
+{
+  if (conn == HOST_WEB_VIRTUAL)
+    return HOST_WEB_VIRTUAL_PEER;
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (getpeername(conn, (struct sockaddr *)&addr, &len) != 0 || addr.sin_family != AF_INET)
+    return 0;
+  return addr.sin_addr.s_addr;
+}
+
+bool hostWebQueue(const char *path, const char *query)
+{
+  if (webPending || webActive)
+    return false;
+  webRequest = std::string("GET ") + path + (query && *query ? "?" : "") + (query ? query : "") +
+               " HTTP/1.1\r\nHost: display\r\n";
+  webBody.clear();
+  webPending = true;
+  return true;
+}
+
+bool hostWebQueueHeader(const char *name, const char *value)
+{
+  if (!webPending)
+    return false;
+  webRequest += std::string(name) + ": " + value + "\r\n";
+  return true;
+}
+
+bool hostWebQueuePost(const char *path, const char *body)
+{
+  return hostWebQueuePostData(path, "", "application/json", body, strlen(body));
+}
+
+bool hostWebQueuePostData(const char *path, const char *query, const char *type, const void *body, size_t len)
+{
+  // posted by a client on the network, not by the harness
+  if (halWifiStatus() != HAL_WIFI_CONNECTED || !hostWebQueue(path, query))
+    return false;
+  webRequest.replace(0, 3, "POST");
+  webRequest += std::string("Content-Type: ") + type + "\r\n";
+  webBody.assign((const char *)body, len);
+  return true;
+}
+
+bool hostWebBusy() { return webPending || webActive; }
+int hostWebLastStatus() { return webLastStatus; }
+const char *hostWebLastBody() { return webLastBody.c_str(); }
+size_t hostWebLastBodyLength() { return webLastBody.size(); }
+
+const HostStats &hostStats() { return stats; }
+
+#endif
@@ -0,0 +1,102 @@
+// Host (Linux) simulation controls for the HAL host backend, see hal_host.cpp
+// Virtual clock, simulated WiFi AP, simulated HTTP thermometers (primary 192.168.1.35 with mDNS
+// name, fallback 192.168.1.36), MQTT broker (192.168.1.40), injected web requests and datagrams.
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct HostStats
+{
+  unsigned long framesLatched; // frames decoded from the display bus
+  uint16_t lastFrame;
+  unsigned long mdnsQueries;
+  unsigned long httpRequests;
+  unsigned long httpFailures;
+  unsigned long httpCancelled;
+  unsigned long wifiConnects;
+  unsigned long webRequests;
+  unsigned long webErrors; // responses with status >= 400
+  uint64_t lastLatchUs;    // virtual time of last decoded frame
+  unsigned long tcpConnects;
+};
+
+// what a thermometer outage takes down
+enum HostSensorTarget
+{
+  HOST_SENSOR_ALL,     // both thermometers
+  HOST_SENSOR_MDNS,    // only the mDNS responder is silent, HTTP by address still works
+  HOST_SENSOR_PRIMARY, // primary thermometer (HTTP and mDNS)
+  HOST_SENSOR_FALLBACK, // fallback thermometer
+  HOST_SENSOR_BROKER    // MQTT broker (not part of "both thermometers")
+};
+
+/// @brief Advance virtual clock
+void hostAdvanceUs(uint64_t us);
+/// @brief Virtual time since power-on
+uint64_t hostNowUs();
+
+/// @brief Suppress firmware log output
+void hostSetQuiet(bool quiet);
+
+/// @brief Schedule AP outage (WiFi link lost, AP not found)
+void hostAddWifiOutage(unsigned long startMs, unsigned long durationMs);
+/// @brief Schedule thermometer outage
+void hostAddSensorOutage(unsigned long startMs, unsigned long durationMs, HostSensorTarget target);
+/// @brief Simulated outdoor temperature at given time
+float hostSensorTemperature(unsigned long ms);
+/// @brief Send thermometer requests to a real HTTP server instead of the simulation
+/// @param hostPort  e.g. "127.0.0.1:8080"
+bool hostSetSensorServer(const char *hostPort);
+/// @brief TTL of the simulated thermometer's mDNS record, 0 reports none (as the device resolver)
+void hostSetMdnsTtl(unsigned long seconds);
+/// @brief Idle time after which the simulated thermometer closes a kept-alive connection
+void hostSetSensorKeepAlive(unsigned long seconds);
+
+/// @brief Queue web request, served on a virtual connection by the following webPoll() calls
+/// @param path   Request path, e.g. "/set"
+/// @param query  Query string without '?', e.g. "temp=12"
+/// @return false if previous request was not served yet
+bool hostWebQueue(const char *path, const char *query);
+/// @brief Add a request header to the queued request
+bool hostWebQueueHeader(const char *name, const char *value);
+/// @brief Queue POST request (like hostWebQueue())
+bool hostWebQueuePost(const char *path, const char *body);
+/// @brief Queue POST request with a body of any type (binary)
+bool hostWebQueuePostData(const char *path, const char *query, const char *type, const void *body, size_t len);
+/// @brief Queued request not answered yet
+bool hostWebBusy();
+/// @brief Let halListen() open a real TCP socket on port (besides queued requests), call before setup()
+void hostSetWebListen(uint16_t port);
+/// @brief halDelay() also sleeps in real time (for blocking code under real clients)
+void hostSetRealTime(bool real);
+/// @brief Deliver datagram to the port opened with halUdpBegin()
+/// @return false if no socket listens
+bool hostUdpInject(const uint8_t *data, size_t len);
+/// @brief Connect halTcpConnect() to a real MQTT broker instead of the simulated one
+/// @param hostPort  e.g. "127.0.0.1:1883"
+bool hostSetMqttBroker(const char *hostPort);
+/// @brief Publish to the simulated broker (delivered if the firmware subscribed to topic)
+void hostMqttPublish(const char *topic, const char *payload, bool retain);
+/// @brief Let halUdpBegin() open a real socket (and join the group), call before setup()
+void hostSetUdpSocket(bool real);
+/// @brief Put serial input / output on a new pseudo-terminal, call before setup()
+/// @return Path of its slave side (the device's port for clients), nullptr on failure
+const char *hostSetSerialPty();
+/// @brief Status code of last answered queued request (0 = none)
+int hostWebLastStatus();
+/// @brief Body of last served web request
+const char *hostWebLastBody();
+/// @brief Length of last body (binary responses)
+size_t hostWebLastBodyLength();
+
+/// @brief Load / save simulated NVS (simulates power cycles between runs)
+bool hostStoreLoad(const char *path);
+bool hostStoreSave(const char *path);
+
+const HostStats &hostStats();
+
+#endif
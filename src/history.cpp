@@ -0,0 +1,288 @@
+// Temperature history ring, see history.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "history.h"
+
+// a sample takes at most two 5-byte varints
+const size_t HISTORY_SAMPLE_MAX = 10;
+
+struct HistoryBlock
+{
+  uint32_t seq; // 0 = unused
+  uint32_t t0;
+  int16_t deci0;
+  uint8_t flags;
+  uint8_t dirty; // changed since the last flush (not meaningful in NVS)
+  uint16_t count;
+  uint16_t used;
+  uint8_t data[HISTORY_BLOCK_BYTES - 16];
+};
+
+struct History
+{
+  HistoryBlock blocks[HISTORY_BLOCKS];
+  int head;       // open block
+  bool boot;      // next sample opens a block flagged HISTORY_FLAG_BOOT
+  uint32_t seq;   // of the open block
+  uint32_t clock; // history clock, s
+  unsigned long clockMs;
+  uint32_t lastT;
+  int32_t lastDeci;
+  unsigned long writes;
+};
+
+static History hist = {};
+
+static const char *const HISTORY_NS = "history";
+
+static void blockKey(int i, char *key, size_t len)
+{
+  snprintf(key, len, "b%d", i);
+}
+
+static size_t putVarint(uint8_t *p, uint32_t v)
+{
+  size_t n = 0;
+  while (v >= 0x80)
+  {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+/// @return false if the data ends inside the varint
+static bool getVarint(const uint8_t *p, uint16_t end, uint16_t &pos, uint32_t &v)
+{
+  v = 0;
+  for (int shift = 0; pos < end && shift < 35; shift += 7)
+  {
+    uint8_t b = p[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v)
+{
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/// @brief Advance the history clock (wrap-safe over halMillis)
+static uint32_t historyNow()
+{
+  unsigned long elapsed = halMillis() - hist.clockMs;
+  hist.clock += elapsed / 1000;
+  hist.clockMs += elapsed / 1000 * 1000;
+  return hist.clock;
+}
+
+/// @brief Last sample of a block, for the deltas that follow
+static bool blockLast(const HistoryBlock &b, uint32_t &t, int32_t &deci)
+{
+  t = b.t0;
+  deci = b.deci0;
+  uint16_t pos = 0;
+  for (uint16_t i = 1; i < b.count; i++)
+  {
+    uint32_t dt, dd;
+    if (!getVarint(b.data, b.used, pos, dt) || !getVarint(b.data, b.used, pos, dd))
+      return false;
+    t += dt;
+    deci += unzigzag(dd);
+  }
+  return true;
+}
+
+void historyBegin()
+{
+  memset(&hist, 0, sizeof(hist));
+  hist.clockMs = halMillis();
+  hist.head = HISTORY_BLOCKS - 1; // first sample opens block 0
+
+  char key[8];
+  for (int i = 0; i < HISTORY_BLOCKS; i++)
+  {
+    HistoryBlock &b = hist.blocks[i];
+    blockKey(i, key, sizeof(key));
+    uint32_t t;
+    int32_t deci;
+    if (!halStoreRead(HISTORY_NS, key, &b, sizeof(b)) || b.seq == 0 || b.count == 0 ||
+        b.used > sizeof(b.data) || !blockLast(b, t, deci))
+    {
+      memset(&b, 0, sizeof(b));
+      continue;
+    }
+    b.dirty = 0;
+    if (b.seq > hist.seq)
+    {
+      hist.seq = b.seq;
+      hist.head = i;
+      hist.lastT = t; // newest restored sample, for the report's span
+      hist.clock = t + 1; // continue after the newest sample, the power-off time is unknown
+    }
+  }
+  hist.boot = true;
+}
+
+/// @brief Start a new block at the next ring slot, dropping the oldest
+static void blockOpen(uint32_t t, int32_t deci)
+{
+  hist.head = (hist.head + 1) % HISTORY_BLOCKS;
+  HistoryBlock &b = hist.blocks[hist.head];
+  memset(&b, 0, sizeof(b));
+  b.seq = ++hist.seq;
+  b.t0 = t;
+  b.deci0 = (int16_t)deci;
+  b.flags = hist.boot ? HISTORY_FLAG_BOOT : 0;
+  b.count = 1;
+  b.dirty = 1;
+  hist.boot = false;
+}
+
+void historyAdd(int32_t deci)
+{
+  uint32_t t = historyNow();
+  HistoryBlock &b = hist.blocks[hist.head];
+  if (hist.boot || b.seq == 0 || b.used + HISTORY_SAMPLE_MAX > sizeof(b.data) || b.count == 0xFFFF)
+  {
+    blockOpen(t, deci);
+  }
+  else
+  {
+    b.used += putVarint(b.data + b.used, t - hist.lastT);
+    b.used += putVarint(b.data + b.used, zigzag(deci - hist.lastDeci));
+    b.count++;
+    b.dirty = 1;
+  }
+  hist.lastT = t;
+  hist.lastDeci = deci;
+}
+
+int historyFlush()
+{
+  int written = 0;
+  char key[8];
+  for (int i = 0; i < HISTORY_BLOCKS; i++)
+  {
+    HistoryBlock &b = hist.blocks[i];
+    if (!b.dirty)
+      continue;
+    b.dirty = 0;
+    blockKey(i, key, sizeof(key));
+    if (halStoreWrite(HISTORY_NS, key, &b, sizeof(b)))
+      written++;
+    else
+      b.dirty = 1; // retry on the next flush
+  }
+  hist.writes += written;
+  return written;
+}
+
+/// @brief Ring slot of the n-th block, oldest first
+/// @return -1 past the newest
+static int blockAt(int n)
+{
+  for (; n < HISTORY_BLOCKS; n++)
+  {
+    int i = (hist.head + 1 + n) % HISTORY_BLOCKS;
+    if (hist.blocks[i].seq != 0)
+      return i;
+  }
+  return -1;
+}
+
+HistoryCursor historyCursor()
+{
+  HistoryCursor c;
+  memset(&c, 0, sizeof(c));
+  return c;
+}
+
+bool historyNext(HistoryCursor &c, HistorySample &s)
+{
+  for (; c.block < HISTORY_BLOCKS; c.block++, c.sample = 0, c.pos = 0)
+  {
+    int i = (hist.head + 1 + c.block) % HISTORY_BLOCKS;
+    const HistoryBlock &b = hist.blocks[i];
+    if (b.seq == 0 || c.sample >= b.count)
+      continue;
+    if (c.sample == 0)
+    {
+      c.last.t = b.t0;
+      c.last.deci = b.deci0;
+      c.last.boot = (b.flags & HISTORY_FLAG_BOOT) != 0;
+    }
+    else
+    {
+      uint32_t dt, dd;
+      if (!getVarint(b.data, b.used, c.pos, dt) || !getVarint(b.data, b.used, c.pos, dd))
+        continue; // damaged block, skip the rest of it
+      c.last.t += dt;
+      c.last.deci += unzigzag(dd);
+      c.last.boot = false;
+    }
+    c.sample++;
+    s = c.last;
+    return true;
+  }
+  return false;
+}
+
+static size_t putLe(uint8_t *p, uint32_t v, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+  return bytes;
+}
+
+size_t historyBlock(int block, uint8_t *buf, size_t len)
+{
+  if (block < 0 || block >= HISTORY_BLOCKS)
+    return 0;
+  const HistoryBlock &b = hist.blocks[(hist.head + 1 + block) % HISTORY_BLOCKS];
+  if (b.seq == 0 || len < HISTORY_BLOCK_HEADER + b.used)
+    return 0;
+  size_t n = putLe(buf, b.t0, 4);
+  n += putLe(buf + n, (uint16_t)b.deci0, 2);
+  n += putLe(buf + n, b.flags, 1);
+  n += putLe(buf + n, b.count, 2);
+  n += putLe(buf + n, b.used, 2);
+  memcpy(buf + n, b.data, b.used);
+  return n + b.used;
+}
+
+size_t historyReport(char *buf, size_t len)
+{
+  unsigned long samples = 0;
+  size_t bytes = 0;
+  int blocks = 0;
+  uint32_t first = 0;
+  int i = blockAt(0);
+  if (i >= 0)
+    first = hist.blocks[i].t0;
+  for (int n = 0; n < HISTORY_BLOCKS; n++)
+  {
+    const HistoryBlock &b = hist.blocks[n];
+    if (b.seq == 0)
+      continue;
+    blocks++;
+    samples += b.count;
+    bytes += HISTORY_BLOCK_HEADER + b.used;
+  }
+  uint32_t span = samples ? hist.lastT - first : 0;
+  int n = snprintf(buf, len, "history %lu samples in %d blocks, %u bytes (%.1f per sample), span %.1f h, nvs writes %lu\n",
+                   samples, blocks, (unsigned)bytes, samples ? (double)bytes / samples : 0.0, span / 3600.0, hist.writes);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
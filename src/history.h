@@ -0,0 +1,64 @@
+// Temperature history: fixed-size ring of delta compressed readings, optionally flushed to NVS
+// The ring is HISTORY_BLOCKS blocks of HISTORY_BLOCK_BYTES. A block starts with an absolute sample
+// (time, value); every further sample is two varints: seconds since the previous one and the
+// zigzag coded change in deci-degrees. At 5-minute samples that is 3 bytes a sample, so 4 KB hold
+// about four and a half days. A full ring drops its oldest block.
+// Time is the history clock in seconds: uptime, continued from the newest stored sample after a
+// restore. There is no wall clock, so the time the device was off is unknown; the first block
+// after boot is flagged HISTORY_FLAG_BOOT.
+// NVS: one blob per ring slot, written only when the block changed since the last flush. The open
+// block moves through the slots as it fills, NVS itself spreads rewrites over its pages.
+//
+// Binary export: per block, oldest first, a little endian header
+//   u32 t0, i16 deci0, u8 flags, u16 count, u16 used
+// followed by `used` bytes of (varint dt, zigzag varint ddeci) pairs for samples 2..count.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const int HISTORY_BLOCKS = 16;
+const size_t HISTORY_BLOCK_BYTES = 256;
+const size_t HISTORY_BLOCK_HEADER = 11; // binary export header
+
+const uint8_t HISTORY_FLAG_BOOT = 0x01; // unknown gap before this block
+
+struct HistorySample
+{
+  uint32_t t; // history clock, s
+  int32_t deci;
+  bool boot; // first sample of a block flagged HISTORY_FLAG_BOOT
+};
+
+/// @brief Decoding position, start with historyCursor()
+struct HistoryCursor
+{
+  int block; // blocks visited, oldest first
+  uint16_t sample;
+  uint16_t pos;
+  HistorySample last;
+};
+
+/// @brief Restore blocks from NVS (call once in setup)
+void historyBegin();
+
+/// @brief Append a reading at the current time
+void historyAdd(int32_t deci);
+
+/// @brief Write changed blocks to NVS
+/// @return Blobs written
+int historyFlush();
+
+HistoryCursor historyCursor();
+/// @brief Next sample, oldest first
+/// @return false at the end
+bool historyNext(HistoryCursor &c, HistorySample &s);
+
+/// @brief Binary export of the next block, oldest first (block is a ring visit count, 0..HISTORY_BLOCKS-1)
+/// @return Bytes written (header plus data), 0 for a slot not used yet or when it does not fit
+size_t historyBlock(int block, uint8_t *buf, size_t len);
+
+/// @brief Write sample count, bytes used, span and NVS writes as text
+/// @return Number of chars written
+size_t historyReport(char *buf, size_t len);
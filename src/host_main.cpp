@@ -0,0 +1,687 @@
+// Host (Linux) runner: runs setup() / loop() against the virtual clock of hal_host.cpp
+//
+//   firmware [--hours H] [--tick-ms N] [--wifi-outage MIN:DUR] [--sensor-outage MIN:DUR[:mdns|primary|fallback|broker]]
+//            [--web-every SEC] [--nvs FILE] [--quiet] [--sensor-server HOST:PORT] [--sensor-keepalive SEC]
+//            [--mdns-ttl SEC] [--fetch-mode sequential|race|hedged] [--sensor-timeouts CONNECT_MS:READ_MS]
+//            [--fusion best|median|weighted] [--poll-bounds MIN_S:MAX_S] [--push udp|http|mqtt] [--udp-listen] [--mqtt-broker HOST:PORT]
+//            [--history-out FILE[:csv|bin]] [--web-listen PORT] [--web-mode async|serial] [--play FPS:SECONDS]
+//            [--serial-pty]
+//   firmware --bench-pt | --bench-json | --bench-web | --fuzz-json N[:SEED] | --selftest
+//   firmware --udp-send HOST:PORT SENSOR:SEQ:TEMP
+//
+// Outage start and duration are in minutes of simulated time. --nvs keeps NVS contents in a file,
+// so consecutive runs behave like power cycles. --sensor-server sends thermometer requests to a real
+// HTTP server instead of the simulated one; --sensor-keepalive sets the simulated server idle timeout.
+// The fallback thermometer is only queried when built with SENSOR_FALLBACK_URL (native env does).
+// Tracking error of the panel against the simulated outdoor temperature is sampled every minute;
+// --poll-bounds 300:300 gives the old fixed 5 minute poll for comparison.
+// --push makes the primary thermometer push every 0.1 degree change; push -> latch is measured
+// end to end on the decoded display bus; every tenth datagram is sent twice, as multicast through
+// two access points would. --udp-listen opens a real UDP socket (port 5005, multicast group joined)
+// and runs in real time, so a local sender (--udp-send, or any other) can feed readings.
+// --push mqtt publishes retained bare numbers to the simulated broker (needs MQTT_BROKER, native env
+// sets it); --mqtt-broker connects to a real broker (e.g. a local Mosquitto) and runs in real time.
+// --history-out writes the /api/history response at the end of the run (with --nvs the history
+// carries over to the next run).
+// --web-listen serves the web pages on a real TCP port as well and runs in real time, so
+// tools/web_load.py can load it; --web-mode serial serves one client at a time, blocking, the way
+// the Arduino WebServer did (for comparison).
+// --play streams SECONDS of FPS frame records to /api/play from the first minute on, as a client
+// would, keeping the ring topped up; frame rate and latch timing are measured on the decoded bus.
+// --tick-ms takes fractions (0.05) to model the free-running loop of the device.
+// --serial-pty puts the serial port on a pseudo-terminal (path printed at start) and runs in real
+// time, for tools/serial_proto.py and the binary protocol of serial_proto.h.
+
+#ifndef ARDUINO
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "hal.h"
+#include "hal_host.h"
+#include "trace.h"
+#include "pt_bench.h"
+#include "fetch.h"
+#include "temp_json_bench.h"
+#include "web_root_bench.h"
+#include "ingest.h"
+#include "mqtt.h"
+#include "sources.h"
+#include "poll_sched.h"
+#include "history.h"
+#include "web_server.h"
+#include "display.h"
+#include "playback.h"
+#include "api_json.h"
+#include "serial_proto.h"
+#include "selftest.h"
+
+void setup();
+void loop();
+extern float currentTemp;
+
+// displayed vs simulated outdoor temperature
+const unsigned long TRACK_SAMPLE_MS = 60000;
+
+struct Tracking
+{
+  unsigned long nextSample;
+  unsigned long samples;
+  unsigned long wrongDigit; // panel shows another whole degree than the true temperature
+  double errTotal;
+  double errMax;
+};
+
+static Tracking tracking = {0, 0, 0, 0.0, 0.0};
+
+// ===== Frame stream client (--play) =====
+const int PLAY_BATCH = 200;                // records per POST, fits the request buffer
+const unsigned long PLAY_START_MS = 60000; // after boot and the first reading
+const unsigned long PLAY_RETRY_MS = 50;    // after a full ring
+const uint16_t PLAY_FRAME_MASK = 0xA5A5;   // record k shows k ^ mask, so the bus tells which one it was
+
+struct SimPlayer
+{
+  unsigned long fps;
+  uint16_t durationMs;
+  unsigned long total; // records to send
+  unsigned long sent;  // accepted by the firmware
+  int inFlight;        // records in the queued POST
+  unsigned long posts;
+  unsigned long full;  // refused, ring full
+  unsigned long nextPostMs;
+  // bus side: interval between latches of consecutive records against their duration
+  unsigned long seenLatches;
+  unsigned long latched;
+  long lastIdx;
+  uint64_t lastLatchUs;
+  unsigned long intervals;
+  uint64_t errTotalUs;
+  uint64_t errMaxUs;
+};
+
+static SimPlayer player = {0, 0, 0, 0, 0, 0, 0, PLAY_START_MS, 0, 0, -1, 0, 0, 0, 0};
+
+static void playStep()
+{
+  if (player.fps == 0)
+    return;
+  const HostStats &st = hostStats();
+  if (st.framesLatched != player.seenLatches)
+  {
+    player.seenLatches = st.framesLatched;
+    long idx = (uint16_t)(st.lastFrame ^ PLAY_FRAME_MASK);
+    if (idx < (long)player.total)
+    {
+      player.latched++;
+      if (player.lastIdx >= 0 && idx == player.lastIdx + 1)
+      {
+        uint64_t interval = st.lastLatchUs - player.lastLatchUs;
+        uint64_t expect = player.durationMs * 1000ULL;
+        uint64_t err = interval > expect ? interval - expect : expect - interval;
+        player.intervals++;
+        player.errTotalUs += err;
+        if (err > player.errMaxUs)
+          player.errMaxUs = err;
+      }
+      player.lastIdx = idx;
+      player.lastLatchUs = st.lastLatchUs;
+    }
+  }
+
+  if (player.inFlight)
+  {
+    if (hostWebBusy())
+      return;
+    char free[12];
+    bool isString;
+    if (hostWebLastStatus() == 200)
+    {
+      // next batch when there is room for it, from the free count of the answer
+      player.sent += player.inFlight;
+      if (apiJsonMember(hostWebLastBody(), "free", free, sizeof(free), isString) && atoi(free) < PLAY_BATCH)
+        player.nextPostMs = halMillis() + (PLAY_BATCH - atoi(free)) * (unsigned long)player.durationMs;
+    }
+    else
+    {
+      player.full++;
+      player.nextPostMs = halMillis() + PLAY_RETRY_MS;
+    }
+    player.inFlight = 0;
+  }
+  if (player.sent >= player.total || halMillis() < player.nextPostMs || hostWebBusy())
+    return;
+
+  uint8_t body[PLAY_BATCH * PLAYBACK_RECORD];
+  unsigned long n = player.total - player.sent < (unsigned long)PLAY_BATCH ? player.total - player.sent : PLAY_BATCH;
+  for (unsigned long k = 0; k < n; k++)
+  {
+    uint16_t frame = (uint16_t)((player.sent + k) ^ PLAY_FRAME_MASK);
+    uint8_t *r = body + k * PLAYBACK_RECORD;
+    r[0] = (uint8_t)frame;
+    r[1] = (uint8_t)(frame >> 8);
+    r[2] = (uint8_t)player.durationMs;
+    r[3] = (uint8_t)(player.durationMs >> 8);
+  }
+  if (hostWebQueuePostData("/api/play", "", "application/octet-stream", body, n * PLAYBACK_RECORD))
+  {
+    player.inFlight = (int)n;
+    player.posts++;
+  }
+}
+
+static void trackStep()
+{
+  if (halMillis() < tracking.nextSample)
+    return;
+  tracking.nextSample += TRACK_SAMPLE_MS;
+  if (hostStats().framesLatched == 0)
+    return;
+  float truth = hostSensorTemperature(halMillis());
+  double err = fabs((double)currentTemp - truth);
+  tracking.samples++;
+  tracking.errTotal += err;
+  if (err > tracking.errMax)
+    tracking.errMax = err;
+  if ((int)currentTemp != (int)truth)
+    tracking.wrongDigit++;
+}
+
+// thermometer pushing on change
+const unsigned long PUSH_SAMPLE_MS = 10000; // sensor measures this often
+const uint16_t PUSH_DUP_EVERY = 10;          // datagram duplicated by the network
+#define PUSH_MQTT_TOPIC "sensors/balkon/temperature"
+
+enum PushMode
+{
+  PUSH_OFF,
+  PUSH_UDP,
+  PUSH_HTTP,
+  PUSH_MQTT
+};
+
+struct SimPusher
+{
+  PushMode mode;
+  unsigned long nextSample;
+  int32_t lastDeci;
+  uint16_t seq;
+  unsigned long sent;
+  unsigned long dropped;
+  // push -> latch on the display bus
+  bool pending;
+  uint64_t pushedAt;
+  uint16_t expectFrame;
+  unsigned long samples;
+  unsigned long unshown; // fused with other sources, pushed value never on the panel
+  uint64_t latencyTotal;
+  uint64_t latencyMax;
+};
+
+static SimPusher pusher = {PUSH_OFF, PUSH_SAMPLE_MS, 100000, 0, 0, 0, false, 0, 0, 0, 0, 0, 0};
+
+static void pushStep()
+{
+  const HostStats &st = hostStats();
+  if (pusher.pending && st.lastFrame == pusher.expectFrame && st.lastLatchUs >= pusher.pushedAt)
+  {
+    uint64_t us = st.lastLatchUs - pusher.pushedAt;
+    pusher.pending = false;
+    pusher.samples++;
+    pusher.latencyTotal += us;
+    if (us > pusher.latencyMax)
+      pusher.latencyMax = us;
+  }
+
+  if (pusher.pending && hostNowUs() - pusher.pushedAt >= PUSH_SAMPLE_MS * 1000ULL)
+  {
+    pusher.pending = false;
+    pusher.unshown++;
+  }
+
+  if (pusher.mode == PUSH_OFF || halMillis() < pusher.nextSample)
+    return;
+  pusher.nextSample += PUSH_SAMPLE_MS;
+
+  float t = hostSensorTemperature(halMillis());
+  int32_t deci = (int32_t)(t * 10.0f + (t < 0 ? -0.5f : 0.5f));
+  if (deci == pusher.lastDeci)
+    return;
+
+  bool ok;
+  if (pusher.mode == PUSH_UDP)
+  {
+    IngestReading r = {1, pusher.seq++, deci};
+    uint8_t d[INGEST_DATAGRAM_LEN];
+    ok = hostUdpInject(d, ingestEncode(r, d, sizeof(d)));
+    if (ok && r.seq % PUSH_DUP_EVERY == 0)
+      hostUdpInject(d, sizeof(d));
+  }
+  else if (pusher.mode == PUSH_MQTT)
+  {
+    char payload[16];
+    snprintf(payload, sizeof(payload), "%.1f", deci / 10.0);
+    hostMqttPublish(PUSH_MQTT_TOPIC, payload, true);
+    ok = true; // the broker keeps it for the next subscriber
+  }
+  else
+  {
+    char body[64];
+    snprintf(body, sizeof(body), "{\"temperature\":%.1f}", deci / 10.0);
+    ok = hostWebQueuePost("/api/reading", body);
+  }
+  if (!ok)
+  {
+    pusher.dropped++;
+    return;
+  }
+  pusher.sent++;
+  pusher.lastDeci = deci;
+
+  uint16_t frame = frameForNumber(deci / 10.0f);
+  if (frame != st.lastFrame)
+  {
+    pusher.pending = true;
+    pusher.pushedAt = hostNowUs();
+    pusher.expectFrame = frame;
+  }
+}
+
+static bool parseOutage(const char *arg, unsigned long &startMs, unsigned long &durMs, HostSensorTarget &target)
+{
+  double start, dur;
+  char kind[16] = "";
+  int n = sscanf(arg, "%lf:%lf:%15s", &start, &dur, kind);
+  if (n < 2)
+    return false;
+  startMs = (unsigned long)(start * 60000.0);
+  durMs = (unsigned long)(dur * 60000.0);
+  if (kind[0] == '\0')
+    target = HOST_SENSOR_ALL;
+  else if (strcmp(kind, "mdns") == 0)
+    target = HOST_SENSOR_MDNS;
+  else if (strcmp(kind, "primary") == 0)
+    target = HOST_SENSOR_PRIMARY;
+  else if (strcmp(kind, "fallback") == 0)
+    target = HOST_SENSOR_FALLBACK;
+  else if (strcmp(kind, "broker") == 0)
+    target = HOST_SENSOR_BROKER;
+  else
+    return false;
+  return true;
+}
+
+/// @brief Send one reading datagram to a listening firmware
+static int udpSend(const char *hostPort, const char *reading)
+{
+  char host[64];
+  unsigned port, sensor, seq;
+  float temp;
+  if (sscanf(hostPort, "%63[^:]:%u", host, &port) != 2 || sscanf(reading, "%u:%u:%f", &sensor, &seq, &temp) != 3)
+    return 2;
+  uint32_t ip;
+  if (!ingestParseIp(host, ip))
+    return 2;
+
+  IngestReading r = {(uint8_t)sensor, (uint16_t)seq, (int32_t)(temp * 10.0f + (temp < 0 ? -0.5f : 0.5f))};
+  uint8_t d[INGEST_DATAGRAM_LEN];
+  ingestEncode(r, d, sizeof(d));
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)port);
+  addr.sin_addr.s_addr = ip;
+  // multicast stays on this host unless routed
+  struct in_addr loop;
+  loop.s_addr = htonl(INADDR_LOOPBACK);
+  if ((ip & 0xf0) == 0xe0)
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loop, sizeof(loop));
+  ssize_t n = fd < 0 ? -1 : sendto(fd, d, sizeof(d), 0, (struct sockaddr *)&addr, sizeof(addr));
+  if (fd >= 0)
+    close(fd);
+  if (n != (ssize_t)sizeof(d))
+  {
+    perror("sendto");
+    return 1;
+  }
+  return 0;
+}
+
+/// @brief Fetch /api/history and write it to a file, "FILE[:csv|bin]"
+static bool writeHistory(const char *arg)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s", arg);
+  const char *format = "csv";
+  char *colon = strrchr(path, ':');
+  if (colon && (strcmp(colon + 1, "csv") == 0 || strcmp(colon + 1, "bin") == 0))
+  {
+    *colon = '\0';
+    format = colon + 1;
+  }
+  char query[16];
+  snprintf(query, sizeof(query), "format=%s", format);
+  if (!hostWebQueue("/api/history", query))
+    return false;
+  for (int i = 0; i < 1000 && hostWebBusy(); i++)
+    webPoll(); // streamed, one transmit buffer per poll
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr)
+    return false;
+  bool ok = fwrite(hostWebLastBody(), 1, hostWebLastBodyLength(), f) == hostWebLastBodyLength();
+  return fclose(f) == 0 && ok;
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "usage: %s [--hours H] [--tick-ms N] [--wifi-outage MIN:DUR] [--sensor-outage MIN:DUR[:mdns|primary|fallback|broker]]\n"
+          "          [--web-every SEC] [--nvs FILE] [--quiet] [--sensor-server HOST:PORT] [--sensor-keepalive SEC]\n"
+          "          [--mdns-ttl SEC] [--fetch-mode sequential|race|hedged] [--sensor-timeouts CONNECT_MS:READ_MS]\n"
+          "          [--fusion best|median|weighted] [--poll-bounds MIN_S:MAX_S] [--push udp|http|mqtt] [--udp-listen] [--mqtt-broker HOST:PORT]\n"
+          "          [--history-out FILE[:csv|bin]] [--web-listen PORT] [--web-mode async|serial] [--play FPS:SECONDS]\n"
+          "          [--serial-pty]\n"
+          "       %s --bench-pt | --bench-json | --bench-web | --fuzz-json N[:SEED] | --selftest\n"
+          "       %s --udp-send HOST:PORT SENSOR:SEQ:TEMP\n",
+          prog, prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+  double hours = 24.0;
+  double tickMs = 10; // virtual time per idle loop() iteration
+  unsigned long webEveryMs = 0;
+  const char *nvsPath = nullptr;
+  FetchMode mode = FETCH_HEDGED;
+  bool fetchMode = false;
+  FusionPolicy fusion = FUSION_BEST;
+  bool fusionSet = false;
+  unsigned long pollMinS = 0, pollMaxS = 0;
+  const char *historyOut = nullptr;
+  WebMode webMode = WEB_ASYNC;
+  unsigned long connectMs = FETCH_CONNECT_TIMEOUT, readMs = FETCH_READ_TIMEOUT;
+  bool realTime = false;
+  bool serialPty = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *a = argv[i];
+    unsigned long startMs, durMs;
+    HostSensorTarget target;
+
+    if (strcmp(a, "--quiet") == 0)
+      hostSetQuiet(true);
+#if PT_BENCH_ENABLED
+    else if (strcmp(a, "--bench-pt") == 0)
+    {
+      char report[256];
+      ptBenchmark(report, sizeof(report));
+      printf("%s", report);
+      return 0;
+    }
+#endif
+#if WEB_ROOT_BENCH_ENABLED
+    else if (strcmp(a, "--bench-web") == 0)
+    {
+      char report[512];
+      webRootBenchmark(report, sizeof(report));
+      printf("%s", report);
+      return 0;
+    }
+#endif
+#if TEMP_JSON_BENCH_ENABLED
+    else if (strcmp(a, "--bench-json") == 0)
+    {
+      char report[512];
+      tempJsonBenchmark(report, sizeof(report));
+      printf("%s", report);
+      return 0;
+    }
+    else if (strcmp(a, "--fuzz-json") == 0 && i + 1 < argc)
+    {
+      unsigned long iterations = 0;
+      unsigned long seed = 1;
+      sscanf(argv[++i], "%lu:%lu", &iterations, &seed);
+      char report[1200];
+      bool ok = tempJsonFuzz(iterations, (uint32_t)seed, report, sizeof(report));
+      printf("%s", report);
+      return ok ? 0 : 1;
+    }
+#endif
+#if SELFTEST_ENABLED
+    else if (strcmp(a, "--selftest") == 0)
+    {
+      char report[2048];
+      bool ok = selftestRun(report, sizeof(report));
+      printf("%s%s\n", report, ok ? "selftest passed" : "selftest FAILED");
+      return ok ? 0 : 1;
+    }
+#endif
+    else if (strcmp(a, "--udp-listen") == 0)
+    {
+      hostSetUdpSocket(true);
+      realTime = true;
+    }
+    else if (strcmp(a, "--serial-pty") == 0)
+    {
+      const char *path = hostSetSerialPty();
+      if (!path)
+      {
+        fprintf(stderr, "cannot open a pseudo-terminal\n");
+        return 1;
+      }
+      printf("serial port %s\n", path);
+      fflush(stdout);
+      serialPty = true;
+      realTime = true;
+    }
+    else if (strcmp(a, "--udp-send") == 0 && i + 2 < argc)
+      return udpSend(argv[i + 1], argv[i + 2]);
+    else if (i + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 2;
+    }
+    else if (strcmp(a, "--hours") == 0)
+      hours = atof(argv[++i]);
+    else if (strcmp(a, "--tick-ms") == 0)
+      tickMs = atof(argv[++i]);
+    else if (strcmp(a, "--web-every") == 0)
+      webEveryMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+    else if (strcmp(a, "--nvs") == 0)
+      nvsPath = argv[++i];
+    else if (strcmp(a, "--sensor-keepalive") == 0)
+      hostSetSensorKeepAlive(strtoul(argv[++i], nullptr, 10));
+    else if (strcmp(a, "--fetch-mode") == 0 && fetchModeFromName(argv[++i], mode))
+      fetchMode = true;
+    else if (strcmp(a, "--fusion") == 0 && sourcePolicyFromName(argv[++i], fusion))
+      fusionSet = true;
+    else if (strcmp(a, "--poll-bounds") == 0 && sscanf(argv[++i], "%lu:%lu", &pollMinS, &pollMaxS) == 2)
+      ;
+    else if (strcmp(a, "--history-out") == 0)
+      historyOut = argv[++i];
+    else if (strcmp(a, "--web-listen") == 0)
+    {
+      hostSetWebListen((uint16_t)atoi(argv[++i]));
+      hostSetRealTime(true);
+      realTime = true;
+    }
+    else if (strcmp(a, "--web-mode") == 0)
+    {
+      const char *m = argv[++i];
+      if (strcmp(m, "serial") == 0)
+        webMode = WEB_SERIAL;
+      else if (strcmp(m, "async") != 0)
+      {
+        usage(argv[0]);
+        return 2;
+      }
+    }
+    else if (strcmp(a, "--play") == 0 && sscanf(argv[++i], "%lu:%lu", &player.fps, &player.total) == 2 &&
+             player.fps > 0 && player.fps <= 1000)
+    {
+      player.durationMs = (uint16_t)((1000 + player.fps / 2) / player.fps);
+      player.total *= player.fps;
+    }
+    else if (strcmp(a, "--sensor-timeouts") == 0 && sscanf(argv[++i], "%lu:%lu", &connectMs, &readMs) == 2)
+      ;
+    else if (strcmp(a, "--push") == 0)
+    {
+      const char *m = argv[++i];
+      pusher.mode = strcmp(m, "udp") == 0    ? PUSH_UDP
+                    : strcmp(m, "http") == 0 ? PUSH_HTTP
+                    : strcmp(m, "mqtt") == 0 ? PUSH_MQTT
+                                             : PUSH_OFF;
+    }
+    else if (strcmp(a, "--mqtt-broker") == 0 && hostSetMqttBroker(argv[++i]))
+      realTime = true;
+    else if (strcmp(a, "--mdns-ttl") == 0)
+      hostSetMdnsTtl(strtoul(argv[++i], nullptr, 10));
+    else if (strcmp(a, "--sensor-server") == 0 && hostSetSensorServer(argv[++i]))
+      ;
+    else if (strcmp(a, "--wifi-outage") == 0 && parseOutage(argv[++i], startMs, durMs, target))
+      hostAddWifiOutage(startMs, durMs);
+    else if (strcmp(a, "--sensor-outage") == 0 && parseOutage(argv[++i], startMs, durMs, target))
+      hostAddSensorOutage(startMs, durMs, target);
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  uint64_t tickUs = (uint64_t)(tickMs * 1000.0);
+  if (tickUs == 0)
+    tickUs = 1000;
+
+  if (nvsPath)
+    hostStoreLoad(nvsPath);
+
+  clock_t wallStart = clock();
+  uint64_t endUs = (uint64_t)(hours * 3600.0 * 1e6);
+  unsigned long loops = 0;
+  unsigned long nextWebMs = webEveryMs;
+  int webToggle = 0;
+
+  setup();
+  webSetMode(webMode);
+  if (fetchMode)
+    fetchSetMode(mode);
+  if (fusionSet)
+    sourceSetPolicy(fusion);
+  if (pollMaxS)
+    pollSchedSetBounds(pollMinS * 1000UL, pollMaxS * 1000UL);
+  fetchSetTimeouts(connectMs, readMs);
+  while (hostNowUs() < endUs)
+  {
+    loop();
+    loops++;
+    hostAdvanceUs(tickUs);
+    pushStep();
+    trackStep();
+    playStep();
+    if (realTime)
+    {
+      struct timespec ts = {(time_t)(tickUs / 1000000), (long)(tickUs % 1000000) * 1000L};
+      nanosleep(&ts, nullptr);
+    }
+
+    if (webEveryMs && halMillis() >= nextWebMs)
+    {
+      // alternate page views and test values
+      char query[32];
+      snprintf(query, sizeof(query), "temp=%d", (webToggle % 40) - 20);
+      if (webToggle++ % 2 == 0)
+      {
+        hostWebQueue("/", "");
+        hostWebQueueHeader("Accept-Encoding", "gzip, deflate");
+      }
+      else
+        hostWebQueue("/set", query);
+      nextWebMs += webEveryMs;
+    }
+  }
+
+  double wall = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+  const HostStats &st = hostStats();
+  printf("\n==== simulated %.2f h in %.2f s (x%.0f), %lu loop iterations\n", hours, wall,
+         wall > 0 ? hours * 3600.0 / wall : 0.0, loops);
+  printf("frames latched   %lu (last 0x%04x)\n", st.framesLatched, st.lastFrame);
+  printf("mdns queries     %lu\n", st.mdnsQueries);
+  printf("http requests    %lu (failed %lu, cancelled %lu)\n", st.httpRequests, st.httpFailures, st.httpCancelled);
+  printf("wifi connects    %lu\n", st.wifiConnects);
+  printf("tcp connects     %lu\n", st.tcpConnects);
+  printf("web requests     %lu (errors %lu)\n", st.webRequests, st.webErrors);
+  static char webText[256];
+  webReport(webText, sizeof(webText));
+  printf("%s", webText);
+
+  static char fetchReport[1024];
+  fetchStatsReport(fetchReport, sizeof(fetchReport));
+  printf("%s", fetchReport);
+  sourceReport(fetchReport, sizeof(fetchReport));
+  printf("%s", fetchReport);
+  pollSchedReport(fetchReport, sizeof(fetchReport));
+  printf("%s", fetchReport);
+  historyReport(fetchReport, sizeof(fetchReport));
+  printf("%s", fetchReport);
+  printf("tracking         mean |error| %.2f C, max %.2f C, wrong digit %.1f %% of %lu minutes\n",
+         tracking.samples ? tracking.errTotal / tracking.samples : 0.0, tracking.errMax,
+         tracking.samples ? 100.0 * tracking.wrongDigit / tracking.samples : 0.0, tracking.samples);
+
+  if (pusher.mode != PUSH_OFF)
+    printf("pushes sent      %lu (dropped %lu), end to end push->latch %lu samples, avg %lu us, max %lu us, "
+           "%lu not shown as pushed\n",
+           pusher.sent, pusher.dropped, pusher.samples,
+           pusher.samples ? (unsigned long)(pusher.latencyTotal / pusher.samples) : 0UL,
+           (unsigned long)pusher.latencyMax, pusher.unshown);
+  if (pusher.mode != PUSH_OFF || realTime)
+  {
+    char ingestText[512];
+    size_t n = ingestReport(ingestText, sizeof(ingestText));
+    mqttReport(ingestText + n, sizeof(ingestText) - n);
+    printf("%s", ingestText);
+  }
+
+  if (serialPty)
+  {
+    char serialText[128];
+    serialProtoReport(serialText, sizeof(serialText));
+    printf("%s", serialText);
+  }
+
+  if (player.fps)
+  {
+    printf("play             %lu fps requested (%u ms records), %lu of %lu records sent in %lu posts, %lu refused "
+           "(ring full)\n"
+           "                 bus: %lu latched, interval error avg %lu us, max %lu us over %lu intervals\n",
+           player.fps, player.durationMs, player.sent, player.total, player.posts, player.full, player.latched,
+           player.intervals ? (unsigned long)(player.errTotalUs / player.intervals) : 0UL,
+           (unsigned long)player.errMaxUs, player.intervals);
+    char playText[256];
+    playbackReport(playText, sizeof(playText));
+    printf("%s", playText);
+  }
+
+#if TRACE_ENABLED
+  static char report[2048];
+  traceReport(report, sizeof(report));
+  printf("%s", report);
+#endif
+
+  if (historyOut && !writeHistory(historyOut))
+    fprintf(stderr, "cannot write %s\n", historyOut);
+
+  if (nvsPath)
+    hostStoreSave(nvsPath);
+  return 0;
+}
+
+#endif
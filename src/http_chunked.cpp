@@ -0,0 +1,119 @@
+// Decoder for HTTP/1.1 chunked transfer coding, see http_chunked.h
+
+#include <string.h>
+
+#include "http_chunked.h"
+
+// largest chunk accepted: a thermometer body is well under 1 KB, a bigger size line is garbage
+const uint32_t HTTP_CHUNKED_MAX_SIZE = 0xFFFF;
+
+enum HttpChunkedState
+{
+  HC_SIZE,          // before the first hex digit of a chunk size
+  HC_SIZE_MORE,     // in the hex digits
+  HC_EXT,           // chunk extension, up to CR
+  HC_SIZE_LF,       // after the size line's CR
+  HC_DATA,          // payload
+  HC_DATA_CR,       // after the payload
+  HC_DATA_LF,
+  HC_TRAILER_START, // start of a trailer line, or of the final empty line
+  HC_TRAILER_LINE,  // trailer field, up to LF
+  HC_END_LF         // after the final CR
+};
+
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+void httpChunkedInit(HttpChunked &d)
+{
+  d.state = HC_SIZE;
+  d.left = 0;
+  d.status = HTTP_CHUNKED_MORE;
+}
+
+size_t httpChunkedFeed(HttpChunked &d, char *data, size_t len, size_t &used)
+{
+  size_t out = 0;
+  size_t i = 0;
+  while (i < len && d.status == HTTP_CHUNKED_MORE)
+  {
+    if (d.state == HC_DATA)
+    {
+      // payload run: move it down over the framing already cut out
+      size_t n = len - i < d.left ? len - i : d.left;
+      if (out != i)
+        memmove(data + out, data + i, n);
+      out += n;
+      i += n;
+      d.left -= n;
+      if (d.left == 0)
+        d.state = HC_DATA_CR;
+      continue;
+    }
+
+    char c = data[i++];
+    int h;
+    switch (d.state)
+    {
+    case HC_SIZE:
+    case HC_SIZE_MORE:
+      h = hexValue(c);
+      if (h >= 0)
+      {
+        if (d.left > HTTP_CHUNKED_MAX_SIZE >> 4)
+          d.status = HTTP_CHUNKED_ERROR;
+        d.left = (d.left << 4) | h;
+        d.state = HC_SIZE_MORE;
+      }
+      else if (d.state == HC_SIZE)
+        d.status = HTTP_CHUNKED_ERROR;
+      else if (c == ';' || c == ' ' || c == '\t')
+        d.state = HC_EXT;
+      else if (c == '\r')
+        d.state = HC_SIZE_LF;
+      else
+        d.status = HTTP_CHUNKED_ERROR;
+      break;
+    case HC_EXT:
+      if (c == '\r')
+        d.state = HC_SIZE_LF;
+      break;
+    case HC_SIZE_LF:
+      if (c != '\n')
+        d.status = HTTP_CHUNKED_ERROR;
+      else
+        d.state = d.left ? HC_DATA : HC_TRAILER_START;
+      break;
+    case HC_DATA_CR:
+      if (c != '\r')
+        d.status = HTTP_CHUNKED_ERROR;
+      d.state = HC_DATA_LF;
+      break;
+    case HC_DATA_LF:
+      if (c != '\n')
+        d.status = HTTP_CHUNKED_ERROR;
+      d.state = HC_SIZE;
+      break;
+    case HC_TRAILER_START:
+      d.state = c == '\r' ? HC_END_LF : HC_TRAILER_LINE;
+      break;
+    case HC_TRAILER_LINE:
+      if (c == '\n')
+        d.state = HC_TRAILER_START;
+      break;
+    case HC_END_LF:
+      d.status = c == '\n' ? HTTP_CHUNKED_DONE : HTTP_CHUNKED_ERROR;
+      break;
+    }
+  }
+  used = i;
+  return out;
+}
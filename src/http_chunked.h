@@ -0,0 +1,32 @@
+// Decoder for HTTP/1.1 chunked transfer coding of a response body
+// Works in place on whatever the socket just gave: the chunk-size lines, chunk CRLFs and the
+// trailer are cut out and the payload bytes moved to the front of the buffer, so the body can go
+// on to a streaming reader (temp_json.h) without a copy. Chunk extensions and trailer fields are
+// skipped. No heap.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum HttpChunkedStatus
+{
+  HTTP_CHUNKED_MORE,  // feed more input
+  HTTP_CHUNKED_DONE,  // last chunk and trailer read, the body is complete
+  HTTP_CHUNKED_ERROR  // not valid chunked framing
+};
+
+struct HttpChunked
+{
+  uint8_t state;
+  uint32_t left; // payload bytes left in the current chunk, or its size while parsed
+  HttpChunkedStatus status;
+};
+
+/// @brief Reset decoder for a new body
+void httpChunkedInit(HttpChunked &d);
+
+/// @brief Decode next piece of the body in place
+/// @param used  Output: input bytes consumed, less than len once the body is complete
+/// @return Payload bytes now at the front of data
+size_t httpChunkedFeed(HttpChunked &d, char *data, size_t len, size_t &used);
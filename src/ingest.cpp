@@ -0,0 +1,166 @@
+// Push ingestion, see ingest.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "display.h"
+#include "ingest.h"
+#include "trace.h"
+
+struct IngestStats
+{
+  unsigned long accepted[INGEST_PATH_COUNT];
+  unsigned long rejected[INGEST_PATH_COUNT];
+  unsigned long stale; // duplicate or out of order datagrams
+  unsigned long latched; // pushes that changed the panel
+  unsigned long latencyUsTotal;
+  unsigned long latencyUsMax;
+};
+
+// last accepted sequence number per sensor
+struct IngestSeq
+{
+  bool used;
+  uint8_t sensor;
+  uint16_t seq;
+  unsigned long lastMs;
+};
+
+static IngestStats ingest;
+static IngestSeq seqs[INGEST_MAX_SENSORS];
+static bool latchPending = false;
+static uint16_t latchFrame = 0;
+static unsigned long latchFromUs = 0;
+
+static const char *const PATH_NAMES[INGEST_PATH_COUNT] = {"http", "udp", "mqtt"};
+
+void ingestBegin(uint16_t udpPort, const char *group)
+{
+  uint32_t ip = 0;
+  if (group[0] && !ingestParseIp(group, ip))
+    halLog("[ingest] bad multicast group %s\n", group);
+  if (!halUdpBegin(udpPort, ip))
+    halLog("[ingest] UDP port %u not available\n", udpPort);
+}
+
+bool ingestParseIp(const char *text, uint32_t &ip)
+{
+  unsigned a, b, c, d;
+  char end;
+  if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+    return false;
+  ip = a | (b << 8) | (c << 16) | ((uint32_t)d << 24);
+  return true;
+}
+
+/// @brief Sequence number check, remembers seq if the datagram is new
+static bool seqIsNew(const IngestReading &r)
+{
+  unsigned long now = halMillis();
+  IngestSeq *slot = nullptr;
+  for (int i = 0; i < INGEST_MAX_SENSORS; i++)
+  {
+    IngestSeq &s = seqs[i];
+    if (s.used && s.sensor == r.sensor)
+    {
+      if (now - s.lastMs < INGEST_SEQ_RESET_MS && (int16_t)(r.seq - s.seq) <= 0)
+        return false;
+      slot = &s;
+      break;
+    }
+    // free slot, else the sensor heard from longest ago
+    if (slot == nullptr || !s.used || (slot->used && now - s.lastMs > now - slot->lastMs))
+      slot = &s;
+  }
+  slot->used = true;
+  slot->sensor = r.sensor;
+  slot->seq = r.seq;
+  slot->lastMs = now;
+  return true;
+}
+
+bool ingestDecode(const uint8_t *buf, size_t len, IngestReading &r)
+{
+  if (len != INGEST_DATAGRAM_LEN || buf[0] != 'B' || buf[1] != 'T' || buf[2] != INGEST_VERSION)
+    return false;
+  r.sensor = buf[3];
+  r.seq = (uint16_t)(buf[4] | (buf[5] << 8));
+  r.deci = (int16_t)(uint16_t)(buf[6] | (buf[7] << 8));
+  return true;
+}
+
+size_t ingestEncode(const IngestReading &r, uint8_t *buf, size_t len)
+{
+  if (len < INGEST_DATAGRAM_LEN)
+    return 0;
+  uint16_t deci = (uint16_t)(int16_t)r.deci;
+  buf[0] = 'B';
+  buf[1] = 'T';
+  buf[2] = INGEST_VERSION;
+  buf[3] = r.sensor;
+  buf[4] = (uint8_t)(r.seq & 0xff);
+  buf[5] = (uint8_t)(r.seq >> 8);
+  buf[6] = (uint8_t)(deci & 0xff);
+  buf[7] = (uint8_t)(deci >> 8);
+  return INGEST_DATAGRAM_LEN;
+}
+
+bool ingestUdpRead(IngestReading &r)
+{
+  uint8_t buf[16];
+  size_t n;
+  while ((n = halUdpRead(buf, sizeof(buf))) > 0)
+  {
+    if (!ingestDecode(buf, n, r))
+      ingest.rejected[INGEST_UDP]++;
+    else if (!seqIsNew(r))
+      ingest.stale++;
+    else
+      return true;
+  }
+  return false;
+}
+
+void ingestReject(IngestPath path)
+{
+  ingest.rejected[path]++;
+}
+
+void ingestApplied(IngestPath path, uint16_t frame)
+{
+  ingest.accepted[path]++;
+  if (frame == displayFrame())
+    return; // panel already shows it, nothing to time
+  latchPending = true;
+  latchFrame = frame;
+  latchFromUs = halMicros();
+}
+
+void ingestLatencyCheck()
+{
+  if (!latchPending || displayFrame() != latchFrame)
+    return;
+  latchPending = false;
+  unsigned long us = halMicros() - latchFromUs;
+  ingest.latched++;
+  ingest.latencyUsTotal += us;
+  if (us > ingest.latencyUsMax)
+    ingest.latencyUsMax = us;
+#if TRACE_ENABLED
+  traceRecord(TRACE_PUSH_LATCH, us * halCyclesPerUs());
+#endif
+}
+
+size_t ingestReport(char *buf, size_t len)
+{
+  size_t n = 0;
+  for (int i = 0; i < INGEST_PATH_COUNT && n < len; i++)
+    n += snprintf(buf + n, len - n, "%-5s accepted %lu rejected %lu\n", PATH_NAMES[i], ingest.accepted[i],
+                  ingest.rejected[i]);
+  if (n < len)
+    n += snprintf(buf + n, len - n, "udp   duplicate or out of order %lu\n", ingest.stale);
+  if (n < len)
+    n += snprintf(buf + n, len - n, "push->latch %lu samples, avg %lu us, max %lu us\n", ingest.latched,
+                  ingest.latched ? ingest.latencyUsTotal / ingest.latched : 0, ingest.latencyUsMax);
+  return n < len ? n : len - 1;
+}
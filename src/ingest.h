@@ -0,0 +1,74 @@
+// Push ingestion: thermometers post readings instead of waiting to be polled
+// Ways in: HTTP POST /api/reading with the usual JSON payload (handled in main.cpp), a compact
+// binary UDP datagram (unicast, broadcast or to a multicast group) and MQTT (see mqtt.h). Polling
+// stays as liveness fallback.
+//
+// Datagram, 8 bytes, little endian:
+//   0..1  magic "BT"
+//   2     version (INGEST_VERSION)
+//   3     sensor id
+//   4..5  sequence number
+//   6..7  temperature in deci-degrees (int16)
+//
+// Per sensor, only datagrams with a sequence number newer than the last accepted one (serial
+// number arithmetic, RFC 1982) get through, so duplicates and reordered datagrams are dropped.
+// A sensor that stays silent for INGEST_SEQ_RESET_MS starts over (it may have rebooted).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const uint8_t INGEST_VERSION = 1;
+const size_t INGEST_DATAGRAM_LEN = 8;
+const int INGEST_MAX_SENSORS = 4;                // sensors tracked for sequence numbers
+const unsigned long INGEST_SEQ_RESET_MS = 60000; // silence after which any sequence number is accepted
+
+struct IngestReading
+{
+  uint8_t sensor;
+  uint16_t seq;
+  int32_t deci;
+};
+
+enum IngestPath
+{
+  INGEST_HTTP,
+  INGEST_UDP,
+  INGEST_MQTT,
+  INGEST_PATH_COUNT
+};
+
+/// @brief Open the UDP port
+/// @param group  Multicast group to join, e.g. "239.66.84.1", empty = unicast / broadcast only
+void ingestBegin(uint16_t udpPort, const char *group);
+
+/// @brief Parse dotted quad
+/// @param ip  Output: network byte order as in IPAddress
+bool ingestParseIp(const char *text, uint32_t &ip);
+
+/// @brief Decode binary datagram
+/// @return false if it is not a reading datagram
+bool ingestDecode(const uint8_t *buf, size_t len, IngestReading &r);
+
+/// @brief Encode binary datagram (for senders and tests)
+/// @return INGEST_DATAGRAM_LEN, 0 if buf is too small
+size_t ingestEncode(const IngestReading &r, uint8_t *buf, size_t len);
+
+/// @brief Next valid datagram from the UDP port (non-blocking), bad, duplicate and out of order ones
+/// are counted and dropped
+bool ingestUdpRead(IngestReading &r);
+
+/// @brief Count a rejected push (malformed or out of range)
+void ingestReject(IngestPath path);
+
+/// @brief Reading from path was put on the value layer, starts push -> latch timing
+/// @param frame  Frame the panel will show for it
+void ingestApplied(IngestPath path, uint16_t frame);
+
+/// @brief Call after the display task: completes push -> latch timing
+void ingestLatencyCheck();
+
+/// @brief Write counters and push -> latch latency as text
+/// @return Number of chars written
+size_t ingestReport(char *buf, size_t len);
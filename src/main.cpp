@@ -1,52 +1,154 @@
-// ESP32 OPEN-DRAIN DRIVER for OUTDOOR display (16-bit frames)
-// Pins used: CLOCK -> GPIO4, LATCH -> GPIO2, DATA -> GPIO3
-// Open-drain emulation: OUTPUT LOW to pull line low, INPUT to release (pull-up pulls HIGH)
-// BIT_ON_HIGH = true means bit==1 -> LINE HIGH (LED ON), bit==0 -> LINE LOW (LED OFF)
+// OUTDOOR temperature display: WiFi thermometer client + web control
+// Display driver and frame compositor: display.cpp
+// Main loop runs cooperative tasks (pt.h): WiFi manager, sensor poller, animator, display service.
 
-#include <Arduino.h>
-#include <HTTPClient.h>
-#include <WiFi.h>
-#include <WebServer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "hal.h"
+#include "pt.h"
 #include "wifi_pass.h"
-#include "outdoor_symbols.h"
-
-// Pin definitions
-const int PIN_LATCH = 2; // green
-const int PIN_DATA = 3;  // blue
-const int PIN_CLOCK = 4; // yellow
-
-// ===== HTTP server =====
-WebServer server(80);
+#include "display.h"
+#include "display_cmd.h"
+#include "fetch.h"
+#include "mdns_cache.h"
+#include "ingest.h"
+#include "mqtt.h"
+#include "sources.h"
+#include "poll_sched.h"
+#include "history.h"
+#include "web_server.h"
+#include "api_json.h"
+#include "events.h"
+#include "metrics.h"
+#include "playback.h"
+#include "serial_proto.h"
+#include "web_root.h"
+#include "web_root_bench.h"
+#include "temp_json.h"
+#include "wifi_fast.h"
+#include "boot_cache.h"
+#include "boot_profile.h"
+#include "trace.h"
+#include "pt_bench.h"
+#include "temp_json_bench.h"
+
+// thermometer mDNS name
+const char *const SENSOR_HOST = "temperatura_na_balkonie.local";
+
+// second thermometer JSON url, empty = none
+#ifndef SENSOR_FALLBACK_URL
+#define SENSOR_FALLBACK_URL ""
+#endif
+
+// how the sources are queried, see fetch.h (can be changed at /fetch?mode=)
+const FetchMode SENSOR_FETCH_MODE = FETCH_HEDGED;
+// how values of all sources (polled and pushed) become the displayed one, see sources.h
+// (can be changed at /sources?policy=)
+const FusionPolicy SENSOR_FUSION = FUSION_BEST;
 
 // ===== Temperature read interval =====
+// adaptive between these bounds (see poll_sched.h); liveness fallback: a pushed reading resets the
+// timer, so a thermometer pushing on change is not polled
+const unsigned long SENSOR_POLL_MIN = 60000;  // 1 minute
+const unsigned long SENSOR_POLL_MAX = 600000; // 10 minutes
+
+// ===== Temperature history (history.h) =====
+const unsigned long HISTORY_SAMPLE_INTERVAL = 300000; // 5 minutes
+const unsigned int HISTORY_FLUSH_SAMPLES = 12;        // NVS flush every hour, 0 = RAM only
+
+// pushed readings, see ingest.h
+const uint16_t INGEST_UDP_PORT = 5005;
+// multicast group sensors send to, empty = unicast / broadcast only
+#ifndef INGEST_UDP_GROUP
+#define INGEST_UDP_GROUP "239.66.84.1"
+#endif
+// MQTT broker "host[:port]", empty = no MQTT; topic carries a bare number or the thermometer JSON
+#ifndef MQTT_BROKER
+#define MQTT_BROKER ""
+#endif
+const char *const MQTT_TOPIC = "sensors/balkon/temperature";
 // actual temperature to display
 float currentTemp = 0;
 
-// main functions to set display
-void setOutdoorDisplay(int num);
-void setOutdoorDisplay(const String &data);
-void setOutdoorDisplay_animate(int idx);
+// display shows cached value from previous power cycle (celsius sign off until first fetch)
+bool displayStale = false;
+
+// max time to wait for display bus pull-ups after power-on
+const unsigned long BUS_READY_TIMEOUT = 2000;
+
+// ===== WiFi timings =====
+const unsigned long WIFI_RECONNECT_INTERVAL = 15000;
+const unsigned long WIFI_ANIM_INTERVAL = 500;
+
+// ===== Task state =====
+struct WifiState
+{
+  bool connected;
+  unsigned long lastReconnectAttempt;
+  bool blinkOn;
+  bool wasUp;               // link was up since boot, an outage is timed from downSince
+  unsigned long downSince;
+};
+
+struct SensorState
+{
+  bool pollNow; // set on (re)connect: read temp immediately
+  unsigned long lastPoll;
+  bool error;
+  uint32_t ip;
+  char primaryUrl[32];
+  float temp;
+  int source;
+};
+
+struct AnimState
+{
+  bool startRequest; // play start animation once
+  int idx;
+  int errorIdx;
+  unsigned long lastErrorFrame;
+};
+
+static WifiState wifi = {false, 0, false, false, 0};
+static SensorState sensor = {false, 0, false, 0, "", 0, -1};
+static AnimState anim = {false, 0, 0, 0};
+
+static Pt wifiPt, blinkPt, mqttPt, mdnsPt, sensorPt, animPt, displayPt, historyPt;
+static unsigned int historyUnflushed = 0;
 
 // www handlers
 void server_handleRoot();
 void server_handleSet();
-
-// heldpers for open-drain signaling
-inline void setPinLow(int pin);
-void initPins();
-inline void setDataBit(uint8_t bit);
-inline void setPinHigh(int pin);
-inline void pulseClock();
-void pulseLatch();
-bool every5Minuts(bool reset = false);
-bool everySecond();
-void WifiCheck();
-void animateStartLCD();
-bool validateTemp(float t);
-
-void sendBitsArray(const bool *digit1, const bool *digit2, bool minus, bool celsius);
-float getOutdoorTemperature(const String &url);
+void server_handleBoot();
+void server_handleTrace();
+void server_handleFetch();
+void server_handleMdns();
+void server_handleReading();
+void server_handleIngest();
+void server_handleMqtt();
+void server_handleSources();
+void server_handleHistory();
+void server_handleWeb();
+void server_handleApiState();
+void server_handleApiDisplay();
+void server_handleEvents();
+void server_handleMetrics();
+void server_handleApiPlay();
+
+int wifiTask(Pt *pt);
+int wifiBlinkTask(Pt *pt);
+int sensorTask(Pt *pt);
+int animatorTask(Pt *pt);
+int historyTask(Pt *pt);
+void serialPoll();
+void serialCommand(int c);
+void serial_handleCommand(uint8_t type, const uint8_t *body, size_t len);
+void pushPoll();
+uint16_t applyReading(int32_t deci);
+uint16_t applyFused();
+void showCachedFrame();
 
 //-------------------------------------------------------------------------------------------------------
 
@@ -55,488 +157,968 @@ float getOutdoorTemperature(const String &url);
 void setup()
 {
   initPins();
-  delay(2000);
-  WiFi.setHostname("BLAUEPUNKT-DISPLAY");
-  WiFi.setAutoConnect(true);
-  WiFi.setAutoReconnect(true);
-  WiFi.setSleep(false);
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(SSID, PASSWORD);
-
-  server.on("/", server_handleRoot);
-  server.on("/set", server_handleSet);
-  server.begin();
+#if TRACE_ENABLED
+  traceInit();
+#endif
+  bootProfileMark("pins");
+  halSerialBegin(115200);
+  serialProtoBegin(serial_handleCommand);
+  wifiFastTimingStart("boot");
+  bootProfileMark("serial");
+
+  // display controller is ready once it powers the bus pull-ups
+  if (!waitBusReady(BUS_READY_TIMEOUT))
+    halLog("[boot] display bus not ready, continuing\n");
+  bootProfileMark("bus_ready");
+
+  showCachedFrame();
+  bootProfileMark("cached");
+
+  halWifiInit("BLAUEPUNKT-DISPLAY");
+  wifiFastInit();
+  mdnsCacheInit(SENSOR_HOST);
+  mqttInit(MQTT_BROKER, MQTT_TOPIC, "blauepunkt-display");
+  fetchSetMode(SENSOR_FETCH_MODE);
+  sourceSetPolicy(SENSOR_FUSION);
+  // polled thermometers take their registry slots before any pushed sensor is heard
+  sourceFind(SOURCE_HTTP, SENSOR_PRIMARY);
+  if (SENSOR_FALLBACK_URL[0])
+    sourceFind(SOURCE_HTTP, SENSOR_FALLBACK);
+  pollSchedSetBounds(SENSOR_POLL_MIN, SENSOR_POLL_MAX);
+  historyBegin();
+  wifiFastBegin(); // targeted connect from cache, full scan otherwise
+  bootProfileMark("wifi");
+
+  webOn("/", server_handleRoot);
+  webOn("/set", server_handleSet);
+  webOn("/boot", server_handleBoot);
+  webOn("/fetch", server_handleFetch);
+  webOn("/mdns", server_handleMdns);
+  webOn("/api/reading", server_handleReading);
+  webOn("/ingest", server_handleIngest);
+  webOn("/mqtt", server_handleMqtt);
+  webOn("/sources", server_handleSources);
+  webOn("/api/history", server_handleHistory);
+  webOn("/web", server_handleWeb);
+  webOn("/api/state", server_handleApiState);
+  webOn("/api/display", server_handleApiDisplay);
+  webOn("/api/events", server_handleEvents);
+  webOn("/metrics", server_handleMetrics);
+  webOn("/api/play", server_handleApiPlay);
+#if TRACE_ENABLED
+  webOn("/trace", server_handleTrace);
+#endif
+  webBegin(80);
+  ingestBegin(INGEST_UDP_PORT, INGEST_UDP_GROUP);
+  bootProfileMark("server");
 }
 
-void animateStartLCD()
+/// @brief Latch last good frame from previous run, marked stale (celsius sign off)
+void showCachedFrame()
 {
-  for (size_t i = 0; i < 12; i++)
-  {
-    setOutdoorDisplay_animate(i);
-    delay(100);
-  }
+  uint16_t frame;
+  float temp;
+  if (!bootCacheLoad(frame, temp))
+    return;
+
+  currentTemp = temp;
+  displayStale = true;
+  displaySet(DISPLAY_LAYER_VALUE, frame & ~FRAME_BIT_CELSIUS);
+  displayLatch();
 }
 
-/// @brief Arduino main loop
+/// @brief Arduino main loop: one turn of every task, nothing blocks
 void loop()
 {
-  static unsigned long lastAnimate = 0;
-  static int animate_idx = 0;
-  static bool isThermometerError = false;
-  static bool firstRun = true;
-  static unsigned int retryCount = 4;
-  static bool wasWifiConnected = false;
-  server.handleClient();
+  unsigned long loopStart = halMicros();
+  bootProfileLoop();
+  TRACE_SCOPE(TRACE_LOOP);
+  playbackPoll(); // first: its deadlines are the only ones here finer than a few ms
+  serialPoll();
 
-  WifiCheck();
+  {
+    TRACE_SCOPE(TRACE_HANDLE_CLIENT);
+    webPoll();
+  }
 
-  bool isWifiConnected = (WiFi.status() == WL_CONNECTED);
-  if (!wasWifiConnected && isWifiConnected)
   {
-    firstRun = true; // on reconnect, read temp immediately
-    animateStartLCD();
+    TRACE_SCOPE(TRACE_WIFI);
+    wifiTask(&wifiPt);
+    wifiBlinkTask(&blinkPt);
   }
-  wasWifiConnected = isWifiConnected;
 
-  if (!isWifiConnected)
-    return;
+  mqttTask(&mqttPt);
+  pushPoll();
+  mdnsCacheTask(&mdnsPt); // before sensor task: first poll after connect gets a fresh address
+  sensorTask(&sensorPt);
+  animatorTask(&animPt);
+  displayCmdPoll();
+  displayTask(&displayPt);
+  historyTask(&historyPt);
+  ingestLatencyCheck();
+  eventsPoll();
+
+  unsigned long loopUs = halMicros() - loopStart;
+  if (loopUs > mainMetrics.loopMaxUs)
+    mainMetrics.loopMaxUs = loopUs;
+}
 
-  if (every5Minuts() || firstRun)
+/// @brief Serial input: binary protocol frames (serial_proto.h), one-letter commands between them
+void serialPoll()
+{
+  uint8_t buf[64];
+  size_t n;
+  while ((n = halSerialReadBytes(buf, sizeof(buf))) > 0)
   {
-    firstRun = false;
-    float t = 0;
-    t = getOutdoorTemperature("http://temperatura_na_balkonie.local/json");
+    size_t text = serialProtoFeed(buf, n);
+    for (size_t i = 0; i < text; i++)
+      serialCommand(buf[i]);
+  }
+}
 
-    if (validateTemp(t))
-      isThermometerError = false;
-    else
+/// @brief Serial commands: 't' / 'r' trace report / reset, 'b' task switch benchmark, 'j' JSON reader benchmark,
+/// 'w' root page benchmark (benchmarks only where their *_BENCH_ENABLED flag is set)
+void serialCommand(int c)
+{
+#if TRACE_ENABLED
+  if (traceSerialCommand(c))
+    return;
+#endif
+#if PT_BENCH_ENABLED
+  if (c == 'b')
+  {
+    char buf[256];
+    ptBenchmark(buf, sizeof(buf));
+    halSerialWrite(buf);
+  }
+#endif
+#if TEMP_JSON_BENCH_ENABLED
+  if (c == 'j')
+  {
+    char buf[512];
+    tempJsonBenchmark(buf, sizeof(buf));
+    halSerialWrite(buf);
+  }
+#endif
+#if WEB_ROOT_BENCH_ENABLED
+  if (c == 'w')
+  {
+    char buf[512];
+    webRootBenchmark(buf, sizeof(buf));
+    halSerialWrite(buf);
+  }
+#endif
+}
+
+static uint8_t *putLe16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static uint8_t *putLe32(uint8_t *p, uint32_t v)
+{
+  p = putLe16(p, (uint16_t)v);
+  return putLe16(p, (uint16_t)(v >> 16));
+}
+
+/// @brief Serial protocol commands (serial_proto.h): set value / symbol / frame on the value layer,
+/// stream records into the playback ring, stats
+void serial_handleCommand(uint8_t type, const uint8_t *body, size_t len)
+{
+  uint8_t reply[40];
+  uint8_t *p = reply;
+  uint16_t frame;
+  switch (type)
+  {
+  case SERIAL_SET_VALUE:
+  {
+    int v = len == 1 ? (int8_t)body[0] : 100;
+    if (v < -99 || v > 99)
     {
-      t = getOutdoorTemperature("http://192.168.1.35/json");
-      if (validateTemp(t))
-        isThermometerError = false;
-      else
-        isThermometerError = true;
+      serialProtoReply(SERIAL_BAD, nullptr, 0);
+      return;
     }
-
-    if (!isThermometerError)
+    currentTemp = v;
+    frame = frameForNumber(v);
+    break;
+  }
+  case SERIAL_SET_SYMBOL:
+  {
+    char symbol[8];
+    if (len >= sizeof(symbol))
+    {
+      serialProtoReply(SERIAL_BAD, nullptr, 0);
+      return;
+    }
+    memcpy(symbol, body, len);
+    symbol[len] = '\0';
+    if (!frameForSymbol(symbol, frame))
+    {
+      serialProtoReply(SERIAL_BAD, nullptr, 0);
+      return;
+    }
+    break;
+  }
+  case SERIAL_SET_FRAME:
+    if (len != 2)
     {
-      currentTemp = t;
-      animate_idx = 0;
-      retryCount = 0;
-      setOutdoorDisplay(currentTemp);
+      serialProtoReply(SERIAL_BAD, nullptr, 0);
+      return;
     }
+    frame = (uint16_t)(body[0] | body[1] << 8);
+    break;
+  case SERIAL_STREAM:
+  {
+    PlaybackResult r = len >= 1 ? playbackQueue(body + 1, len - 1, body[0] & 1) : PLAYBACK_BAD;
+    PlaybackInfo info;
+    playbackInfo(info);
+    p = putLe16(p, (uint16_t)info.queued);
+    p = putLe16(p, (uint16_t)info.free);
+    serialProtoReply(r == PLAYBACK_OK ? SERIAL_OK : (r == PLAYBACK_FULL ? SERIAL_FULL : SERIAL_BAD), reply,
+                     p - reply);
+    return;
+  }
+  case SERIAL_STATS:
+  {
+    PlaybackInfo info;
+    playbackInfo(info);
+    const SerialProtoStats &st = serialProtoStats();
+    p = putLe32(p, halMillis());
+    p = putLe16(p, displayFrame());
+    p = putLe16(p, (uint16_t)(int16_t)(currentTemp * 10.0f + (currentTemp < 0 ? -0.5f : 0.5f)));
+    *p++ = halWifiStatus() == HAL_WIFI_CONNECTED;
+    p = putLe16(p, (uint16_t)info.queued);
+    p = putLe32(p, info.shown);
+    p = putLe32(p, info.skipped);
+    p = putLe32(p, st.frames);
+    p = putLe32(p, st.crcErrors);
+    p = putLe32(p, st.overruns);
+    p = putLe32(p, st.timeouts);
+    serialProtoReply(SERIAL_OK, reply, p - reply);
+    return;
+  }
+  default:
+    serialProtoReply(SERIAL_UNKNOWN, nullptr, 0);
+    return;
+  }
+
+  // the set commands: the wire is one trusted client, no web command queue or rate limit
+  displaySet(DISPLAY_LAYER_VALUE, frame);
+  putLe16(p, frame);
+  serialProtoReply(SERIAL_OK, reply, 2);
+}
+
+/// @brief Take pushed readings from the UDP port and the MQTT subscription
+void pushPoll()
+{
+  IngestReading r;
+  while (ingestUdpRead(r))
+  {
+    if (sourceReading(sourceFind(SOURCE_UDP, r.sensor), r.deci, 0))
+      ingestApplied(INGEST_UDP, applyFused());
     else
-      retryCount++;
-    every5Minuts(true); // reset timer
+      ingestReject(INGEST_UDP);
   }
 
-  // animate only if device error
-  if (isThermometerError && everySecond() && retryCount > 3)
+  int32_t deci;
+  if (mqttReading(deci))
   {
-    setOutdoorDisplay_animate(animate_idx);
-    animate_idx = (animate_idx + 1) % 12;
+    if (sourceReading(sourceFind(SOURCE_MQTT, 0), deci, 0))
+      ingestApplied(INGEST_MQTT, applyFused());
+    else
+      ingestReject(INGEST_MQTT);
   }
 }
 
-inline bool validateTemp(float t)
+/// @brief New valid temperature (polled or pushed): value layer, boot cache, poll timer
+/// @return Frame set on the value layer
+uint16_t applyReading(int32_t deci)
 {
-  return t >= -60.0f && t <= 99.0f;
+  currentTemp = deci / 10.0f;
+  pollSchedReading(deci);
+  sensor.error = false;
+  sensor.lastPoll = halMillis(); // reset poll timer
+  uint16_t frame = frameForNumber(currentTemp);
+  displaySet(DISPLAY_LAYER_VALUE, frame);
+  displayClear(DISPLAY_LAYER_SENSOR_ERROR);
+  displayStale = false;
+  bootCacheStore(frame, currentTemp);
+  wifiFastTimingFirstTemp();
+  eventsReading(deci);
+  return frame;
 }
 
-/// @brief  Send 16 bits to display: two digits + minus + celsius
-/// @param digit1   First digit segments array (7 bools)
-/// @param digit2   Second digit segments array (7 bools)
-/// @param minus    Minus sign segment (bool)
-/// @param celsius  Celsius sign segment (bool)
-void sendBitsArray(const bool *digit1, const bool *digit2, bool minus, bool celsius)
+/// @brief Show the value fused from all fresh sources
+/// @return Frame set on the value layer, frame on the panel if no source is fresh
+uint16_t applyFused()
 {
-  // ensure latch idle low before starting
-  setPinLow(PIN_LATCH);
-  delayMicroseconds(4);
+  int32_t deci;
+  if (!sourceFuse(deci))
+    return displayFrame();
+  return applyReading(deci);
+}
 
-  for (int i = 0; i < 7; ++i)
+/// @brief Leave out polled sources whose circuit breaker is open (sources.h)
+static void pollSelect(const char *urls[SENSOR_SOURCE_COUNT])
+{
+  for (int i = 0; i < SENSOR_SOURCE_COUNT; i++)
   {
-    setDataBit(digit1[i]);
-    // small setup time before clock
-    delayMicroseconds(1);
-    pulseClock();
+    if (urls[i][0] && !sourcePollDue(sourceFind(SOURCE_HTTP, i)))
+      urls[i] = "";
   }
+}
 
-  for (int i = 0; i < 7; ++i)
+static bool wifiLinkUp()
+{
+  return halWifiStatus() == HAL_WIFI_CONNECTED;
+}
+
+/// @brief WiFi manager: tracks link state, reconnects every WIFI_RECONNECT_INTERVAL while down
+int wifiTask(Pt *pt)
+{
+  // targeted connect timed out -> full scan
+  wifiFastCheck(halMillis());
+
+  PT_BEGIN(pt);
+  for (;;)
   {
-    setDataBit(digit2[i]);
-    // small setup time before clock
-    delayMicroseconds(1);
-    pulseClock();
+    PT_WAIT_UNTIL(pt, wifiLinkUp() || halMillis() - wifi.lastReconnectAttempt >= WIFI_RECONNECT_INTERVAL);
+
+    if (wifiLinkUp())
+    {
+      wifi.connected = true;
+      mainMetrics.wifiConnects++;
+      if (wifi.wasUp)
+      {
+        unsigned long down = halMillis() - wifi.downSince;
+        mainMetrics.wifiDownMs += down;
+        if (down > mainMetrics.wifiDownMaxMs)
+          mainMetrics.wifiDownMaxMs = down;
+      }
+      wifi.wasUp = true;
+      sensor.pollNow = true; // on reconnect, read temp immediately
+      wifiFastStore();
+      wifiFastTimingConnected();
+      if (!displayStale) // keep cached value on panel until first fetch
+        anim.startRequest = true;
+
+      PT_WAIT_UNTIL(pt, !wifiLinkUp());
+      wifi.connected = false;
+      wifi.downSince = halMillis();
+      continue;
+    }
+
+    // reconnect sequence, owns the status layer until done
+    wifi.lastReconnectAttempt = halMillis();
+    mainMetrics.wifiReconnects++;
+    wifiFastTimingStart("reconnect");
+    halWifiOff();
+    anim.startRequest = true;
+    PT_WAIT_UNTIL(pt, !anim.startRequest);
+
+    uint16_t frame;
+    frameForSymbol("NULL", frame);
+    displaySet(DISPLAY_LAYER_STATUS, frame);
+    PT_SLEEP(pt, 1500);
+    wifiFastBegin();
+    PT_SLEEP(pt, 500);
+
+    if (!wifiLinkUp())
+    {
+      switch (halWifiStatus())
+      {
+      case HAL_WIFI_NO_SSID:
+        frameForSymbol("01", frame);
+        break;
+      case HAL_WIFI_CONNECT_FAILED:
+        frameForSymbol("02", frame);
+        break;
+      case HAL_WIFI_CONNECTION_LOST:
+        frameForSymbol("03", frame);
+        break;
+      case HAL_WIFI_DISCONNECTED:
+        frameForSymbol("04", frame);
+        break;
+      case HAL_WIFI_IDLE:
+        frameForSymbol("05", frame);
+        break;
+      default:
+        frameForSymbol("99", frame);
+        break;
+      }
+      displaySet(DISPLAY_LAYER_STATUS, frame);
+      PT_SLEEP(pt, 2000);
+    }
+    displayClear(DISPLAY_LAYER_STATUS);
   }
-  setDataBit(minus);
-  delayMicroseconds(1);
-  pulseClock();
+  PT_END(pt);
+}
 
-  setDataBit(celsius);
-  delayMicroseconds(1);
-  pulseClock();
+static bool wifiBlinkWanted()
+{
+  // keep cached value on panel during initial connect after boot
+  bool keepStale = displayStale && halMillis() < WIFI_RECONNECT_INTERVAL;
+  return !wifiLinkUp() && !keepStale;
+}
 
-  // after bits sent, pulse latch to update display
-  pulseLatch();
+/// @brief Blink "--" / "NULL" while WiFi is down
+int wifiBlinkTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
+  {
+    PT_WAIT_UNTIL(pt, wifiBlinkWanted());
 
-  // release data line
-  setPinHigh(PIN_DATA);
+    uint16_t frame;
+    wifi.blinkOn = !wifi.blinkOn;
+    frameForSymbol(wifi.blinkOn ? "--" : "NULL", frame);
+    displaySet(DISPLAY_LAYER_WIFI, frame);
+
+    pt->t0 = halMillis();
+    PT_WAIT_UNTIL(pt, !wifiBlinkWanted() || halMillis() - pt->t0 >= WIFI_ANIM_INTERVAL);
+    if (!wifiBlinkWanted())
+      displayClear(DISPLAY_LAYER_WIFI);
+  }
+  PT_END(pt);
 }
 
-/// @brief  Set display to integer number (-99..99)
-/// @param num   Integer number to display
-void setOutdoorDisplay(int num)
+/// @brief Sensor poller: reads thermometer at the adaptive interval (poll_sched.h) and on (re)connect
+int sensorTask(Pt *pt)
 {
-  bool minus = false;
-  if (num < 0)
+  PT_BEGIN(pt);
+  for (;;)
   {
-    minus = true;
-    num = -num;
+    PT_WAIT_UNTIL(pt, wifi.connected && (sensor.pollNow || halMillis() - sensor.lastPoll >= pollSchedInterval() ||
+                                         sourceProbeDue()));
+    sensor.pollNow = false;
+
+    // first answer of the resolver after boot, a learned address is used right away
+    PT_WAIT_UNTIL(pt, mdnsCacheAddress(sensor.ip) || !mdnsCacheResolving());
+
+    // primary address comes from the resolver cache, learned address while the responder is silent
+    {
+      sensor.primaryUrl[0] = '\0';
+      if (mdnsCacheAddress(sensor.ip))
+        fetchUrlForIp(sensor.ip, sensor.primaryUrl, sizeof(sensor.primaryUrl));
+      const char *urls[SENSOR_SOURCE_COUNT] = {sensor.primaryUrl, SENSOR_FALLBACK_URL};
+      pollSelect(urls);
+      fetchStart(urls);
+    }
+    PT_WAIT_UNTIL(pt, fetchPoll(sensor.temp, sensor.source));
+
+    if (sensor.source != SENSOR_PRIMARY)
+      mdnsCacheRefresh(); // primary thermometer may have moved to another address
+
+    // thermometer error only once no source (polled or pushed) has a fresh value
+    {
+      int32_t deci;
+      sensor.error = !sourceFuse(deci);
+      if (!sensor.error)
+        applyReading(deci);
+    }
+
+    pollSchedPolled();
+    if (sourceRecovered())
+      pollSchedRecovered(); // watch the comeback closely
+    sensor.lastPoll = halMillis(); // reset timer
   }
-  int digit1 = num / 10;
-  int digit2 = num % 10;
+  PT_END(pt);
+}
 
-  if (digit1 == 0)
-    digit1 = 10; // NULL for leading zero
+/// @brief History: the displayed value every HISTORY_SAMPLE_INTERVAL while one is fresh, NVS flush
+int historyTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
+  {
+    PT_SLEEP(pt, HISTORY_SAMPLE_INTERVAL);
+    {
+      int32_t deci;
+      if (!sourceFuse(deci))
+        continue; // a gap in the history
+      historyAdd(deci);
+    }
+    if (HISTORY_FLUSH_SAMPLES && ++historyUnflushed >= HISTORY_FLUSH_SAMPLES)
+    {
+      historyFlush();
+      historyUnflushed = 0;
+    }
+  }
+  PT_END(pt);
+}
 
-  if (minus && num > 0 && num < 10)
+/// @brief Animator: start animation on request, error animation while thermometer fails
+int animatorTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
   {
-    minus = false;
-    digit1 = DISPLAY_SIGN_MINUS_IDX; // show minus on first digit if only one digit negative
+    // animate only if device error and every polled thermometer's breaker is open
+    PT_WAIT_UNTIL(pt, anim.startRequest || (sensor.error && sourceBreakersOpen() &&
+                                            halMillis() - anim.lastErrorFrame >= 1000));
+
+    if (anim.startRequest)
+    {
+      for (anim.idx = 0; anim.idx < DISPLAY_ANIM_FRAMES; anim.idx++)
+      {
+        displaySet(DISPLAY_LAYER_ANIM, frameForAnimation(anim.idx));
+        PT_SLEEP(pt, 100);
+      }
+      displayClear(DISPLAY_LAYER_ANIM);
+      anim.startRequest = false;
+      anim.errorIdx = 0;
+      continue;
+    }
+
+    anim.lastErrorFrame = halMillis();
+    displaySet(DISPLAY_LAYER_SENSOR_ERROR, frameForAnimation(anim.errorIdx));
+    anim.errorIdx = (anim.errorIdx + 1) % DISPLAY_ANIM_FRAMES;
   }
-  sendBitsArray(DIGIT_1[digit1], DIGIT_2[digit2], minus, true);
+  PT_END(pt);
+}
+
+/// @brief Handle root (/) request: static page from flash, gzipped, temperature spliced in (web_root.h)
+void server_handleRoot()
+{
+  webRootSend(currentTemp);
 }
 
-/// @brief  Set display to NULL (all segments off)
-/// @param data  String data ( "NULL" , "--" )
-void setOutdoorDisplay(const String &data)
+/// @brief Handle /set request to set temperature (for test), through the command queue (display_cmd.h)
+void server_handleSet()
 {
-  // send NULL display
-  if (data == "NULL")
+  char arg[16];
+  if (!webArg("temp", arg, sizeof(arg)))
   {
-    sendBitsArray(DIGIT_1[DISPLAY_NULL_IDX], DIGIT_2[DISPLAY_NULL_IDX], false, true);
+    webSend(400, "text/plain", "Missing temp");
     return;
   }
-  // send -- display
-  if (data == "--")
+
+  int temp = atoi(arg);
+
+  if (temp < -99 || temp > 99)
   {
-    sendBitsArray(DIGIT_1[DISPLAY_SIGN_MINUS_IDX], DIGIT_2[DISPLAY_SIGN_MINUS_IDX], false, true);
+    webSend(400, "text/plain", "Out of range");
     return;
   }
 
-  if (data == "01")
+  if (!displayCmdPost(webClient(), frameForNumber(temp)))
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[1], false, false);
+    webSendHeader("Retry-After", "1");
+    webSend(429, "text/plain", "Too many requests");
     return;
   }
+  currentTemp = temp;
+
+  webSendHeader("Location", "/");
+  webSend(302, nullptr, nullptr);
+}
+
+/// @brief JSON error response {"error": message}
+static void apiError(int code, const char *message)
+{
+  char buf[128];
+  ApiJson w;
+  apiJsonBegin(w, buf, sizeof(buf));
+  apiJsonString(w, "error", message);
+  apiJsonFinish(w);
+  webSend(code, "application/json", buf);
+}
 
-  if (data == "02")
+/// @brief Handle GET /api/state: displayed value, panel frame, uptime and source health as JSON
+void server_handleApiState()
+{
+  if (webMethod() != WEB_GET)
+  {
+    webSendHeader("Allow", "GET");
+    apiError(405, "GET only");
+    return;
+  }
+
+  char buf[1024];
+  ApiJson w;
+  apiJsonBegin(w, buf, sizeof(buf));
+  apiJsonDeci(w, "temp", (int32_t)(currentTemp * 10.0f + (currentTemp < 0 ? -0.5f : 0.5f)));
+  apiJsonBool(w, "stale", displayStale);
+  int32_t fused;
+  if (sourceFuse(fused))
+    apiJsonDeci(w, "fused", fused);
+  else
+    apiJsonNull(w, "fused");
+  apiJsonString(w, "policy", sourcePolicyName(sourceGetPolicy()));
+  apiJsonUint(w, "frame", displayFrame());
+  apiJsonUint(w, "uptime_s", halMillis() / 1000);
+  apiJsonBool(w, "wifi", halWifiStatus() == HAL_WIFI_CONNECTED);
+  apiJsonArray(w, "sources");
+  SourceInfo info;
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    if (!sourceInfo(i, info))
+      continue;
+    apiJsonObject(w, nullptr);
+    apiJsonString(w, "name", info.name);
+    apiJsonUint(w, "health", info.health);
+    apiJsonUint(w, "rate", info.ratePct);
+    apiJsonUint(w, "latency_ms", info.latencyMs);
+    if (info.ageS >= 0)
+    {
+      apiJsonInt(w, "age_s", info.ageS);
+      apiJsonDeci(w, "value", info.deci);
+    }
+    else
+    {
+      apiJsonNull(w, "age_s");
+      apiJsonNull(w, "value");
+    }
+    apiJsonUint(w, "readings", info.readings);
+    apiJsonUint(w, "failures", info.failures);
+    if (info.polled)
+      apiJsonString(w, "breaker", sourceBreakerName(info.breaker));
+    apiJsonEnd(w);
+  }
+  apiJsonEnd(w);
+  if (apiJsonFinish(w) == 0)
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[2], false, false);
+    apiError(500, "state too large");
     return;
   }
+  webSend(200, "application/json", buf);
+}
 
-  if (data == "03")
+/// @brief Handle PUT /api/display: {"value":-12} | {"symbol":"--"} | {"frame":49152} (raw frame word)
+/// Sets the value layer like /set, until the next reading replaces it; answers {"frame":N}, 429 over the rate limit
+void server_handleApiDisplay()
+{
+  if (webMethod() != WEB_PUT)
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[3], false, false);
+    webSendHeader("Allow", "PUT");
+    apiError(405, "PUT only");
     return;
   }
 
-  if (data == "04")
+  char body[128];
+  char arg[16];
+  bool isString = false;
+  char *end;
+  uint16_t frame;
+  long value = 0;
+  bool isValue = false;
+  if (!webBody(body, sizeof(body)))
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[4], false, false);
+    apiError(400, "JSON body required");
     return;
   }
-  if (data == "05")
+  if (apiJsonMember(body, "value", arg, sizeof(arg), isString) && !isString)
+  {
+    long v = strtol(arg, &end, 10);
+    if (*end || v < -99 || v > 99)
+    {
+      apiError(400, "value: integer -99..99");
+      return;
+    }
+    value = v;
+    isValue = true;
+    frame = frameForNumber(v);
+  }
+  else if (apiJsonMember(body, "symbol", arg, sizeof(arg), isString) && isString)
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[5], false, false);
+    if (!frameForSymbol(arg, frame))
+    {
+      apiError(400, "symbol: NULL, --, 01..06 or 99");
+      return;
+    }
+  }
+  else if (apiJsonMember(body, "frame", arg, sizeof(arg), isString) && !isString)
+  {
+    unsigned long f = strtoul(arg, &end, 10);
+    if (*end || arg[0] == '-' || f > 0xFFFF)
+    {
+      apiError(400, "frame: integer 0..65535");
+      return;
+    }
+    frame = (uint16_t)f;
+  }
+  else
+  {
+    apiError(400, "value, symbol or frame required");
     return;
   }
 
-  if (data == "06")
+  if (!displayCmdPost(webClient(), frame))
   {
-    sendBitsArray(DIGIT_1[0], DIGIT_2[6], false, false);
+    webSendHeader("Retry-After", "1");
+    apiError(429, "too many requests");
     return;
   }
+  if (isValue)
+    currentTemp = value;
+  char buf[32];
+  ApiJson w;
+  apiJsonBegin(w, buf, sizeof(buf));
+  apiJsonUint(w, "frame", frame);
+  apiJsonFinish(w);
+  webSend(200, "application/json", buf);
+}
 
-  if (data == "99")
+/// @brief Handle /api/play: GET playback state, POST binary {frame, duration} records (playback.h)
+/// ?replace=1 drops what is queued first, an empty body with it stops playback
+void server_handleApiPlay()
+{
+  WebMethod method = webMethod();
+  if (method != WEB_GET && method != WEB_POST)
   {
-    sendBitsArray(DIGIT_1[9], DIGIT_2[9], false, false);
+    webSendHeader("Allow", "GET, POST");
+    apiError(405, "GET or POST only");
     return;
   }
+  if (method == WEB_POST)
+  {
+    char replace[4] = "";
+    webArg("replace", replace, sizeof(replace));
+    size_t len;
+    const uint8_t *data = webBodyData(len);
+    switch (playbackQueue(data, len, strcmp(replace, "1") == 0))
+    {
+    case PLAYBACK_BAD:
+      apiError(400, "body: 4 byte records, frame and duration 1..65535 ms, little-endian");
+      return;
+    case PLAYBACK_FULL:
+      webSendHeader("Retry-After", "1");
+      apiError(503, "queue full");
+      return;
+    case PLAYBACK_OK:
+      break;
+    }
+  }
 
+  PlaybackInfo info;
+  playbackInfo(info);
+  char buf[256];
+  ApiJson w;
+  apiJsonBegin(w, buf, sizeof(buf));
+  apiJsonBool(w, "playing", info.playing);
+  apiJsonInt(w, "queued", info.queued);
+  apiJsonInt(w, "free", info.free);
+  apiJsonUint(w, "runs", info.runs);
+  apiJsonUint(w, "shown", info.shown);
+  apiJsonUint(w, "skipped", info.skipped);
+  apiJsonUint(w, "refused", info.refused);
+  apiJsonUint(w, "late_avg_us", info.lateAvgUs);
+  apiJsonUint(w, "late_max_us", info.lateMaxUs);
+  apiJsonDeci(w, "fps", (int32_t)(info.fpsMilli / 100));
+  apiJsonFinish(w);
+  webSend(200, "application/json", buf);
 }
 
-/// @brief  Animate display with index
-/// @param idx  Index of animation frame (0..12)
-void setOutdoorDisplay_animate(int idx)
+/// @brief Handle /boot request: boot-phase profile
+void server_handleBoot()
 {
-  sendBitsArray(DIGIT_1[idx + 12], DIGIT_2[idx + 12], false, false);
+  char buf[512];
+  bootProfileReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
 }
 
-/// @brief Handle root (/) request
-void server_handleRoot()
+/// @brief Handle /fetch request: per-source fetch latency, new vs reused connection, poll interval
+/// ?mode=sequential|race|hedged switches fetch mode
+void server_handleFetch()
 {
-  String html =
-      "<!DOCTYPE html><html><head>"
-      "<meta charset='utf-8'>"
-      "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
-      "<title>Outdoor Temp</title>"
-
-      "<style>"
-      "body{font-family:Arial,sans-serif;background:#f2f2f2;margin:0;padding:0;}"
-      ".card{max-width:360px;margin:40px auto;background:#fff;"
-      "padding:20px;border-radius:12px;box-shadow:0 4px 10px rgba(0,0,0,.1);}"
-      "h2{text-align:center;margin-top:0;}"
-      ".temp{font-size:48px;text-align:center;margin:20px 0;}"
-      "form{display:flex;flex-direction:column;gap:15px;}"
-      "input[type=number]{font-size:20px;padding:12px;border-radius:8px;border:1px solid #ccc;}"
-      "input[type=submit]{font-size:20px;padding:12px;border-radius:8px;"
-      "border:none;background:#007bff;color:white;cursor:pointer;}"
-      "input[type=submit]:active{background:#0056b3;}"
-      "</style>"
-
-      "</head><body>"
-
-      "<div class='card'>"
-      "<h2>Outdoor Temperature</h2>"
-      "<div class='temp'>" +
-      String(currentTemp) + " &deg;C</div>"
-
-                            "<form action='/set'>"
-                            "<input type='number' name='temp' min='-99' max='99' placeholder='Enter temperature' required>"
-                            "<input type='submit' value='Set temperature'>"
-                            "</form>"
-                            "</div>"
-
-                            "</body></html>";
+  char arg[16];
+  FetchMode m;
+  if (webArg("mode", arg, sizeof(arg)))
+  {
+    if (!fetchModeFromName(arg, m))
+    {
+      webSend(400, "text/plain", "Invalid mode");
+      return;
+    }
+    fetchSetMode(m);
+  }
 
-  server.send(200, "text/html", html);
+  char buf[640];
+  size_t n = fetchStatsReport(buf, sizeof(buf));
+  pollSchedReport(buf + n, sizeof(buf) - n);
+  webSend(200, "text/plain", buf);
 }
 
-/// @brief Handle /set request to set temperature (for test)
-void server_handleSet()
+/// @brief Handle POST /api/reading: pushed thermometer payload {"temperature":12.3,...}
+void server_handleReading()
 {
-  if (!server.hasArg("temp"))
+  if (webMethod() != WEB_POST)
   {
-    server.send(400, "text/plain", "Missing temp");
+    webSend(405, "text/plain", "POST only");
     return;
   }
 
-  int temp = server.arg("temp").toInt();
-
-  if (temp < -99 || temp > 99)
+  char body[256];
+  TempJsonParser p;
+  tempJsonInit(p);
+  if (webBody(body, sizeof(body)))
+    tempJsonFeed(p, body, strlen(body));
+  if (tempJsonFinish(p) != TEMP_JSON_FOUND)
   {
-    server.send(400, "text/plain", "Out of range");
+    ingestReject(INGEST_HTTP);
+    webSend(400, "text/plain", "Invalid reading");
     return;
   }
 
-  currentTemp = temp;
-  setOutdoorDisplay(currentTemp);
-
-  server.sendHeader("Location", "/");
-  server.send(302);
+  if (!sourceReading(sourceFind(SOURCE_POST, 0), p.deci, 0))
+  {
+    ingestReject(INGEST_HTTP);
+    webSend(400, "text/plain", "Out of range");
+    return;
+  }
+  ingestApplied(INGEST_HTTP, applyFused());
+  webSend(204, nullptr, nullptr);
 }
 
-/// @brief Set a pin to LOW (drive line low)
-/// @param pin  Pin number
-inline void setPinLow(int pin)
-{
-  pinMode(pin, OUTPUT);
-  digitalWrite(pin, LOW);
-}
-/// @brief Set a pin to high-Z (pull-up will pull line HIGH)
-/// @param pin  Pin number
-inline void setPinHigh(int pin)
+/// @brief Handle /ingest request: pushed readings and push -> latch latency
+void server_handleIngest()
 {
-  pinMode(pin, INPUT); // high-Z, pull-up will pull line HIGH
+  char buf[256];
+  ingestReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
 }
 
-/// @brief Set data line according to logical bit and BIT_ON_HIGH polarity
-/// @param bit  Logical bit to send (0/1)
-inline void setDataBit(uint8_t bit)
+/// @brief Handle /sources request: source health and fusion (?policy=best|median|weighted)
+void server_handleSources()
 {
-  bool wantHigh = (bit != 0) ? true : false;
-  if (wantHigh)
-    setPinHigh(PIN_DATA);
-  else
-    setPinLow(PIN_DATA);
-}
+  char arg[16];
+  FusionPolicy p;
+  if (webArg("policy", arg, sizeof(arg)))
+  {
+    if (!sourcePolicyFromName(arg, p))
+    {
+      webSend(400, "text/plain", "Invalid policy");
+      return;
+    }
+    sourceSetPolicy(p);
+  }
 
-/// @brief  Pulse clock line (LOW->HIGH->LOW)
-inline void pulseClock()
-{
-  const unsigned int T_HALF_US = 5; // half clock period in microseconds (5 -> ~100 kHz)
-  setPinHigh(PIN_CLOCK);
-  delayMicroseconds(T_HALF_US);
-  setPinLow(PIN_CLOCK);
-  delayMicroseconds(T_HALF_US);
+  char buf[1024];
+  sourceReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
 }
 
-/// @brief  Pulse latch line to update display
-void pulseLatch()
+/// @brief Position of one /api/history response, copied into the connection
+struct HistoryStream
 {
-  // ensure latch idle = LOW
-  setPinHigh(PIN_LATCH);
-  delayMicroseconds(2);
+  HistoryCursor cursor;
+  int block;   // bin: next block
+  bool header; // csv: column line sent
+};
 
-  // release -> goes HIGH (via pull-up)
-  setPinLow(PIN_LATCH);
-  delayMicroseconds(8); // hold HIGH briefly to latch
-  // drive low again to return to idle
-  setPinHigh(PIN_LATCH);
-  delayMicroseconds(4);
-  // release to leave in high-Z (optional)
-  setPinLow(PIN_LATCH);
-}
-
-// initialize pins to safe released state
-void initPins()
+/// @brief Fill callback for ?format=bin: whole blocks while they fit
+int historyFillBin(void *ctx, uint8_t *buf, size_t len)
 {
-  setPinHigh(PIN_CLOCK);
-  setPinHigh(PIN_DATA);
-  setPinHigh(PIN_LATCH);
+  HistoryStream &h = *(HistoryStream *)ctx;
+  if (buf == nullptr)
+    return -1;
+  size_t n = 0;
+  for (; h.block < HISTORY_BLOCKS && len - n >= HISTORY_BLOCK_HEADER + HISTORY_BLOCK_BYTES; h.block++)
+    n += historyBlock(h.block, buf + n, len - n);
+  return n ? (int)n : (h.block < HISTORY_BLOCKS ? 0 : -1);
 }
 
-/// @brief Get outdoor temperature from HTTP server
-/// @return Temperature in Celsius or negative error code <= -100
-float getOutdoorTemperature(const String &url)
+/// @brief Fill callback for ?format=csv: whole lines while they fit
+int historyFillCsv(void *ctx, uint8_t *buf, size_t len)
 {
-  if (WiFi.status() != WL_CONNECTED)
+  HistoryStream &h = *(HistoryStream *)ctx;
+  if (buf == nullptr)
+    return -1;
+  char *out = (char *)buf;
+  size_t n = 0;
+  if (len <= 48)
+    return 0; // not even a line fits, wait for more room
+  if (!h.header)
   {
-    return -102.0f; // error: no WiFi
+    n += snprintf(out, len, "t_s,temp_c\n");
+    h.header = true;
   }
-
-  HTTPClient http;
-  http.begin(url);
-  int httpCode = http.GET();
-
-  if (httpCode != 200)
+  HistorySample s;
+  while (len - n > 48 && historyNext(h.cursor, s))
   {
-    http.end();
-    return -101.0f; // error: HTTP fail
+    if (s.boot)
+      n += snprintf(out + n, len - n, "# boot, unknown gap\n");
+    long v = s.deci < 0 ? -s.deci : s.deci;
+    n += snprintf(out + n, len - n, "%lu,%s%ld.%ld\n", (unsigned long)s.t, s.deci < 0 ? "-" : "", v / 10, v % 10);
   }
-
-  String payload = http.getString();
-  http.end();
-
-  int tPos = payload.indexOf("\"temperature\":");
-  if (tPos < 0)
-    return -101.0f; // error: no temperature field
-
-  int valueStart = tPos + strlen("\"temperature\":");
-  int valueEnd = payload.indexOf(",", valueStart);
-  if (valueEnd == -1)
-    valueEnd = payload.indexOf("}", valueStart);
-
-  String tempStr = payload.substring(valueStart, valueEnd);
-  return tempStr.toFloat();
+  return n ? (int)n : -1;
 }
 
-bool every5Minuts(bool reset)
+/// @brief Handle /api/history request: stored readings streamed oldest first
+/// ?format=csv (default, t_s,temp_c) or bin (raw blocks, see history.h)
+void server_handleHistory()
 {
-  static unsigned long lastMillis = 0;
-  unsigned long now = millis();
-  if (reset)
-  {
-    lastMillis = now;
-    return false;
-  }
-
-  if (now - lastMillis >= 300000UL) // 5 minuts
-  {
-    lastMillis = now;
-    return true;
-  }
-  return false;
+  char format[8] = "csv";
+  webArg("format", format, sizeof(format));
+  HistoryStream h;
+  memset(&h, 0, sizeof(h));
+  h.cursor = historyCursor();
+  if (strcmp(format, "bin") == 0)
+    webSendStream(200, "application/octet-stream", historyFillBin, &h, sizeof(h));
+  else if (strcmp(format, "csv") == 0)
+    webSendStream(200, "text/csv", historyFillCsv, &h, sizeof(h));
+  else
+    webSend(400, "text/plain", "format: csv or bin");
 }
 
-bool everySecond()
+/// @brief Handle /api/events request: Server-Sent Events of latched frames and readings (events.h)
+void server_handleEvents()
 {
-  static unsigned long lastMillis = 0;
-  unsigned long now = millis();
-
-  if (now - lastMillis >= 1000UL)
+  EventsSub sub;
+  if (!eventsSubscribe(sub))
   {
-    lastMillis = now;
-    return true;
+    webSendHeader("Retry-After", "30");
+    webSend(503, "text/plain", "Too many subscribers");
+    return;
   }
-  return false;
+  webSendHeader("Cache-Control", "no-cache");
+  webSendStream(200, "text/event-stream", eventsFill, &sub, sizeof(sub));
 }
 
-void WifiCheck()
+/// @brief Handle /metrics request: Prometheus text format (metrics.h)
+void server_handleMetrics()
 {
-  static unsigned long lastWifiCheck = 0;
-  static unsigned long lastReconnectAttempt = 0;
-  static unsigned long lastAnimToggle = 0;
-  static bool animState = false;
-
-  const unsigned long WIFI_CHECK_INTERVAL = 2000;
-  const unsigned long WIFI_RECONNECT_INTERVAL = 15000;
-  const unsigned long WIFI_ANIM_INTERVAL = 500;
-
-  unsigned long now = millis();
-
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    if (now - lastAnimToggle >= WIFI_ANIM_INTERVAL)
-    {
-      lastAnimToggle = now;
-      animState = !animState;
+  MetricsCursor cursor;
+  memset(&cursor, 0, sizeof(cursor));
+  webSendStream(200, "text/plain; version=0.0.4", metricsFill, &cursor, sizeof(cursor));
+}
 
-      if (animState)
-        setOutdoorDisplay("--");
-      else
-        setOutdoorDisplay("NULL");
-    }
-  }
+/// @brief Handle /web request: server connections and service time, event subscribers, display command queue
+void server_handleWeb()
+{
+  char buf[1024];
+  size_t n = webReport(buf, sizeof(buf));
+  n += eventsReport(buf + n, sizeof(buf) - n);
+  displayCmdReport(buf + n, sizeof(buf) - n);
+  webSend(200, "text/plain", buf);
+}
 
-  if (now - lastWifiCheck < WIFI_CHECK_INTERVAL)
-    return;
+/// @brief Handle /mqtt request: subscription state
+void server_handleMqtt()
+{
+  char buf[256];
+  mqttReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
+}
 
-  lastWifiCheck = now;
+/// @brief Handle /mdns request: resolver cache state
+void server_handleMdns()
+{
+  char buf[160];
+  mdnsCacheReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
+}
 
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    if (now - lastReconnectAttempt >= WIFI_RECONNECT_INTERVAL)
-    {
-      lastReconnectAttempt = now;
-
-      WiFi.disconnect(true, true);
-      WiFi.mode(WIFI_OFF);
-      animateStartLCD();
-      setOutdoorDisplay("NULL");
-      delay(1500);
-      WiFi.mode(WIFI_STA);
-      WiFi.begin(SSID, PASSWORD);
-      delay(500);
-      wl_status_t st = WiFi.status();
-      if (st != WL_CONNECTED)
-      {
-        switch (st)
-        {
-        case WL_NO_SSID_AVAIL:
-          setOutdoorDisplay("01");
-          break;
-        case WL_CONNECT_FAILED:
-          setOutdoorDisplay("02");
-          break;
-        case WL_CONNECTION_LOST:
-          setOutdoorDisplay("03");
-          break;
-        case WL_DISCONNECTED:
-          setOutdoorDisplay("04");
-          break;
-        case WL_IDLE_STATUS:
-          setOutdoorDisplay("05");
-          break;
-        default:
-          setOutdoorDisplay("99");
-          break;
-        }
-        delay(2000);
-      }
-    }
-  }
-}
\ No newline at end of file
+#if TRACE_ENABLED
+/// @brief Handle /trace request: latency histograms (?reset=1 clears them)
+void server_handleTrace()
+{
+  char buf[1536];
+  traceReport(buf, sizeof(buf));
+  webSend(200, "text/plain", buf);
+  if (webHasArg("reset"))
+    traceReset();
+}
+#endif
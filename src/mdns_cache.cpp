@@ -0,0 +1,124 @@
+// mDNS resolver cache, see mdns_cache.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "mdns_cache.h"
+
+struct MdnsCacheState
+{
+  const char *host;
+  uint32_t ip; // 0 = never resolved
+  uint32_t ttl;
+  bool ttlAssumed; // resolver gave no TTL, ttl is MDNS_ASSUMED_TTL
+  bool resolved; // resolved since boot, resolvedAt is valid
+  unsigned long resolvedAt;
+  unsigned long lastQuery;
+  unsigned long nextQueryIn; // ms after lastQuery
+  bool refreshNow;
+  unsigned long queries;
+  unsigned long failures;
+  // query in flight
+  bool resolving;
+  HalMdnsState result;
+  uint32_t answerIp;
+  uint32_t answerTtl;
+};
+
+static MdnsCacheState mdns = {"", 0, 0, false, false, 0, 0, 0, true, 0, 0, false, HAL_MDNS_PENDING, 0, 0};
+
+void mdnsCacheInit(const char *host)
+{
+  mdns.host = host;
+  uint32_t ip;
+  if (halStoreRead("mdnscache", "addr", &ip, sizeof(ip)) && ip != 0)
+    mdns.ip = ip;
+}
+
+static bool mdnsQueryDue()
+{
+  return halWifiStatus() == HAL_WIFI_CONNECTED &&
+         (mdns.refreshNow || halMillis() - mdns.lastQuery >= mdns.nextQueryIn);
+}
+
+/// @brief Take answer of finished query
+static void mdnsQueryDone()
+{
+  uint32_t ip = mdns.answerIp;
+  uint32_t ttl = mdns.answerTtl;
+  mdns.lastQuery = halMillis();
+
+  if (mdns.result != HAL_MDNS_OK)
+  {
+    mdns.failures++;
+    mdns.nextQueryIn = MDNS_RETRY_INTERVAL; // keep learned address meanwhile
+    return;
+  }
+
+  mdns.ttlAssumed = ttl == 0;
+  if (ttl == 0)
+    ttl = MDNS_ASSUMED_TTL;
+  mdns.resolved = true;
+  mdns.resolvedAt = mdns.lastQuery;
+  mdns.ttl = ttl;
+  mdns.nextQueryIn = ttl * 10UL * MDNS_REFRESH_PERCENT; // ttl * 1000 * percent / 100
+
+  // write NVS only on change to save flash wear
+  if (ip == mdns.ip)
+    return;
+  halLog("[mdns] %s -> %u.%u.%u.%u\n", mdns.host, (unsigned)(ip & 0xff), (unsigned)((ip >> 8) & 0xff),
+         (unsigned)((ip >> 16) & 0xff), (unsigned)(ip >> 24));
+  mdns.ip = ip;
+  halStoreWrite("mdnscache", "addr", &ip, sizeof(ip));
+}
+
+int mdnsCacheTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
+  {
+    PT_WAIT_UNTIL(pt, mdnsQueryDue());
+    mdns.queries++;
+    mdns.refreshNow = false;
+    mdns.resolving = true;
+    mdns.result = halMdnsStart(mdns.host, MDNS_QUERY_TIMEOUT) ? HAL_MDNS_PENDING : HAL_MDNS_FAILED;
+    PT_WAIT_UNTIL(pt, mdns.result != HAL_MDNS_PENDING ||
+                          (mdns.result = halMdnsPoll(mdns.answerIp, mdns.answerTtl)) != HAL_MDNS_PENDING);
+    mdns.resolving = false;
+    mdnsQueryDone();
+  }
+  PT_END(pt);
+}
+
+bool mdnsCacheAddress(uint32_t &ip)
+{
+  ip = mdns.ip;
+  return ip != 0;
+}
+
+bool mdnsCacheFresh()
+{
+  return mdns.resolved && halMillis() - mdns.resolvedAt < mdns.ttl * 1000UL;
+}
+
+bool mdnsCacheResolving()
+{
+  return mdns.resolving;
+}
+
+void mdnsCacheRefresh()
+{
+  mdns.refreshNow = true;
+}
+
+size_t mdnsCacheReport(char *buf, size_t len)
+{
+  uint32_t ip = mdns.ip;
+  unsigned long age = mdns.resolved ? (halMillis() - mdns.resolvedAt) / 1000 : 0;
+  int n = snprintf(buf, len, "%s %u.%u.%u.%u %s ttl %lu s%s age %lu s, queries %lu (failed %lu)\n", mdns.host,
+                   (unsigned)(ip & 0xff), (unsigned)((ip >> 8) & 0xff), (unsigned)((ip >> 16) & 0xff),
+                   (unsigned)(ip >> 24), mdnsCacheFresh() ? "fresh" : (ip ? "learned" : "unresolved"),
+                   (unsigned long)mdns.ttl, mdns.ttlAssumed ? " (assumed)" : "", age, mdns.queries, mdns.failures);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
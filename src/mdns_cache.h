@@ -0,0 +1,48 @@
+// mDNS resolver cache for the thermometer host name
+// Resolves in the background (halMdnsStart), before the record's TTL (or MDNS_ASSUMED_TTL) runs
+// out, so fetches go straight to an IP address. The last resolved address is kept in NVS and is the fallback while the responder is silent.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "pt.h"
+
+// max time one query waits for the responder
+const unsigned long MDNS_QUERY_TIMEOUT = 1000;
+// re-query after this share of the TTL (RFC 6762 refreshes at 80 %)
+const unsigned int MDNS_REFRESH_PERCENT = 80;
+// retry interval after a failed query
+const unsigned long MDNS_RETRY_INTERVAL = 30000;
+
+// TTL in seconds used when the resolver does not report the record's (Arduino MDNS.queryHost()
+// does not). A guess, not the responder's value: RFC 6762 recommends 120 s for host records, many
+// responders send 4500 s. A thermometer that moved is found sooner anyway, the fetch falls back
+// and asks again (mdnsCacheRefresh), so the guess can be long: a query every 16 min at 1200.
+#ifndef MDNS_ASSUMED_TTL
+#define MDNS_ASSUMED_TTL 1200
+#endif
+
+/// @brief Set host name and load learned address from NVS
+void mdnsCacheInit(const char *host);
+
+/// @brief Resolver task: refreshes the address while WiFi is connected
+int mdnsCacheTask(Pt *pt);
+
+/// @brief Last resolved address (may be expired)
+/// @return false if the name was never resolved
+bool mdnsCacheAddress(uint32_t &ip);
+
+/// @brief Address was resolved within its TTL
+bool mdnsCacheFresh();
+
+/// @brief Query is in flight
+bool mdnsCacheResolving();
+
+/// @brief Query again on next task turn (e.g. fetch from cached address failed)
+void mdnsCacheRefresh();
+
+/// @brief Write cache state as text
+/// @return Number of chars written
+size_t mdnsCacheReport(char *buf, size_t len);
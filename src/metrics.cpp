@@ -0,0 +1,287 @@
+// Prometheus metrics registry, see metrics.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "display.h"
+#include "display_cmd.h"
+#include "fetch.h"
+#include "sources.h"
+#include "serial_proto.h"
+#include "metrics.h"
+
+// longest HELP + TYPE + sample lines of one series
+const size_t METRIC_TEXT_MAX = 256;
+
+enum MetricType
+{
+  METRIC_COUNTER,
+  METRIC_GAUGE
+};
+
+struct MetricSample
+{
+  uint64_t value;
+  char labels[32]; // e.g. source="primary", empty = none
+};
+
+/// @brief Value of series i
+/// @return false if there is no such series (unused slot, platform does not report it)
+typedef bool (*MetricRead)(int i, MetricSample &s);
+
+struct MetricDef
+{
+  const char *name;
+  const char *help;
+  MetricType type;
+  uint32_t scale; // value units per exported unit: 1, 1000 (ms -> s) or 1000000 (us -> s)
+  int series;
+  MetricRead read;
+};
+
+MainMetrics mainMetrics = {};
+
+static bool readUptime(int, MetricSample &s)
+{
+  s.value = halMillis();
+  return true;
+}
+
+static bool readLoopMax(int, MetricSample &s)
+{
+  s.value = mainMetrics.loopMaxUs;
+  return true;
+}
+
+/// @brief Heap figure i: 0 free, 1 minimum free, 2 largest block
+static bool readHeap(int i, MetricSample &s)
+{
+  size_t freeBytes, largest, minFree;
+  if (!halHeapStats(freeBytes, largest, minFree))
+    return false;
+  s.value = i == 0 ? freeBytes : (i == 1 ? minFree : largest);
+  return true;
+}
+
+static bool readHeapFree(int, MetricSample &s)
+{
+  return readHeap(0, s);
+}
+
+static bool readHeapMinFree(int, MetricSample &s)
+{
+  return readHeap(1, s);
+}
+
+static bool readHeapLargest(int, MetricSample &s)
+{
+  return readHeap(2, s);
+}
+
+static bool readFramesSent(int, MetricSample &s)
+{
+  s.value = displayStats().sent;
+  return true;
+}
+
+static bool readFramesSuppressed(int, MetricSample &s)
+{
+  s.value = displayStats().suppressed;
+  return true;
+}
+
+static bool readBusTime(int, MetricSample &s)
+{
+  s.value = displayStats().busUs;
+  return true;
+}
+
+static bool readBusMax(int, MetricSample &s)
+{
+  s.value = displayStats().busMaxUs;
+  return true;
+}
+
+/// @brief Web display commands by outcome: 0 applied, 1 coalesced, 2 rate limited
+static bool readDisplayCommands(int i, MetricSample &s)
+{
+  static const char *const RESULTS[] = {"applied", "coalesced", "limited"};
+  const DisplayCmdStats &c = displayCmdStats();
+  s.value = i == 0 ? c.applied : (i == 1 ? c.coalesced : c.limited);
+  snprintf(s.labels, sizeof(s.labels), "result=\"%s\"", RESULTS[i]);
+  return true;
+}
+
+/// @brief Serial protocol frames by outcome: 0 ok, 1 CRC error, 2 overrun, 3 timeout
+static bool readSerialFrames(int i, MetricSample &s)
+{
+  static const char *const RESULTS[] = {"ok", "crc", "overrun", "timeout"};
+  const SerialProtoStats &c = serialProtoStats();
+  s.value = i == 0 ? c.frames : (i == 1 ? c.crcErrors : (i == 2 ? c.overruns : c.timeouts));
+  snprintf(s.labels, sizeof(s.labels), "result=\"%s\"", RESULTS[i]);
+  return true;
+}
+
+/// @brief Fetch counters of source i with its label
+static FetchCounters fetchSeries(int i, MetricSample &s)
+{
+  FetchCounters c;
+  fetchCounters(i, c);
+  snprintf(s.labels, sizeof(s.labels), "source=\"%s\"", c.name);
+  return c;
+}
+
+static bool readFetchRequests(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).requests;
+  return true;
+}
+
+static bool readFetchFailures(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).failures;
+  return true;
+}
+
+static bool readFetchCancelled(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).cancelled;
+  return true;
+}
+
+static bool readFetchResponses(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).responses;
+  return true;
+}
+
+static bool readFetchLatency(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).latencyUs;
+  return true;
+}
+
+static bool readFetchLatencyMax(int i, MetricSample &s)
+{
+  s.value = fetchSeries(i, s).maxUs;
+  return true;
+}
+
+static bool readSourceHealth(int i, MetricSample &s)
+{
+  SourceInfo info;
+  if (!sourceInfo(i, info))
+    return false;
+  snprintf(s.labels, sizeof(s.labels), "source=\"%s\"", info.name);
+  s.value = info.health;
+  return true;
+}
+
+static bool readWifiReconnects(int, MetricSample &s)
+{
+  s.value = mainMetrics.wifiReconnects;
+  return true;
+}
+
+static bool readWifiConnects(int, MetricSample &s)
+{
+  s.value = mainMetrics.wifiConnects;
+  return true;
+}
+
+static bool readWifiDown(int, MetricSample &s)
+{
+  s.value = mainMetrics.wifiDownMs;
+  return true;
+}
+
+static bool readWifiDownMax(int, MetricSample &s)
+{
+  s.value = mainMetrics.wifiDownMaxMs;
+  return true;
+}
+
+static const MetricDef METRICS[] = {
+    {"outdoor_uptime_seconds", "Time since boot", METRIC_GAUGE, 1000, 1, readUptime},
+    {"outdoor_loop_stall_max_seconds", "Longest main loop turn", METRIC_GAUGE, 1000000, 1, readLoopMax},
+    {"outdoor_heap_free_bytes", "Free heap", METRIC_GAUGE, 1, 1, readHeapFree},
+    {"outdoor_heap_min_free_bytes", "Lowest free heap since boot", METRIC_GAUGE, 1, 1, readHeapMinFree},
+    {"outdoor_heap_largest_free_block_bytes", "Largest allocatable heap block", METRIC_GAUGE, 1, 1, readHeapLargest},
+    {"outdoor_frames_sent_total", "Frames written to the display bus", METRIC_COUNTER, 1, 1, readFramesSent},
+    {"outdoor_frames_suppressed_total", "Layer updates that left the panel frame unchanged", METRIC_COUNTER, 1, 1,
+     readFramesSuppressed},
+    {"outdoor_bus_seconds_total", "Time spent writing frames to the bus", METRIC_COUNTER, 1000000, 1, readBusTime},
+    {"outdoor_bus_max_seconds", "Longest frame write", METRIC_GAUGE, 1000000, 1, readBusMax},
+    {"outdoor_display_commands_total", "Display commands from web requests", METRIC_COUNTER, 1, 3,
+     readDisplayCommands},
+    {"outdoor_serial_frames_total", "Serial protocol frames received", METRIC_COUNTER, 1, 4, readSerialFrames},
+    {"outdoor_fetch_requests_total", "Thermometer requests started", METRIC_COUNTER, 1, SENSOR_SOURCE_COUNT,
+     readFetchRequests},
+    {"outdoor_fetch_failures_total", "Thermometer requests failed", METRIC_COUNTER, 1, SENSOR_SOURCE_COUNT,
+     readFetchFailures},
+    {"outdoor_fetch_cancelled_total", "Thermometer requests cancelled (another source won)", METRIC_COUNTER, 1,
+     SENSOR_SOURCE_COUNT, readFetchCancelled},
+    {"outdoor_fetch_responses_total", "Thermometer responses received", METRIC_COUNTER, 1, SENSOR_SOURCE_COUNT,
+     readFetchResponses},
+    {"outdoor_fetch_latency_seconds_total", "Summed latency of the responses", METRIC_COUNTER, 1000000,
+     SENSOR_SOURCE_COUNT, readFetchLatency},
+    {"outdoor_fetch_latency_max_seconds", "Longest request", METRIC_GAUGE, 1000000, SENSOR_SOURCE_COUNT,
+     readFetchLatencyMax},
+    {"outdoor_source_health", "Source health score 0..100", METRIC_GAUGE, 1, SOURCE_MAX, readSourceHealth},
+    {"outdoor_wifi_reconnects_total", "WiFi reconnect sequences started", METRIC_COUNTER, 1, 1, readWifiReconnects},
+    {"outdoor_wifi_connects_total", "WiFi link came up", METRIC_COUNTER, 1, 1, readWifiConnects},
+    {"outdoor_wifi_down_seconds_total", "WiFi link down time, completed outages", METRIC_COUNTER, 1000, 1,
+     readWifiDown},
+    {"outdoor_wifi_down_max_seconds", "Longest completed WiFi outage", METRIC_GAUGE, 1000, 1, readWifiDownMax},
+};
+
+const int METRIC_COUNT = sizeof(METRICS) / sizeof(METRICS[0]);
+
+/// @brief Value in exported units, fixed point without 64-bit printf (scale 1, 1000 or 1000000)
+static int formatValue(char *buf, size_t len, uint64_t value, uint32_t scale)
+{
+  unsigned long whole = (unsigned long)(value / scale);
+  unsigned long frac = (unsigned long)(value % scale);
+  if (scale == 1000)
+    return snprintf(buf, len, "%lu.%03lu", whole, frac);
+  if (scale == 1000000)
+    return snprintf(buf, len, "%lu.%06lu", whole, frac);
+  return snprintf(buf, len, "%lu", whole);
+}
+
+int metricsFill(void *ctx, uint8_t *buf, size_t len)
+{
+  MetricsCursor &c = *(MetricsCursor *)ctx;
+  if (buf == nullptr)
+    return -1;
+  char *out = (char *)buf;
+  size_t n = 0;
+  for (; c.family < METRIC_COUNT; c.family++, c.series = 0, c.headed = false)
+  {
+    const MetricDef &m = METRICS[c.family];
+    for (; c.series < m.series; c.series++)
+    {
+      if (len - n < METRIC_TEXT_MAX)
+        return (int)n;
+      MetricSample s;
+      s.labels[0] = '\0';
+      if (!m.read(c.series, s))
+        continue;
+      if (!c.headed)
+      {
+        // HELP and TYPE only for families with at least one series
+        c.headed = true;
+        n += snprintf(out + n, len - n, "# HELP %s %s\n# TYPE %s %s\n", m.name, m.help, m.name,
+                      m.type == METRIC_COUNTER ? "counter" : "gauge");
+      }
+      char value[24];
+      formatValue(value, sizeof(value), s.value, m.scale);
+      if (s.labels[0])
+        n += snprintf(out + n, len - n, "%s{%s} %s\n", m.name, s.labels, value);
+      else
+        n += snprintf(out + n, len - n, "%s %s\n", m.name, value);
+    }
+  }
+  return n ? (int)n : -1;
+}
@@ -0,0 +1,34 @@
+// Prometheus text format metrics (/metrics) from a static registry
+// The registry is a const table of metric families (name, help, type, fixed point scale and a
+// reader for series i). Values come from the stats the modules keep anyway (display, fetch,
+// sources, heap) and from MainMetrics below, bumped in place by main.cpp. Hot paths only increment
+// plain fields; the table is walked only while /metrics is served, a few lines per fill of the
+// connection's transmit buffer, so the text is never assembled in one piece.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @brief Counters of the main loop and WiFi manager
+struct MainMetrics
+{
+  unsigned long loopMaxUs;      // longest loop() turn
+  unsigned long wifiReconnects; // reconnect sequences started
+  unsigned long wifiConnects;   // link came up
+  uint64_t wifiDownMs;          // completed outages (link lost -> up again)
+  unsigned long wifiDownMaxMs;  // longest completed outage
+};
+
+extern MainMetrics mainMetrics;
+
+/// @brief Position in the registry, start zeroed
+struct MetricsCursor
+{
+  int family;
+  int series;
+  bool headed; // HELP and TYPE of this family written
+};
+
+/// @brief WebFill for /metrics: whole families' lines while they fit, ctx is a MetricsCursor
+int metricsFill(void *ctx, uint8_t *buf, size_t len);
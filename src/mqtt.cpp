@@ -0,0 +1,448 @@
+// MQTT subscriber, see mqtt.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+#include "mqtt.h"
+#include "temp_json.h"
+
+// control packet types (high nibble of the fixed header)
+const uint8_t MQTT_CONNECT = 1;
+const uint8_t MQTT_CONNACK = 2;
+const uint8_t MQTT_PUBLISH = 3;
+const uint8_t MQTT_SUBSCRIBE = 8;
+const uint8_t MQTT_SUBACK = 9;
+const uint8_t MQTT_PINGREQ = 12;
+
+const uint16_t MQTT_SUBSCRIBE_ID = 1;
+const size_t MQTT_READ_CHUNK = 64;
+// bytes of a non-PUBLISH packet kept for inspection (CONNACK, SUBACK)
+const size_t MQTT_HEAD_LEN = 4;
+// a bare number payload is read as {"temperature":<payload>}
+static const char MQTT_BARE_PREFIX[] = "{\"temperature\":";
+
+enum MqttReadState
+{
+  MQTT_READ_TYPE,
+  MQTT_READ_LENGTH,
+  MQTT_READ_TOPIC_LEN,
+  MQTT_READ_TOPIC,
+  MQTT_READ_PACKET_ID,
+  MQTT_READ_PAYLOAD,
+  MQTT_READ_BODY // other packets
+};
+
+// incremental packet reader, fed with whatever the socket has
+struct MqttReader
+{
+  uint8_t state;
+  uint8_t header;
+  uint8_t lengthShift;
+  uint8_t count; // bytes of the current field
+  uint32_t remaining;
+  uint16_t topicLen;
+  bool topicMatch;
+  bool payloadStarted;
+  bool bare; // payload is a bare number
+  uint8_t head[MQTT_HEAD_LEN];
+  TempJsonParser json;
+};
+
+struct MqttState
+{
+  char host[64]; // empty = off
+  uint16_t port;
+  const char *topic;
+  const char *clientId;
+  // session
+  bool acked;      // CONNACK accepted
+  bool subscribed; // SUBACK granted
+  bool failed;     // protocol error or refused, close
+  unsigned long sessionStart;
+  unsigned long lastRx;
+  unsigned long lastTx;
+  // reconnect
+  unsigned long backoff;
+  unsigned long retryIn; // ms after disconnectedAt
+  unsigned long disconnectedAt;
+  // readings not yet taken by mqttReading()
+  bool hasReading;
+  int32_t deci;
+  // counters
+  unsigned long attempts;
+  unsigned long sessions;
+  unsigned long messages;
+  unsigned long retained;
+  unsigned long badPayloads;
+};
+
+static MqttState mqtt;
+static MqttReader reader;
+
+void mqttInit(const char *broker, const char *topic, const char *clientId)
+{
+  memset(&mqtt, 0, sizeof(mqtt));
+  size_t n = strcspn(broker, ":");
+  if (n >= sizeof(mqtt.host))
+    n = 0;
+  memcpy(mqtt.host, broker, n);
+  mqtt.host[n] = '\0';
+  mqtt.port = broker[n] == ':' ? (uint16_t)atoi(broker + n + 1) : MQTT_DEFAULT_PORT;
+  mqtt.topic = topic;
+  mqtt.clientId = clientId;
+  mqtt.backoff = MQTT_BACKOFF_MIN;
+}
+
+/// @brief Write "remaining length" field
+/// @return Bytes written
+static size_t putLength(uint8_t *p, size_t len)
+{
+  size_t n = 0;
+  do
+  {
+    uint8_t b = len & 0x7f;
+    len >>= 7;
+    p[n++] = len ? (uint8_t)(b | 0x80) : b;
+  } while (len);
+  return n;
+}
+
+static size_t putString(uint8_t *p, const char *s)
+{
+  size_t len = strlen(s);
+  p[0] = (uint8_t)(len >> 8);
+  p[1] = (uint8_t)(len & 0xff);
+  memcpy(p + 2, s, len);
+  return len + 2;
+}
+
+/// @brief Send packet with fixed header
+static bool mqttSend(uint8_t header, const uint8_t *body, size_t len)
+{
+  uint8_t packet[160];
+  size_t n = 0;
+  packet[n++] = header;
+  n += putLength(packet + n, len);
+  if (n + len > sizeof(packet))
+    return false;
+  if (len)
+    memcpy(packet + n, body, len);
+  if (!halTcpWrite(packet, n + len))
+    return false;
+  mqtt.lastTx = halMillis();
+  return true;
+}
+
+static bool mqttSendConnect()
+{
+  uint8_t body[48];
+  size_t n = putString(body, "MQTT");
+  body[n++] = 4;    // protocol level 3.1.1
+  body[n++] = 0x02; // clean session, no will, no credentials
+  body[n++] = (uint8_t)(MQTT_KEEPALIVE >> 8);
+  body[n++] = (uint8_t)(MQTT_KEEPALIVE & 0xff);
+  if (strlen(mqtt.clientId) > 23)
+    return false;
+  n += putString(body + n, mqtt.clientId);
+  return mqttSend(MQTT_CONNECT << 4, body, n);
+}
+
+static bool mqttSendSubscribe()
+{
+  uint8_t body[128];
+  if (strlen(mqtt.topic) + 5 > sizeof(body))
+    return false;
+  size_t n = 0;
+  body[n++] = (uint8_t)(MQTT_SUBSCRIBE_ID >> 8);
+  body[n++] = (uint8_t)(MQTT_SUBSCRIBE_ID & 0xff);
+  n += putString(body + n, mqtt.topic);
+  body[n++] = 0; // QoS 0
+  return mqttSend((MQTT_SUBSCRIBE << 4) | 0x02, body, n);
+}
+
+static void readerStartPacket()
+{
+  reader.state = MQTT_READ_TYPE;
+  reader.count = 0;
+}
+
+/// @brief Whole packet read
+static void mqttPacketDone()
+{
+  uint8_t type = reader.header >> 4;
+  if (type == MQTT_PUBLISH && reader.topicMatch)
+  {
+    if (reader.bare)
+      tempJsonFeed(reader.json, "}", 1);
+    if (reader.payloadStarted && tempJsonFinish(reader.json) == TEMP_JSON_FOUND)
+    {
+      mqtt.messages++;
+      if (reader.header & 0x01)
+        mqtt.retained++;
+      mqtt.hasReading = true;
+      mqtt.deci = reader.json.deci;
+    }
+    else if (reader.payloadStarted)
+      mqtt.badPayloads++; // empty payload only clears a retained message
+  }
+  else if (type == MQTT_CONNACK)
+  {
+    if (reader.count < 2 || reader.head[1] != 0)
+    {
+      halLog("[mqtt] connection refused (%u)\n", reader.count < 2 ? 255u : reader.head[1]);
+      mqtt.failed = true;
+    }
+    else
+    {
+      mqtt.acked = true;
+      mqtt.failed = !mqttSendSubscribe();
+    }
+  }
+  else if (type == MQTT_SUBACK)
+  {
+    if (reader.count < 3 || reader.head[2] == 0x80)
+    {
+      halLog("[mqtt] subscription to %s refused\n", mqtt.topic);
+      mqtt.failed = true;
+    }
+    else
+    {
+      mqtt.subscribed = true;
+      mqtt.backoff = MQTT_BACKOFF_MIN;
+      mqtt.sessions++;
+      halLog("[mqtt] subscribed to %s on %s\n", mqtt.topic, mqtt.host);
+    }
+  }
+  readerStartPacket();
+}
+
+/// @brief Fixed header read, decide how to read the rest
+static void mqttPacketStart()
+{
+  uint8_t type = reader.header >> 4;
+  reader.count = 0;
+  if (type == MQTT_PUBLISH)
+  {
+    reader.state = MQTT_READ_TOPIC_LEN;
+    reader.topicLen = 0;
+    reader.topicMatch = true;
+    reader.payloadStarted = false;
+    reader.bare = false;
+    tempJsonInit(reader.json);
+  }
+  else
+    reader.state = MQTT_READ_BODY;
+  if (reader.remaining == 0)
+    mqttPacketDone();
+}
+
+/// @brief Payload bytes straight from the socket buffer into the temperature reader
+static void mqttPayload(const char *data, size_t len)
+{
+  if (!reader.payloadStarted)
+  {
+    reader.payloadStarted = true;
+    reader.bare = data[0] != '{';
+    if (reader.bare)
+      tempJsonFeed(reader.json, MQTT_BARE_PREFIX, sizeof(MQTT_BARE_PREFIX) - 1);
+  }
+  tempJsonFeed(reader.json, data, len);
+}
+
+/// @brief Feed received bytes, calls mqttPacketDone() per packet
+static void mqttFeed(const uint8_t *data, size_t len)
+{
+  size_t i = 0;
+  while (i < len && !mqtt.failed)
+  {
+    uint8_t b = data[i];
+    switch (reader.state)
+    {
+    case MQTT_READ_TYPE:
+      reader.header = b;
+      reader.remaining = 0;
+      reader.lengthShift = 0;
+      reader.state = MQTT_READ_LENGTH;
+      i++;
+      break;
+
+    case MQTT_READ_LENGTH:
+      reader.remaining |= (uint32_t)(b & 0x7f) << reader.lengthShift;
+      reader.lengthShift += 7;
+      i++;
+      if (b & 0x80)
+      {
+        if (reader.lengthShift > 21)
+          mqtt.failed = true; // more than 4 length bytes
+      }
+      else
+        mqttPacketStart();
+      break;
+
+    case MQTT_READ_TOPIC_LEN:
+      reader.topicLen = (uint16_t)((reader.topicLen << 8) | b);
+      reader.remaining--;
+      i++;
+      if (++reader.count < 2)
+        break;
+      reader.count = 0;
+      if (reader.topicLen != strlen(mqtt.topic))
+        reader.topicMatch = false;
+      reader.state = reader.topicLen ? MQTT_READ_TOPIC : (reader.header & 0x06) ? MQTT_READ_PACKET_ID : MQTT_READ_PAYLOAD;
+      if (reader.topicLen > reader.remaining)
+        mqtt.failed = true;
+      else if (reader.remaining == 0)
+        mqttPacketDone();
+      break;
+
+    case MQTT_READ_TOPIC:
+      // compared against the subscription as it goes, never stored
+      if (reader.topicMatch && mqtt.topic[reader.count] != (char)b)
+        reader.topicMatch = false;
+      reader.remaining--;
+      i++;
+      if (++reader.count < reader.topicLen)
+        break;
+      reader.count = 0;
+      reader.state = (reader.header & 0x06) ? MQTT_READ_PACKET_ID : MQTT_READ_PAYLOAD;
+      if (reader.remaining == 0)
+        mqttPacketDone();
+      break;
+
+    case MQTT_READ_PACKET_ID:
+      // only with QoS > 0, which the subscription never grants; skipped for robustness
+      reader.remaining--;
+      i++;
+      if (++reader.count < 2)
+        break;
+      reader.state = MQTT_READ_PAYLOAD;
+      if (reader.remaining == 0)
+        mqttPacketDone();
+      break;
+
+    case MQTT_READ_PAYLOAD:
+    case MQTT_READ_BODY:
+    {
+      size_t n = len - i < reader.remaining ? len - i : reader.remaining;
+      if (reader.state == MQTT_READ_PAYLOAD)
+      {
+        if (reader.topicMatch)
+          mqttPayload((const char *)data + i, n);
+      }
+      else
+      {
+        for (size_t k = 0; k < n && reader.count < MQTT_HEAD_LEN; k++)
+          reader.head[reader.count++] = data[i + k];
+      }
+      reader.remaining -= n;
+      i += n;
+      if (reader.remaining == 0)
+        mqttPacketDone();
+      break;
+    }
+    }
+  }
+}
+
+static bool mqttConnectDue()
+{
+  return mqtt.host[0] && halWifiStatus() == HAL_WIFI_CONNECTED && halMillis() - mqtt.disconnectedAt >= mqtt.retryIn;
+}
+
+/// @brief Start a session on the fresh connection
+static void mqttSessionStart()
+{
+  mqtt.acked = false;
+  mqtt.subscribed = false;
+  mqtt.sessionStart = halMillis();
+  mqtt.lastRx = mqtt.sessionStart;
+  readerStartPacket();
+  mqtt.failed = !mqttSendConnect();
+}
+
+/// @brief One turn of an open session: read, keep alive, check deadlines
+/// @return false when the session is over
+static bool mqttSessionTurn()
+{
+  uint8_t buf[MQTT_READ_CHUNK];
+  size_t n;
+  // bounded, so a flood cannot starve the other tasks
+  for (int i = 0; i < 4 && !mqtt.failed && (n = halTcpRead(buf, sizeof(buf))) > 0; i++)
+  {
+    mqtt.lastRx = halMillis();
+    mqttFeed(buf, n);
+  }
+  if (mqtt.failed || halTcpState() != HAL_TCP_CONNECTED)
+    return false;
+
+  unsigned long now = halMillis();
+  if (!mqtt.subscribed)
+    return now - mqtt.sessionStart < MQTT_CONNECT_TIMEOUT;
+  if (now - mqtt.lastRx > MQTT_KEEPALIVE * 1500UL)
+  {
+    halLog("[mqtt] broker silent for %lu s\n", (now - mqtt.lastRx) / 1000);
+    return false;
+  }
+  if (now - mqtt.lastTx >= MQTT_KEEPALIVE * 1000UL)
+    return mqttSend(MQTT_PINGREQ << 4, nullptr, 0);
+  return true;
+}
+
+/// @brief Schedule reconnect: jittered exponential backoff
+static void mqttSessionEnd()
+{
+  halTcpClose();
+  mqtt.disconnectedAt = halMillis();
+  // up to +25 % so displays do not reconnect in lockstep after a broker restart
+  mqtt.retryIn = mqtt.backoff + halMicros() % (mqtt.backoff / 4 + 1);
+  mqtt.backoff = mqtt.backoff * 2 < MQTT_BACKOFF_MAX ? mqtt.backoff * 2 : MQTT_BACKOFF_MAX;
+}
+
+int mqttTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  for (;;)
+  {
+    PT_WAIT_UNTIL(pt, mqttConnectDue());
+    mqtt.attempts++;
+    if (!halTcpConnect(mqtt.host, mqtt.port, MQTT_CONNECT_TIMEOUT))
+    {
+      mqttSessionEnd();
+      continue;
+    }
+    PT_WAIT_UNTIL(pt, halTcpState() != HAL_TCP_CONNECTING);
+    if (halTcpState() == HAL_TCP_CONNECTED)
+    {
+      mqttSessionStart();
+      while (mqttSessionTurn())
+        PT_YIELD(pt);
+    }
+    mqttSessionEnd();
+  }
+  PT_END(pt);
+}
+
+bool mqttReading(int32_t &deci)
+{
+  if (!mqtt.hasReading)
+    return false;
+  mqtt.hasReading = false;
+  deci = mqtt.deci;
+  return true;
+}
+
+size_t mqttReport(char *buf, size_t len)
+{
+  if (!mqtt.host[0])
+    return snprintf(buf, len, "mqtt off\n");
+  int n = snprintf(buf, len,
+                   "broker %s:%u topic %s: %s\n"
+                   "attempts %lu, sessions %lu, next backoff %lu ms\n"
+                   "messages %lu (retained %lu), bad payloads %lu\n",
+                   mqtt.host, mqtt.port, mqtt.topic,
+                   mqtt.subscribed && halTcpState() == HAL_TCP_CONNECTED ? "subscribed" : "disconnected", mqtt.attempts,
+                   mqtt.sessions, mqtt.backoff, mqtt.messages, mqtt.retained, mqtt.badPayloads);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
@@ -0,0 +1,39 @@
+// MQTT subscriber: temperature readings published by sensors to a broker
+// Minimal MQTT 3.1.1 client over the HAL TCP stream: clean session, one QoS 0 subscription (the
+// broker's retained message gives a value right after connect), keep-alive pings and reconnect with
+// jittered exponential backoff. Packets are parsed byte by byte as they come off the socket and the
+// payload goes straight into the streaming temperature reader, nothing is buffered.
+// Payload: bare number ("12.3") or JSON object with a "temperature" member.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "pt.h"
+
+const uint16_t MQTT_DEFAULT_PORT = 1883;
+// TCP connect, then again for CONNACK
+const unsigned long MQTT_CONNECT_TIMEOUT = 3000;
+// PINGREQ after this long without sending, connection is dead after 1.5 times as long without input
+const uint16_t MQTT_KEEPALIVE = 60; // s
+// reconnect delay, doubles per failed attempt, back to minimum once subscribed
+const unsigned long MQTT_BACKOFF_MIN = 1000;
+const unsigned long MQTT_BACKOFF_MAX = 300000;
+
+/// @brief Set broker and topic
+/// @param broker    "host[:port]", empty = MQTT off
+/// @param clientId  Up to 23 chars
+void mqttInit(const char *broker, const char *topic, const char *clientId);
+
+/// @brief Client task: keeps the subscription up while WiFi is connected
+int mqttTask(Pt *pt);
+
+/// @brief Take next received reading
+/// @param deci  Output: temperature in deci-degrees
+/// @return false if none
+bool mqttReading(int32_t &deci);
+
+/// @brief Write connection state and counters as text
+/// @return Number of chars written
+size_t mqttReport(char *buf, size_t len);
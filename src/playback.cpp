@@ -0,0 +1,168 @@
+// Remote frame playback, see playback.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "display.h"
+#include "playback.h"
+
+// latch lateness buckets, upper bounds in us (last one open)
+static const unsigned long LATE_BOUNDS[] = {100, 500, 1000, 5000};
+const int LATE_BUCKETS = sizeof(LATE_BOUNDS) / sizeof(LATE_BOUNDS[0]) + 1;
+
+struct PlaybackRecord
+{
+  uint16_t frame;
+  uint16_t durationMs;
+};
+
+struct Playback
+{
+  PlaybackRecord ring[PLAYBACK_RING];
+  uint32_t head; // next to show
+  uint32_t tail; // next free
+  bool playing;  // layer owned, deadline valid
+  unsigned long deadlineUs;
+  unsigned long runStartUs;
+  unsigned long lastShownUs;
+  unsigned long runShown;
+  unsigned long runs;
+  unsigned long shown;
+  unsigned long skipped;
+  unsigned long refused;
+  uint64_t lateUs;
+  unsigned long lateMaxUs;
+  unsigned long late[LATE_BUCKETS];
+};
+
+static Playback pb = {};
+
+static int queued()
+{
+  return (int)(pb.tail - pb.head);
+}
+
+static void stop()
+{
+  pb.head = pb.tail;
+  if (pb.playing)
+    displayClear(DISPLAY_LAYER_PLAYBACK);
+  pb.playing = false;
+}
+
+PlaybackResult playbackQueue(const uint8_t *data, size_t len, bool replace)
+{
+  if (len % PLAYBACK_RECORD != 0)
+    return PLAYBACK_BAD;
+  int count = (int)(len / PLAYBACK_RECORD);
+  for (int i = 0; i < count; i++)
+  {
+    if ((data[i * PLAYBACK_RECORD + 2] | data[i * PLAYBACK_RECORD + 3]) == 0)
+      return PLAYBACK_BAD;
+  }
+  if (replace)
+    stop();
+  if (count > PLAYBACK_RING - queued())
+  {
+    pb.refused++;
+    return PLAYBACK_FULL;
+  }
+
+  for (int i = 0; i < count; i++, data += PLAYBACK_RECORD)
+  {
+    PlaybackRecord &r = pb.ring[pb.tail++ % PLAYBACK_RING];
+    r.frame = (uint16_t)(data[0] | data[1] << 8);
+    r.durationMs = (uint16_t)(data[2] | data[3] << 8);
+  }
+  return PLAYBACK_OK;
+}
+
+static void countLate(unsigned long lateUs)
+{
+  pb.lateUs += lateUs;
+  if (lateUs > pb.lateMaxUs)
+    pb.lateMaxUs = lateUs;
+  int b = 0;
+  while (b < LATE_BUCKETS - 1 && lateUs >= LATE_BOUNDS[b])
+    b++;
+  pb.late[b]++;
+}
+
+void playbackPoll()
+{
+  unsigned long now = halMicros();
+  if (!pb.playing)
+  {
+    if (queued() == 0)
+      return;
+    // a new run starts on its first record now
+    pb.playing = true;
+    pb.deadlineUs = now;
+    pb.runStartUs = now;
+    pb.lastShownUs = now;
+    pb.runShown = 0;
+    pb.runs++;
+  }
+  if ((long)(now - pb.deadlineUs) < 0)
+    return;
+
+  if (queued() == 0)
+  {
+    // last record's time is up
+    stop();
+    return;
+  }
+
+  // slots already over are skipped, the timeline stays where it was
+  PlaybackRecord r = pb.ring[pb.head++ % PLAYBACK_RING];
+  while (queued() > 0 && (long)(now - (pb.deadlineUs + r.durationMs * 1000UL)) >= 0)
+  {
+    pb.deadlineUs += r.durationMs * 1000UL;
+    pb.skipped++;
+    r = pb.ring[pb.head++ % PLAYBACK_RING];
+  }
+
+  countLate(now - pb.deadlineUs);
+  displaySet(DISPLAY_LAYER_PLAYBACK, r.frame);
+  displayLatch();
+  pb.deadlineUs += r.durationMs * 1000UL;
+  pb.lastShownUs = now;
+  pb.runShown++;
+  pb.shown++;
+}
+
+void playbackInfo(PlaybackInfo &info)
+{
+  info.playing = pb.playing;
+  info.queued = queued();
+  info.free = PLAYBACK_RING - queued();
+  info.runs = pb.runs;
+  info.shown = pb.shown;
+  info.skipped = pb.skipped;
+  info.refused = pb.refused;
+  info.lateAvgUs = pb.shown ? (unsigned long)(pb.lateUs / pb.shown) : 0;
+  info.lateMaxUs = pb.lateMaxUs;
+  unsigned long spanUs = pb.lastShownUs - pb.runStartUs;
+  info.fpsMilli = pb.runShown > 1 && spanUs ? (unsigned long)((uint64_t)(pb.runShown - 1) * 1000000000ULL / spanUs) : 0;
+}
+
+size_t playbackReport(char *buf, size_t len)
+{
+  PlaybackInfo info;
+  playbackInfo(info);
+  int n = snprintf(buf, len,
+                   "playback %s, %d queued, %lu runs, %lu shown, %lu skipped, %lu refused, last run %lu.%03lu fps\n"
+                   "latch late avg %lu us, max %lu us, [<us:count]",
+                   info.playing ? "playing" : "idle", info.queued, info.runs, info.shown, info.skipped, info.refused,
+                   info.fpsMilli / 1000, info.fpsMilli % 1000, info.lateAvgUs, info.lateMaxUs);
+  for (int b = 0; b < LATE_BUCKETS && n > 0 && (size_t)n < len; b++)
+  {
+    if (b < LATE_BUCKETS - 1)
+      n += snprintf(buf + n, len - n, " %lu:%lu", LATE_BOUNDS[b], pb.late[b]);
+    else
+      n += snprintf(buf + n, len - n, " more:%lu", pb.late[b]);
+  }
+  if (n > 0 && (size_t)n < len)
+    n += snprintf(buf + n, len - n, "\n");
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
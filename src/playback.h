@@ -0,0 +1,55 @@
+// Remote frame playback: binary {frame, duration} records uploaded over HTTP, played on the top layer
+// A record is 4 bytes, little-endian: the 16-bit frame word (bit order of display.h) and how long
+// it stays on the panel in ms (1..65535). POST /api/play appends a body of records to a ring of
+// PLAYBACK_RING; a body that does not fit is refused whole, the client retries when the ring has
+// drained (GET /api/play reports the free space). A body is one request buffer of the web server,
+// about 220 records; longer animations are streamed as consecutive POSTs.
+//
+// Records are shown against absolute deadlines: each starts when the previous one's duration has
+// passed since the previous deadline, not since it was shown, so late latches do not add up. A
+// record whose whole slot has already passed (a long loop turn) is skipped rather than shown late.
+// Lateness of every latch (deadline to bus write) is kept for the report. When the ring runs empty
+// the layer is released and the panel returns to whatever is below it.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const int PLAYBACK_RING = 512;
+const size_t PLAYBACK_RECORD = 4; // bytes on the wire
+
+enum PlaybackResult
+{
+  PLAYBACK_OK,
+  PLAYBACK_FULL, // does not fit the ring now
+  PLAYBACK_BAD   // not whole records, or a zero duration
+};
+
+/// @brief Append records (wire format) to the ring, all or none
+/// @param replace  Drop queued records and the current one first (an empty body just stops)
+PlaybackResult playbackQueue(const uint8_t *data, size_t len, bool replace);
+
+/// @brief Playback state and timing since boot
+struct PlaybackInfo
+{
+  bool playing;
+  int queued;              // records waiting
+  int free;                // records that still fit
+  unsigned long runs;      // started from an empty ring
+  unsigned long shown;     // records latched
+  unsigned long skipped;   // slot already over when their turn came
+  unsigned long refused;   // bodies that did not fit
+  unsigned long lateAvgUs; // deadline -> latch
+  unsigned long lateMaxUs;
+  unsigned long fpsMilli;  // frames per second x1000 of the last run (or the current one)
+};
+
+void playbackInfo(PlaybackInfo &info);
+
+/// @brief Show the next record when its deadline has come, call every loop
+void playbackPoll();
+
+/// @brief Write runs, frames shown / skipped, frame rate and latch lateness as text
+/// @return Number of chars written
+size_t playbackReport(char *buf, size_t len);
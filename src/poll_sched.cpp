@@ -0,0 +1,89 @@
+// Adaptive poll interval, see poll_sched.h
+
+#include <math.h>
+#include <stdio.h>
+
+#include "hal.h"
+#include "poll_sched.h"
+
+// below this (deci-degrees per hour) the reading counts as flat
+const float POLL_FLAT_RATE = 0.5f;
+// poll after this share of the predicted time to the next digit flip, the prediction is rough
+const float POLL_LEAD = 0.5f;
+
+struct PollSched
+{
+  unsigned long minMs;
+  unsigned long maxMs;
+  bool hasReading;
+  int32_t deci;
+  unsigned long readingAt;
+  float rate; // deci-degrees per hour, signed
+  int recoveryPolls;
+};
+
+static PollSched sched = {POLL_MIN_INTERVAL, POLL_MAX_INTERVAL, false, 0, 0, 0.0f, 0};
+
+void pollSchedSetBounds(unsigned long minMs, unsigned long maxMs)
+{
+  sched.minMs = minMs;
+  sched.maxMs = maxMs < minMs ? minMs : maxMs;
+}
+
+void pollSchedReading(int32_t deci)
+{
+  unsigned long now = halMillis();
+  if (sched.hasReading && now != sched.readingAt)
+  {
+    // weight by elapsed time: a sample over dt moves the estimate by dt / (dt + tau)
+    float dt = (float)(now - sched.readingAt);
+    float sample = (deci - sched.deci) * 3600000.0f / dt;
+    sched.rate += dt / (dt + POLL_RATE_TAU) * (sample - sched.rate);
+  }
+  sched.hasReading = true;
+  sched.deci = deci;
+  sched.readingAt = now;
+}
+
+void pollSchedPolled()
+{
+  if (sched.recoveryPolls > 0)
+    sched.recoveryPolls--;
+}
+
+void pollSchedRecovered()
+{
+  sched.recoveryPolls = POLL_RECOVERY_POLLS;
+}
+
+/// @brief Deci-degrees to go until the panel digit changes (the panel truncates toward zero)
+static int32_t stepsToFlip(int32_t deci, int dir)
+{
+  int32_t k = 1;
+  while (k < 20 && (deci + dir * k) / 10 == deci / 10)
+    k++;
+  return k;
+}
+
+unsigned long pollSchedInterval()
+{
+  if (sched.recoveryPolls > 0 || !sched.hasReading)
+    return sched.minMs;
+  float r = fabsf(sched.rate);
+  if (r < POLL_FLAT_RATE)
+    return sched.maxMs;
+
+  float ms = stepsToFlip(sched.deci, sched.rate > 0 ? 1 : -1) * 3600000.0f * POLL_LEAD / r;
+  if (ms <= (float)sched.minMs)
+    return sched.minMs;
+  if (ms >= (float)sched.maxMs)
+    return sched.maxMs;
+  return (unsigned long)ms;
+}
+
+size_t pollSchedReport(char *buf, size_t len)
+{
+  int n = snprintf(buf, len, "poll interval %lu ms (bounds %lu..%lu ms), rate %+.1f deci/h, recovery polls %d\n",
+                   pollSchedInterval(), sched.minMs, sched.maxMs, (double)sched.rate, sched.recoveryPolls);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
@@ -0,0 +1,39 @@
+// Adaptive poll interval for the polled thermometers
+// The panel shows whole degrees, so what matters is when the shown digit flips. A rate of change is
+// estimated from the displayed readings (time weighted, so frequent pushes do not dominate) and
+// the next poll is due when the value is predicted to reach the next whole degree in the direction
+// it moves, within the configured bounds. Flat readings stretch the interval to the maximum; after a
+// source recovered the minimum is used for a few polls.
+// There is no wall clock on the device, so "night" is not special: night readings are flat.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// default bounds
+const unsigned long POLL_MIN_INTERVAL = 60000;  // ms
+const unsigned long POLL_MAX_INTERVAL = 600000; // ms
+// time constant of the rate estimate
+const unsigned long POLL_RATE_TAU = 1800000; // ms
+// polls at the minimum interval after a source recovered
+const int POLL_RECOVERY_POLLS = 3;
+
+/// @brief Set interval bounds (min == max gives a fixed interval)
+void pollSchedSetBounds(unsigned long minMs, unsigned long maxMs);
+
+/// @brief New displayed reading (polled or pushed)
+void pollSchedReading(int32_t deci);
+
+/// @brief A poll was made (counts down the recovery polls)
+void pollSchedPolled();
+
+/// @brief A source delivered again after failing: poll at the minimum for a while
+void pollSchedRecovered();
+
+/// @brief Time from the last poll to the next one
+unsigned long pollSchedInterval();
+
+/// @brief Write rate estimate and interval as text
+/// @return Number of chars written
+size_t pollSchedReport(char *buf, size_t len);
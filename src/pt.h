@@ -0,0 +1,66 @@
+// Stackless cooperative tasks (protothreads)
+// A task is a function `int task(Pt *pt)` called from loop(); it runs until the next wait and returns.
+// All tasks share the loop() stack. Locals are NOT kept across waits: keep task state in a struct.
+// Only one PT_ statement per source line, and no switch statement around a wait.
+
+#pragma once
+
+#include "hal.h"
+
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define PT_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define PT_FALLTHROUGH
+#endif
+
+struct Pt
+{
+  unsigned short line; // resume point (__LINE__), 0 = start
+  unsigned long t0;    // PT_SLEEP start
+};
+
+enum
+{
+  PT_WAITING = 0,
+  PT_ENDED = 1
+};
+
+#define PT_INIT(pt) ((pt)->line = 0)
+
+#define PT_BEGIN(pt)    \
+  switch ((pt)->line)   \
+  {                     \
+  case 0:
+
+#define PT_END(pt) \
+  }                \
+  (pt)->line = 0;  \
+  return PT_ENDED
+
+// wait until condition is true (checked every call)
+#define PT_WAIT_UNTIL(pt, cond)  \
+  do                             \
+  {                              \
+    (pt)->line = __LINE__;       \
+    PT_FALLTHROUGH;              \
+  case __LINE__:                 \
+    if (!(cond))                 \
+      return PT_WAITING;         \
+  } while (0)
+
+// give other tasks one turn
+#define PT_YIELD(pt)             \
+  do                             \
+  {                              \
+    (pt)->line = __LINE__;       \
+    return PT_WAITING;           \
+  case __LINE__:;                \
+  } while (0)
+
+// non-blocking replacement for delay()
+#define PT_SLEEP(pt, ms)                                              \
+  do                                                                  \
+  {                                                                   \
+    (pt)->t0 = halMillis();                                           \
+    PT_WAIT_UNTIL(pt, halMillis() - (pt)->t0 >= (unsigned long)(ms)); \
+  } while (0)
@@ -0,0 +1,149 @@
+// Benchmark: protothread task switch vs FreeRTOS task switch, see pt_bench.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "pt.h"
+#include "pt_bench.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t benchNowNs()
+{
+#ifdef ARDUINO
+  static uint64_t high = 0;
+  static uint32_t last = 0;
+  uint32_t c = halCycles();
+  if (c < last)
+    high += 1ULL << 32;
+  last = c;
+  return (high + c) * 1000ULL / halCyclesPerUs();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+#if PT_BENCH_ENABLED
+
+const unsigned long PT_BENCH_SWITCHES = 200000;
+const unsigned long RTOS_BENCH_SWITCHES = 20000;
+
+// two protothreads handing a token back and forth
+struct PingPong
+{
+  volatile unsigned long token;
+  unsigned long limit;
+};
+
+static PingPong pp;
+
+static int pingTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  while (pp.token < pp.limit)
+  {
+    PT_WAIT_UNTIL(pt, (pp.token & 1) == 0);
+    pp.token++;
+  }
+  PT_END(pt);
+}
+
+static int pongTask(Pt *pt)
+{
+  PT_BEGIN(pt);
+  while (pp.token < pp.limit)
+  {
+    PT_WAIT_UNTIL(pt, (pp.token & 1) == 1);
+    pp.token++;
+  }
+  PT_END(pt);
+}
+
+#ifdef ARDUINO
+const uint32_t RTOS_BENCH_STACK = 2048; // bytes, smallest sensible stack for a real task
+
+static TaskHandle_t rtosPing = nullptr;
+static TaskHandle_t rtosPong = nullptr;
+static SemaphoreHandle_t rtosDone = nullptr;
+
+static void rtosPingTask(void *)
+{
+  for (unsigned long i = 0; i < RTOS_BENCH_SWITCHES / 2; i++)
+  {
+    xTaskNotifyGive(rtosPong);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  xSemaphoreGive(rtosDone);
+  vTaskSuspend(nullptr);
+}
+
+static void rtosPongTask(void *)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xTaskNotifyGive(rtosPing);
+  }
+}
+
+/// @return ns per switch
+static uint32_t rtosBench()
+{
+  rtosDone = xSemaphoreCreateBinary();
+  UBaseType_t prio = uxTaskPriorityGet(nullptr) + 1;
+  xTaskCreate(rtosPongTask, "bpong", RTOS_BENCH_STACK, nullptr, prio, &rtosPong);
+  uint64_t t0 = benchNowNs();
+  xTaskCreate(rtosPingTask, "bping", RTOS_BENCH_STACK, nullptr, prio, &rtosPing);
+  xSemaphoreTake(rtosDone, portMAX_DELAY);
+  uint64_t t1 = benchNowNs();
+  vTaskDelete(rtosPing);
+  vTaskDelete(rtosPong);
+  vSemaphoreDelete(rtosDone);
+  return (uint32_t)((t1 - t0) / RTOS_BENCH_SWITCHES);
+}
+#endif
+
+size_t ptBenchmark(char *buf, size_t len)
+{
+  Pt a, b;
+  PT_INIT(&a);
+  PT_INIT(&b);
+  pp.token = 0;
+  pp.limit = PT_BENCH_SWITCHES;
+
+  uint64_t t0 = benchNowNs();
+  // scheduler loop like loop(): every pass resumes each task once
+  for (;;)
+  {
+    int ra = pingTask(&a);
+    int rb = pongTask(&b);
+    if (ra == PT_ENDED && rb == PT_ENDED)
+      break;
+  }
+  uint64_t t1 = benchNowNs();
+  uint32_t ptNs = (uint32_t)((t1 - t0) / PT_BENCH_SWITCHES);
+
+  size_t n = snprintf(buf, len, "protothread: %lu ns/switch, %u bytes/task (Pt)\n", (unsigned long)ptNs,
+                      (unsigned)sizeof(Pt));
+#ifdef ARDUINO
+  uint32_t rtosNs = rtosBench();
+  if (n < len)
+    n += snprintf(buf + n, len - n, "freertos:    %lu ns/switch, %u bytes/task (stack %u + TCB %u)\n",
+                  (unsigned long)rtosNs, (unsigned)(RTOS_BENCH_STACK + sizeof(StaticTask_t)),
+                  (unsigned)RTOS_BENCH_STACK, (unsigned)sizeof(StaticTask_t));
+#else
+  if (n < len)
+    n += snprintf(buf + n, len - n, "freertos:    n/a on host\n");
+#endif
+  return n < len ? n : len - 1;
+}
+
+#endif
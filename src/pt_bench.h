@@ -0,0 +1,21 @@
+// Benchmark: protothread task switch vs FreeRTOS task switch (cost and RAM)
+// Run from serial ('b') on device or with --bench-pt on host (no FreeRTOS there).
+// Off by default; [env:native] turns it on, a device build can with -DPT_BENCH_ENABLED=1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef PT_BENCH_ENABLED
+#define PT_BENCH_ENABLED 0
+#endif
+
+/// @brief Nanoseconds from a real (not virtual) clock, for benchmarks
+uint64_t benchNowNs();
+
+#if PT_BENCH_ENABLED
+/// @brief Run benchmark (blocks for a few ms) and write report as text
+/// @return Number of chars written
+size_t ptBenchmark(char *buf, size_t len);
+#endif
@@ -0,0 +1,421 @@
+// Pass/fail checks of the untrusted-input parsers, see selftest.h
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selftest.h"
+
+#if SELFTEST_ENABLED
+
+#include "hal.h"
+#include "hal_host.h"
+#include "api_json.h"
+#include "history.h"
+#include "http_chunked.h"
+#include "serial_proto.h"
+#include "temp_json_bench.h"
+
+struct Selftest
+{
+  char *report;
+  size_t len;
+  size_t n;
+  int checks;
+  int failed;
+};
+
+static Selftest st;
+
+static void say(const char *fmt, ...)
+{
+  if (st.n + 1 >= st.len)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  int w = vsnprintf(st.report + st.n, st.len - st.n, fmt, args);
+  va_end(args);
+  if (w > 0)
+    st.n = st.n + w < st.len ? st.n + w : st.len - 1;
+}
+
+#define CHECK(cond)                                              \
+  do                                                             \
+  {                                                              \
+    st.checks++;                                                 \
+    if (!(cond))                                                 \
+    {                                                            \
+      st.failed++;                                               \
+      say("  FAIL line %d: %s\n", __LINE__, #cond);              \
+    }                                                            \
+  } while (0)
+
+/// @brief Report line of one group, from the counts at its start
+static void groupDone(const char *name, int checks, int failed)
+{
+  int run = st.checks - checks;
+  say("%-15s %d/%d passed\n", name, run - (st.failed - failed), run);
+}
+
+// ===== Serial framing =====
+// independent bitwise CRC-16/CCITT-FALSE and COBS encoder, the receiver must agree with them
+static uint16_t refCrc16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xffff;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= (uint16_t)(data[i] << 8);
+    for (int b = 0; b < 8; b++)
+      crc = (uint16_t)(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+  }
+  return crc;
+}
+
+/// @brief 00 | COBS(type, seq, body, CRC) | 00
+/// @param tailCode  Emit the empty block after a final full 254 byte run (both forms are valid)
+static size_t refFrame(uint8_t type, uint8_t seq, const uint8_t *body, size_t len, uint8_t *out, bool tailCode = true)
+{
+  uint8_t payload[300];
+  payload[0] = type;
+  payload[1] = seq;
+  memcpy(payload + 2, body, len);
+  uint16_t crc = refCrc16(payload, len + 2);
+  payload[len + 2] = (uint8_t)crc;
+  payload[len + 3] = (uint8_t)(crc >> 8);
+  size_t n = len + 4;
+
+  size_t o = 0;
+  out[o++] = 0;
+  size_t codeAt = o++;
+  uint8_t code = 1;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (payload[i] != 0)
+    {
+      out[o++] = payload[i];
+      code++;
+    }
+    if (payload[i] == 0 || code == 0xff)
+    {
+      out[codeAt] = payload[i] == 0 ? code : 0xff;
+      if (payload[i] != 0 && i + 1 == n && !tailCode)
+      {
+        codeAt = 0; // frame ends on the full block
+        break;
+      }
+      codeAt = o++;
+      code = 1;
+    }
+  }
+  if (codeAt)
+    out[codeAt] = code;
+  out[o++] = 0;
+  return o;
+}
+
+static struct
+{
+  int calls;
+  uint8_t type;
+  uint8_t body[SERIAL_FRAME_MAX];
+  size_t len;
+} rxSeen;
+
+static void rxHandler(uint8_t type, const uint8_t *body, size_t len)
+{
+  rxSeen.calls++;
+  rxSeen.type = type;
+  rxSeen.len = len;
+  memcpy(rxSeen.body, body, len);
+  serialProtoReply(SERIAL_OK, nullptr, 0);
+}
+
+/// @brief Feed a frame whole or byte by byte
+/// @return Handler saw exactly this body
+static bool rxDelivers(const uint8_t *wire, size_t n, const uint8_t *body, size_t len, bool bytewise)
+{
+  uint8_t buf[600];
+  memcpy(buf, wire, n);
+  int calls = rxSeen.calls;
+  if (bytewise)
+  {
+    for (size_t i = 0; i < n; i++)
+      serialProtoFeed(buf + i, 1);
+  }
+  else
+    serialProtoFeed(buf, n);
+  return rxSeen.calls == calls + 1 && rxSeen.type == SERIAL_SET_FRAME && rxSeen.len == len &&
+         memcmp(rxSeen.body, body, len) == 0;
+}
+
+static void testSerial()
+{
+  int checks = st.checks, failed = st.failed;
+  serialProtoBegin(rxHandler);
+  uint8_t wire[600];
+  uint8_t body[255];
+  size_t n;
+
+  // short frame, whole and split
+  body[0] = 0x34;
+  body[1] = 0x12;
+  n = refFrame(SERIAL_SET_FRAME, 1, body, 2, wire);
+  CHECK(rxDelivers(wire, n, body, 2, false));
+  CHECK(rxDelivers(wire, n, body, 2, true));
+
+  // zeros inside and at the end of the body (trailing zero before the CRC)
+  memset(body, 0, 6);
+  body[2] = 7;
+  n = refFrame(SERIAL_SET_FRAME, 2, body, 6, wire);
+  CHECK(rxDelivers(wire, n, body, 6, false));
+
+  // longest body without zeros: a 0xFF block followed by a short one
+  memset(body, 0x11, 255);
+  n = refFrame(SERIAL_SET_FRAME, 3, body, 255, wire);
+  CHECK(rxDelivers(wire, n, body, 255, true));
+
+  // payload exactly one full 254 byte block: with and without the empty block after it
+  uint8_t seq = 4;
+  for (;; seq++)
+  {
+    uint8_t p[254] = {SERIAL_SET_FRAME, seq};
+    memset(p + 2, 0x22, 250);
+    uint16_t crc = refCrc16(p, 252);
+    if ((crc & 0xff) && (crc >> 8))
+      break; // CRC without a zero byte keeps the run at 254
+  }
+  memset(body, 0x22, 250);
+  n = refFrame(SERIAL_SET_FRAME, seq, body, 250, wire, true);
+  CHECK(wire[1] == 0xff && wire[n - 2] == 0x01);
+  CHECK(rxDelivers(wire, n, body, 250, false));
+  n = refFrame(SERIAL_SET_FRAME, seq, body, 250, wire, false);
+  CHECK(wire[1] == 0xff && n == 257);
+  CHECK(rxDelivers(wire, n, body, 250, false));
+
+  // bad CRC, block cut short, too short for type/seq/CRC: dropped unanswered
+  const SerialProtoStats &s = serialProtoStats();
+  unsigned long crcErrors = s.crcErrors;
+  int calls = rxSeen.calls;
+  body[0] = 5;
+  n = refFrame(SERIAL_SET_FRAME, 9, body, 1, wire);
+  wire[3] ^= 0x40;
+  serialProtoFeed(wire, n);
+  uint8_t cut[] = {0, 0x06, 1, 2, 0};
+  serialProtoFeed(cut, sizeof(cut));
+  uint8_t tiny[] = {0, 0x03, 1, 2, 0};
+  serialProtoFeed(tiny, sizeof(tiny));
+  CHECK(s.crcErrors == crcErrors + 3 && rxSeen.calls == calls);
+
+  // overlong: dropped, the next frame is fine
+  unsigned long overruns = s.overruns;
+  uint8_t longFrame[320];
+  longFrame[0] = 0;
+  for (size_t i = 1; i < sizeof(longFrame) - 1; i++)
+    longFrame[i] = (i - 1) % 255 == 0 ? 0xff : 0x33;
+  longFrame[sizeof(longFrame) - 1] = 0;
+  serialProtoFeed(longFrame, sizeof(longFrame));
+  CHECK(s.overruns == overruns + 1 && rxSeen.calls == calls);
+  body[0] = 1;
+  n = refFrame(SERIAL_SET_FRAME, 10, body, 1, wire);
+  CHECK(rxDelivers(wire, n, body, 1, false));
+
+  // idle link goes back to text, bytes outside frames are handed back
+  hostAdvanceUs((SERIAL_FRAME_IDLE_MS + 1) * 1000ULL);
+  uint8_t text[] = {'t', 'r'};
+  CHECK(serialProtoFeed(text, sizeof(text)) == 2 && text[0] == 't' && text[1] == 'r');
+
+  serialProtoBegin(nullptr);
+  groupDone("serial_proto", checks, failed);
+}
+
+// ===== Chunked bodies =====
+/// @brief Decode src fed in pieces of step bytes
+/// @return Decoder status; body and the offset where decoding stopped in out parameters
+static HttpChunkedStatus dechunk(const char *src, size_t step, char *body, size_t &bodyLen, size_t &stop)
+{
+  HttpChunked d;
+  httpChunkedInit(d);
+  size_t len = strlen(src), pos = 0;
+  bodyLen = 0;
+  while (pos < len && d.status == HTTP_CHUNKED_MORE)
+  {
+    char piece[64];
+    size_t n = len - pos < step ? len - pos : step;
+    memcpy(piece, src + pos, n);
+    size_t used;
+    size_t out = httpChunkedFeed(d, piece, n, used);
+    memcpy(body + bodyLen, piece, out);
+    bodyLen += out;
+    pos += used;
+  }
+  stop = pos;
+  return d.status;
+}
+
+static void testChunked()
+{
+  int checks = st.checks, failed = st.failed;
+  const char *wire = "4;ext=1\r\n{\"te\r\n1A\r\nmperature\":3.25,\"x\":12345}\r\n0\r\nFoo: bar\r\n\r\nNEXT";
+  const char *want = "{\"temperature\":3.25,\"x\":12345}";
+  char body[128];
+  size_t bodyLen, stop;
+  bool allSplits = true;
+  for (size_t step = 1; step <= 64; step++)
+  {
+    HttpChunkedStatus s = dechunk(wire, step, body, bodyLen, stop);
+    allSplits = allSplits && s == HTTP_CHUNKED_DONE && bodyLen == strlen(want) &&
+                memcmp(body, want, bodyLen) == 0 && strcmp(wire + stop, "NEXT") == 0;
+  }
+  CHECK(allSplits);
+
+  CHECK(dechunk("0\r\n\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_DONE && bodyLen == 0);
+  CHECK(dechunk("zz\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR);           // not hex
+  CHECK(dechunk("\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR);             // no size
+  CHECK(dechunk("10000\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR);        // over the cap
+  CHECK(dechunk("2\r\nabX\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR);     // no CRLF after data
+  CHECK(dechunk("2\nab\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR);        // bare LF
+  CHECK(dechunk("2\r\nab\r\n0\r\n\rX", 64, body, bodyLen, stop) == HTTP_CHUNKED_ERROR); // bad last line
+  CHECK(dechunk("2\r\nab\r\n", 64, body, bodyLen, stop) == HTTP_CHUNKED_MORE && bodyLen == 2); // truncated
+  groupDone("http_chunked", checks, failed);
+}
+
+// ===== REST JSON =====
+static void testApiJson()
+{
+  int checks = st.checks, failed = st.failed;
+  char buf[160];
+  ApiJson w;
+  apiJsonBegin(w, buf, sizeof(buf));
+  apiJsonString(w, "s", "a\"b\\c\n");
+  apiJsonInt(w, "i", -42);
+  apiJsonUint(w, "u", 4000000000UL);
+  apiJsonDeci(w, "d", -5);
+  apiJsonDeci(w, "e", 1234);
+  apiJsonArray(w, "a");
+  apiJsonBool(w, nullptr, true);
+  apiJsonNull(w, nullptr);
+  apiJsonObject(w, nullptr);
+  apiJsonEnd(w);
+  apiJsonEnd(w);
+  apiJsonObject(w, "o"); // left open, closed by finish
+  apiJsonBool(w, "f", false);
+  size_t n = apiJsonFinish(w);
+  const char *want = "{\"s\":\"a\\\"b\\\\c\\u000a\",\"i\":-42,\"u\":4000000000,\"d\":-0.5,\"e\":123.4,"
+                     "\"a\":[true,null,{}],\"o\":{\"f\":false}}";
+  CHECK(n == strlen(want) && strcmp(buf, want) == 0);
+
+  // overflow: nothing, never a truncated document
+  char small[16];
+  apiJsonBegin(w, small, sizeof(small));
+  apiJsonString(w, "key", "a value that does not fit");
+  CHECK(apiJsonFinish(w) == 0 && small[0] == '\0');
+  apiJsonBegin(w, small, sizeof(small));
+  for (int i = 0; i < API_JSON_DEPTH + 1; i++)
+    apiJsonArray(w, i ? nullptr : "k");
+  CHECK(apiJsonFinish(w) == 0);
+
+  // reader
+  char out[16];
+  bool isString;
+  const char *doc = " { \"frame\" : 512, \"skip\": {\"temp\": [1, \"}\"]}, \"temp\":\"-1\\\"2\", \"on\":true } ";
+  CHECK(apiJsonMember(doc, "frame", out, sizeof(out), isString) && strcmp(out, "512") == 0 && !isString);
+  CHECK(apiJsonMember(doc, "temp", out, sizeof(out), isString) && strcmp(out, "-1\"2") == 0 && isString);
+  CHECK(apiJsonMember(doc, "on", out, sizeof(out), isString) && strcmp(out, "true") == 0);
+  CHECK(!apiJsonMember(doc, "skip", out, sizeof(out), isString));    // nested
+  CHECK(!apiJsonMember(doc, "missing", out, sizeof(out), isString));
+  CHECK(!apiJsonMember("{\"a\":\"0123456789abcdefXYZ\"}", "a", out, sizeof(out), isString)); // too long
+  CHECK(!apiJsonMember("{\"a\":\"open", "a", out, sizeof(out), isString));
+  CHECK(!apiJsonMember("{\"a\" 1}", "a", out, sizeof(out), isString));
+  CHECK(!apiJsonMember("{\"a\":}", "a", out, sizeof(out), isString)); // no value
+  CHECK(!apiJsonMember("[1]", "a", out, sizeof(out), isString));
+  CHECK(!apiJsonMember("{\"x\":\"\\u00", "a", out, sizeof(out), isString));
+  CHECK(!apiJsonMember("", "a", out, sizeof(out), isString));
+  groupDone("api_json", checks, failed);
+}
+
+// ===== History codec =====
+// gaps that take 1..5 byte varints, the longest only once so the clock does not wrap
+static const uint32_t HISTORY_GAPS[] = {1, 127, 128, 16383, 16384, 2097151, 2097152, 268435455, 268435456, 300};
+// changes of both signs around the zigzag byte boundaries, and the range limits
+static const int32_t HISTORY_VALUES[] = {0, 1, -1, 990, -600, 63, -64, 64, -65, 215};
+
+static uint32_t historyGap(int i)
+{
+  return i < 10 ? HISTORY_GAPS[i] : HISTORY_GAPS[i % 7];
+}
+
+static void testHistory()
+{
+  int checks = st.checks, failed = st.failed;
+  historyBegin(); // host NVS is empty unless --nvs came first
+
+  // enough samples to fill several blocks
+  const int count = 400;
+  static uint32_t t[count];
+  static int32_t v[count];
+  for (int i = 0; i < count; i++)
+  {
+    hostAdvanceUs((uint64_t)historyGap(i) * 1000000ULL);
+    v[i] = HISTORY_VALUES[(i * 7) % 10];
+    historyAdd(v[i]);
+  }
+
+  HistoryCursor c = historyCursor();
+  HistorySample s;
+  int seen = 0;
+  bool values = true;
+  while (seen < count && historyNext(c, s))
+  {
+    t[seen] = s.t;
+    values = values && s.deci == v[seen] && s.boot == (seen == 0);
+    seen++;
+  }
+  CHECK(values);
+  CHECK(seen == count && !historyNext(c, s));
+  bool gaps = true;
+  for (int i = 1; i < seen; i++)
+    gaps = gaps && t[i] - t[i - 1] == historyGap(i);
+  CHECK(gaps);
+
+  // binary export: header lengths match, counts add up
+  uint8_t block[HISTORY_BLOCK_HEADER + HISTORY_BLOCK_BYTES];
+  unsigned total = 0;
+  int blocks = 0;
+  for (int i = 0; i < HISTORY_BLOCKS; i++)
+  {
+    size_t n = historyBlock(i, block, sizeof(block));
+    if (n == 0)
+      continue; // slot not used yet
+    unsigned samples = block[7] | block[8] << 8;
+    unsigned used = block[9] | block[10] << 8;
+    CHECK(n == HISTORY_BLOCK_HEADER + used && samples > 0);
+    total += samples;
+    blocks++;
+  }
+  CHECK(blocks > 1 && total == (unsigned)count);
+  groupDone("history", checks, failed);
+}
+
+bool selftestRun(char *report, size_t len)
+{
+  st.report = report;
+  st.len = len;
+  st.n = 0;
+  st.checks = 0;
+  st.failed = 0;
+  report[0] = '\0';
+
+  testSerial();
+  testChunked();
+  testApiJson();
+  testHistory();
+#if TEMP_JSON_BENCH_ENABLED
+  char fuzz[256];
+  int checks = st.checks, failed = st.failed;
+  CHECK(tempJsonFuzz(20000, 1, fuzz, sizeof(fuzz)));
+  groupDone("temp_json fuzz", checks, failed);
+#endif
+  return st.failed == 0;
+}
+
+#endif
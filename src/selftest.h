@@ -0,0 +1,19 @@
+// Pass/fail checks of the parsers that see untrusted input, run on host with --selftest
+// Serial COBS/CRC framing (serial_proto.h), chunked HTTP bodies (http_chunked.h), the REST API
+// JSON writer and reader (api_json.h), the history varint codec (history.h) and a short fuzz run
+// of the thermometer payload reader (temp_json.h). The host runner exits non-zero on a failure.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SELFTEST_ENABLED
+#define SELFTEST_ENABLED 0
+#endif
+
+#if SELFTEST_ENABLED
+/// @brief Run all checks; takes over the serial protocol handler and the history ring
+/// @return true if all passed, report holds a line per group and every failed check
+bool selftestRun(char *report, size_t len);
+#endif
@@ -0,0 +1,197 @@
+// Serial binary control protocol, see serial_proto.h
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "serial_proto.h"
+
+// CRC-16/CCITT-FALSE a nibble at a time
+static const uint16_t CRC16_NIBBLE[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+                                          0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
+// reply: type, seq, status, body, CRC
+const size_t SERIAL_REPLY_MAX = 64;
+
+struct SerialRx
+{
+  bool inFrame;  // a 0x00 was seen, bytes are COBS until the next one
+  uint8_t buf[SERIAL_FRAME_MAX];
+  size_t len;
+  uint8_t code;  // current COBS block code, 0 before the first
+  uint8_t left;  // bytes left in the block, 0 = next byte is a code
+  bool overrun;
+  unsigned long lastMs;
+};
+
+struct SerialProto
+{
+  SerialProtoHandler handler;
+  SerialRx rx;
+  uint8_t type; // frame being handled
+  uint8_t seq;
+  bool replied;
+  SerialProtoStats stats;
+};
+
+static SerialProto sp = {};
+
+static uint16_t crc16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xffff;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc = (uint16_t)(crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (uint16_t)(crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (data[i] & 15)];
+  }
+  return crc;
+}
+
+void serialProtoBegin(SerialProtoHandler handler)
+{
+  sp.handler = handler;
+}
+
+static void rxReset(SerialRx &rx)
+{
+  rx.len = 0;
+  rx.code = 0;
+  rx.left = 0;
+  rx.overrun = false;
+}
+
+static void rxPut(SerialRx &rx, uint8_t b)
+{
+  if (rx.len < sizeof(rx.buf))
+    rx.buf[rx.len++] = b;
+  else
+    rx.overrun = true;
+}
+
+/// @brief Delimiter after a frame: check and hand it to the handler
+static void rxEnd(SerialRx &rx)
+{
+  if (rx.code == 0)
+    return; // 00 00, nothing in between
+  if (rx.overrun)
+  {
+    sp.stats.overruns++;
+    return;
+  }
+  // a block cut short, or no room for type, seq and CRC
+  if (rx.left != 0 || rx.len < 4 || crc16(rx.buf, rx.len - 2) != (rx.buf[rx.len - 2] | rx.buf[rx.len - 1] << 8))
+  {
+    sp.stats.crcErrors++;
+    return;
+  }
+  sp.stats.frames++;
+  sp.type = rx.buf[0];
+  sp.seq = rx.buf[1];
+  sp.replied = false;
+  if (sp.handler)
+    sp.handler(sp.type, rx.buf + 2, rx.len - 4);
+  if (!sp.replied)
+    serialProtoReply(SERIAL_UNKNOWN, nullptr, 0);
+}
+
+size_t serialProtoFeed(uint8_t *data, size_t len)
+{
+  SerialRx &rx = sp.rx;
+  unsigned long now = halMillis();
+  if (rx.inFrame && len > 0 && now - rx.lastMs >= SERIAL_FRAME_IDLE_MS)
+  {
+    // client gone mid-frame, or idle since the last one: back to text commands
+    if (rx.code != 0)
+      sp.stats.timeouts++;
+    rx.inFrame = false;
+    rxReset(rx);
+  }
+  if (len > 0)
+    rx.lastMs = now;
+
+  size_t text = 0;
+  for (size_t i = 0; i < len; i++)
+  {
+    uint8_t b = data[i];
+    if (b == 0)
+    {
+      if (rx.inFrame)
+        rxEnd(rx);
+      rx.inFrame = true;
+      rxReset(rx);
+    }
+    else if (!rx.inFrame)
+    {
+      data[text++] = b;
+      sp.stats.textBytes++;
+    }
+    else if (rx.left == 0)
+    {
+      // code byte: the block before it ended in a zero unless it was a full 254 bytes
+      if (rx.code != 0 && rx.code != 0xff)
+        rxPut(rx, 0);
+      rx.code = b;
+      rx.left = b - 1;
+    }
+    else
+    {
+      rxPut(rx, b);
+      rx.left--;
+    }
+  }
+  return text;
+}
+
+void serialProtoReply(SerialStatus status, const uint8_t *body, size_t len)
+{
+  if (sp.replied)
+    return;
+  sp.replied = true;
+  uint8_t payload[SERIAL_REPLY_MAX];
+  if (len > sizeof(payload) - 5)
+    len = 0;
+  payload[0] = sp.type | SERIAL_REPLY;
+  payload[1] = sp.seq;
+  payload[2] = (uint8_t)status;
+  for (size_t i = 0; i < len; i++)
+    payload[3 + i] = body[i];
+  size_t n = 3 + len;
+  uint16_t crc = crc16(payload, n);
+  payload[n++] = (uint8_t)crc;
+  payload[n++] = (uint8_t)(crc >> 8);
+
+  // COBS: each block is a code (distance to the next zero) and the bytes up to it; replies are
+  // shorter than a full 254 byte block, so there is no 0xFF code to emit
+  uint8_t out[SERIAL_REPLY_MAX + 4];
+  size_t o = 0;
+  out[o++] = 0;
+  size_t codeAt = o++;
+  uint8_t code = 1;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (payload[i] == 0)
+    {
+      out[codeAt] = code;
+      codeAt = o++;
+      code = 1;
+      continue;
+    }
+    out[o++] = payload[i];
+    code++;
+  }
+  out[codeAt] = code;
+  out[o++] = 0;
+  halSerialWriteBytes(out, o);
+}
+
+const SerialProtoStats &serialProtoStats()
+{
+  return sp.stats;
+}
+
+size_t serialProtoReport(char *buf, size_t len)
+{
+  const SerialProtoStats &s = sp.stats;
+  int n = snprintf(buf, len, "serial %lu frames, %lu CRC errors, %lu overruns, %lu timeouts, %lu text bytes\n",
+                   s.frames, s.crcErrors, s.overruns, s.timeouts, s.textBytes);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
@@ -0,0 +1,81 @@
+// Binary control protocol on the serial port, for enclosures where WiFi is not reliable
+// Frames are COBS encoded and delimited by 0x00 on both sides: 00 | COBS(payload) | 00. The payload
+// is type, sequence number, body and a CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of the bytes
+// before it, little-endian. Every good frame is answered with type | 0x80, the same sequence number,
+// a status byte and the reply body; frames with a bad CRC or an overlong body are dropped unanswered
+// (the sequence number is not trusted), the client times out and resends.
+//
+// Commands (body -> reply body, integers little-endian):
+//   SERIAL_SET_VALUE  int8 -99..99        -> frame u16
+//   SERIAL_SET_SYMBOL "NULL", "--", ...   -> frame u16
+//   SERIAL_SET_FRAME  frame u16           -> frame u16
+//   SERIAL_STREAM     flags u8, records   -> queued u16, free u16 (playback.h records and ring;
+//                     flag 1 replaces what is queued, as /api/play?replace=1)
+//   SERIAL_STATS      -                   -> uptime ms u32, panel frame u16, temp deci i16,
+//                     wifi u8, playback queued u16, shown u32, skipped u32, receiver frames u32,
+//                     CRC errors u32, overruns u32, timeouts u32
+// The commands are carried out by a handler in main.cpp, like the web routes.
+//
+// The receiver decodes COBS as the bytes arrive, one byte at a time into a fixed buffer: no line
+// buffering, no String, constant work per byte. serialProtoFeed() runs the handler of a complete
+// frame before it returns, and the handler drives the display and playback, so it must be called
+// from the main loop (never from the UART interrupt; the UART driver's receive buffer holds a burst
+// meanwhile). A frame starts only after a 0x00; after SERIAL_FRAME_IDLE_MS without
+// input the link returns to text (a frame cut off there is dropped), so the one-letter commands of
+// serialPoll() keep working: a byte outside a frame is handed back.
+// Log output shares the port; it never contains 0x00, so a client skips it as a bad frame.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const size_t SERIAL_FRAME_MAX = 260; // decoded payload: type, seq, 255 body bytes, CRC
+const unsigned long SERIAL_FRAME_IDLE_MS = 500;
+
+enum SerialCommand
+{
+  SERIAL_SET_VALUE = 0x01,
+  SERIAL_SET_SYMBOL = 0x02,
+  SERIAL_SET_FRAME = 0x03,
+  SERIAL_STREAM = 0x04,
+  SERIAL_STATS = 0x05,
+  SERIAL_REPLY = 0x80 // or'ed into the reply type
+};
+
+enum SerialStatus
+{
+  SERIAL_OK = 0,
+  SERIAL_BAD = 1,     // malformed body or value out of range
+  SERIAL_FULL = 2,    // stream records do not fit the ring now, resend later
+  SERIAL_UNKNOWN = 3  // command type
+};
+
+/// @brief Handler for decoded command frames, answers with serialProtoReply()
+typedef void (*SerialProtoHandler)(uint8_t type, const uint8_t *body, size_t len);
+
+/// @brief Set the handler for command frames (main.cpp)
+void serialProtoBegin(SerialProtoHandler handler);
+
+/// @brief Take received bytes, complete frames go to the handler (main loop only, see above)
+/// @return Bytes outside frames, moved to the start of data (text commands)
+size_t serialProtoFeed(uint8_t *data, size_t len);
+
+/// @brief Answer the frame being handled
+void serialProtoReply(SerialStatus status, const uint8_t *body, size_t len);
+
+/// @brief Write frame counts and errors as text
+/// @return Number of chars written
+size_t serialProtoReport(char *buf, size_t len);
+
+/// @brief Receiver counters, for the stats reply
+struct SerialProtoStats
+{
+  unsigned long frames;    // good frames
+  unsigned long crcErrors; // bad CRC, too short, or not COBS
+  unsigned long overruns;  // longer than SERIAL_FRAME_MAX
+  unsigned long timeouts;  // cut off for SERIAL_FRAME_IDLE_MS
+  unsigned long textBytes; // outside frames
+};
+
+const SerialProtoStats &serialProtoStats();
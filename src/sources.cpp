@@ -0,0 +1,351 @@
+// Sensor source registry, see sources.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "sources.h"
+
+// success rate in 1/100 percent, moved 1/8 of the way per attempt
+const uint16_t SOURCE_RATE_FULL = 10000;
+const int SOURCE_RATE_SHIFT = 3;
+// latency penalty: 1 point per 20 ms, at most 25
+const unsigned long SOURCE_LATENCY_MS_PER_POINT = 20;
+const int SOURCE_LATENCY_PENALTY_MAX = 25;
+// staleness penalty grows to this at SOURCE_STALE_MS
+const int SOURCE_STALE_PENALTY = 50;
+
+struct SourceEntry
+{
+  bool used;
+  uint8_t kind;
+  uint8_t id;
+  uint8_t breaker;
+  uint8_t streak; // failures in a row
+  unsigned long backoffMs;
+  unsigned long probeAt;
+  uint16_t rate; // success rate
+  bool failing;  // last attempt failed
+  unsigned long latencyMs;
+  bool hasValue;
+  int32_t deci;
+  unsigned long valueAt;
+  unsigned long touchedAt; // registered or last reading / failure, for eviction
+  unsigned long readings;
+  unsigned long failures;
+  unsigned long skipped;
+};
+
+static SourceEntry sources[SOURCE_MAX];
+static FusionPolicy policy = FUSION_BEST;
+static bool recovered = false;
+
+static const char *const KIND_NAMES[SOURCE_KIND_COUNT] = {"http", "udp", "mqtt", "post"};
+static const char *const POLICY_NAMES[FUSION_POLICY_COUNT] = {"best", "median", "weighted"};
+static const char *const BREAKER_NAMES[] = {"closed", "open", "half"};
+
+/// @brief Slot of the pushed source heard from longest ago, polled ones are never evicted
+/// @return -1 if all slots hold polled sources
+static int evictSlot()
+{
+  unsigned long now = halMillis();
+  int slot = -1;
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    if (sources[i].kind != SOURCE_HTTP &&
+        (slot < 0 || now - sources[i].touchedAt > now - sources[slot].touchedAt))
+      slot = i;
+  }
+  return slot;
+}
+
+int sourceFind(SourceKind kind, uint8_t id)
+{
+  int freeSlot = -1;
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    if (sources[i].used && sources[i].kind == kind && sources[i].id == id)
+      return i;
+    if (!sources[i].used && freeSlot < 0)
+      freeSlot = i;
+  }
+  if (freeSlot < 0)
+    freeSlot = evictSlot();
+  if (freeSlot < 0)
+    return -1;
+  SourceEntry &e = sources[freeSlot];
+  memset(&e, 0, sizeof(e));
+  e.used = true;
+  e.kind = kind;
+  e.id = id;
+  e.rate = SOURCE_RATE_FULL; // benefit of the doubt until the first attempt
+  e.backoffMs = SOURCE_BACKOFF_MIN;
+  e.touchedAt = halMillis();
+  return freeSlot;
+}
+
+/// @brief Breaker applies to polled sources only, pushed ones cost nothing while silent
+static bool polled(const SourceEntry &e)
+{
+  return e.kind == SOURCE_HTTP;
+}
+
+/// @brief Open the breaker, the probe waits backoff plus up to 25 % jitter
+static void breakerOpen(SourceEntry &e)
+{
+  if (e.breaker == BREAKER_HALF_OPEN)
+    e.backoffMs = e.backoffMs >= SOURCE_BACKOFF_MAX / 2 ? SOURCE_BACKOFF_MAX : e.backoffMs * 2;
+  e.breaker = BREAKER_OPEN;
+  e.probeAt = halMillis() + e.backoffMs + halMicros() % (e.backoffMs / 4 + 1);
+}
+
+static bool probeDue(const SourceEntry &e, unsigned long now)
+{
+  return (long)(now - e.probeAt) >= 0;
+}
+
+static void rateUpdate(SourceEntry &e, bool ok)
+{
+  int target = ok ? SOURCE_RATE_FULL : 0;
+  e.rate = (uint16_t)(e.rate + ((target - (int)e.rate) >> SOURCE_RATE_SHIFT));
+  if (ok && e.rate > SOURCE_RATE_FULL - (1 << SOURCE_RATE_SHIFT))
+    e.rate = SOURCE_RATE_FULL; // shift rounding would never get there
+}
+
+bool sourceReading(int src, int32_t deci, unsigned long latencyMs)
+{
+  if (src < 0)
+    return false;
+  if (deci < SOURCE_MIN_DECI || deci > SOURCE_MAX_DECI)
+  {
+    sourceFailure(src);
+    return false;
+  }
+  SourceEntry &e = sources[src];
+  rateUpdate(e, true);
+  recovered = recovered || e.failing;
+  e.failing = false;
+  e.streak = 0;
+  e.breaker = BREAKER_CLOSED;
+  e.backoffMs = SOURCE_BACKOFF_MIN;
+  if (latencyMs)
+    e.latencyMs = e.readings ? (e.latencyMs * 7 + latencyMs) / 8 : latencyMs;
+  e.readings++;
+  e.hasValue = true;
+  e.deci = deci;
+  e.valueAt = halMillis();
+  e.touchedAt = e.valueAt;
+  return true;
+}
+
+void sourceFailure(int src)
+{
+  if (src < 0)
+    return;
+  SourceEntry &e = sources[src];
+  rateUpdate(e, false);
+  e.failures++;
+  e.touchedAt = halMillis();
+  e.failing = true;
+  if (e.streak < 255)
+    e.streak++;
+  if (polled(e) && (e.breaker == BREAKER_HALF_OPEN || (e.breaker == BREAKER_CLOSED && e.streak >= SOURCE_BREAKER_FAILURES)))
+    breakerOpen(e);
+}
+
+bool sourceRecovered()
+{
+  bool r = recovered;
+  recovered = false;
+  return r;
+}
+
+static bool fresh(const SourceEntry &e, unsigned long now)
+{
+  return e.used && e.hasValue && now - e.valueAt < SOURCE_STALE_MS;
+}
+
+uint8_t sourceHealth(int src)
+{
+  if (src < 0)
+    return 0;
+  const SourceEntry &e = sources[src];
+  int h = e.rate / 100;
+  unsigned long lat = e.latencyMs / SOURCE_LATENCY_MS_PER_POINT;
+  h -= lat > (unsigned long)SOURCE_LATENCY_PENALTY_MAX ? SOURCE_LATENCY_PENALTY_MAX : (int)lat;
+  if (e.hasValue)
+  {
+    unsigned long age = halMillis() - e.valueAt;
+    h -= age >= SOURCE_STALE_MS ? SOURCE_STALE_PENALTY : (int)(age * SOURCE_STALE_PENALTY / SOURCE_STALE_MS);
+  }
+  return h < 0 ? 0 : (uint8_t)h;
+}
+
+bool sourcePollDue(int src)
+{
+  if (src < 0)
+    return true;
+  SourceEntry &e = sources[src];
+  if (e.breaker == BREAKER_OPEN && probeDue(e, halMillis()))
+    e.breaker = BREAKER_HALF_OPEN; // probe until it succeeds or fails (a cancelled probe gives no verdict)
+  if (e.breaker != BREAKER_OPEN)
+    return true;
+  e.skipped++;
+  return false;
+}
+
+bool sourceProbeDue()
+{
+  unsigned long now = halMillis();
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    const SourceEntry &e = sources[i];
+    if (e.used && polled(e) && e.breaker == BREAKER_OPEN && probeDue(e, now))
+      return true;
+  }
+  return false;
+}
+
+bool sourceBreakersOpen()
+{
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    if (sources[i].used && polled(sources[i]) && sources[i].breaker == BREAKER_CLOSED)
+      return false;
+  }
+  return true;
+}
+
+BreakerState sourceBreaker(int src)
+{
+  return src < 0 ? BREAKER_CLOSED : (BreakerState)sources[src].breaker;
+}
+
+static int32_t divRound(int32_t num, int32_t den)
+{
+  return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+bool sourceFuse(int32_t &deci)
+{
+  unsigned long now = halMillis();
+  int best = -1;
+  uint8_t bestHealth = 0;
+  int32_t values[SOURCE_MAX];
+  int n = 0;
+  int32_t weighted = 0;
+  int32_t weights = 0;
+
+  for (int i = 0; i < SOURCE_MAX; i++)
+  {
+    const SourceEntry &e = sources[i];
+    if (!fresh(e, now))
+      continue;
+    uint8_t h = sourceHealth(i);
+    if (best < 0 || h > bestHealth || (h == bestHealth && (long)(e.valueAt - sources[best].valueAt) > 0))
+    {
+      best = i;
+      bestHealth = h;
+    }
+    if (h < SOURCE_HEALTHY)
+      continue;
+    // insertion sort for the median
+    int j = n++;
+    for (; j > 0 && values[j - 1] > e.deci; j--)
+      values[j] = values[j - 1];
+    values[j] = e.deci;
+    weighted += e.deci * h;
+    weights += h;
+  }
+  if (best < 0)
+    return false;
+
+  // median and weighted need healthy sources, else the best one it is
+  if (policy == FUSION_MEDIAN && n > 0)
+    deci = (n & 1) ? values[n / 2] : divRound(values[n / 2 - 1] + values[n / 2], 2);
+  else if (policy == FUSION_WEIGHTED && weights > 0)
+    deci = divRound(weighted, weights);
+  else
+    deci = sources[best].deci;
+  return true;
+}
+
+void sourceSetPolicy(FusionPolicy p)
+{
+  policy = p;
+}
+
+FusionPolicy sourceGetPolicy()
+{
+  return policy;
+}
+
+const char *sourcePolicyName(FusionPolicy p)
+{
+  return POLICY_NAMES[p];
+}
+
+bool sourcePolicyFromName(const char *name, FusionPolicy &p)
+{
+  for (int i = 0; i < FUSION_POLICY_COUNT; i++)
+  {
+    if (strcmp(name, POLICY_NAMES[i]) == 0)
+    {
+      p = (FusionPolicy)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool sourceInfo(int src, SourceInfo &info)
+{
+  if (src < 0 || src >= SOURCE_MAX || !sources[src].used)
+    return false;
+  const SourceEntry &e = sources[src];
+  unsigned long now = halMillis();
+  if (e.kind == SOURCE_HTTP || e.kind == SOURCE_UDP)
+    snprintf(info.name, sizeof(info.name), "%s%u", KIND_NAMES[e.kind], e.id);
+  else
+    snprintf(info.name, sizeof(info.name), "%s", KIND_NAMES[e.kind]);
+  info.health = sourceHealth(src);
+  info.ratePct = (uint8_t)(e.rate / 100);
+  info.latencyMs = e.latencyMs;
+  info.ageS = e.hasValue ? (long)((now - e.valueAt) / 1000) : -1L;
+  info.deci = e.deci;
+  info.readings = e.readings;
+  info.failures = e.failures;
+  info.skipped = e.skipped;
+  info.polled = polled(e);
+  info.breaker = (BreakerState)e.breaker;
+  info.probeS = e.breaker == BREAKER_OPEN && !probeDue(e, now) ? (long)(e.probeAt - now) / 1000 : 0;
+  return true;
+}
+
+const char *sourceBreakerName(BreakerState state)
+{
+  return BREAKER_NAMES[state];
+}
+
+size_t sourceReport(char *buf, size_t len)
+{
+  int32_t fused;
+  char fusedText[16] = "none";
+  if (sourceFuse(fused))
+    snprintf(fusedText, sizeof(fusedText), "%s%ld.%ld", fused < 0 ? "-" : "", (long)(fused < 0 ? -fused : fused) / 10,
+             (long)(fused < 0 ? -fused : fused) % 10);
+  size_t n = snprintf(buf, len, "policy %s, fused %s\n%-7s %6s %6s %7s %7s %6s %8s %8s %7s %7s %7s\n",
+                      sourcePolicyName(policy), fusedText, "source", "health", "rate%", "lat_ms", "age_s", "value",
+                      "readings", "failures", "skipped", "breaker", "probe_s");
+  SourceInfo s;
+  for (int i = 0; i < SOURCE_MAX && n < len; i++)
+  {
+    if (!sourceInfo(i, s))
+      continue;
+    long v = s.deci < 0 ? -s.deci : s.deci;
+    n += snprintf(buf + n, len - n, "%-7s %6u %6u %7lu %7ld %s%3ld.%ld %8lu %8lu %7lu %7s %7ld\n", s.name, s.health,
+                  s.ratePct, s.latencyMs, s.ageS, s.deci < 0 ? "-" : " ", v / 10, v % 10, s.readings, s.failures,
+                  s.skipped, s.polled ? BREAKER_NAMES[s.breaker] : "-", s.probeS);
+  }
+  return n < len ? n : len - 1;
+}
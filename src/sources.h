@@ -0,0 +1,117 @@
+// Sensor source registry: health of every way a reading arrives, and fusion of their values
+// Sources are the polled HTTP thermometers (fetch.h), UDP sensors by id, the MQTT subscription and
+// HTTP POST. Each keeps a rolling success rate, latency (polled sources) and the age of its last
+// value; together they give a health score. A fusion policy turns the fresh values of the healthy
+// sources into the displayed one.
+// Polled sources sit behind a circuit breaker: closed (polled every cycle), open after
+// SOURCE_BREAKER_FAILURES failures in a row (not polled, no timeout paid), half-open once the
+// jittered exponential backoff ran out (probe polls until one succeeds or fails).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum SourceKind
+{
+  SOURCE_HTTP, // id = SensorSource (fetch.h)
+  SOURCE_UDP,  // id = sensor id of the datagram
+  SOURCE_MQTT,
+  SOURCE_POST,
+  SOURCE_KIND_COUNT
+};
+
+enum FusionPolicy
+{
+  FUSION_BEST,     // value of the healthiest source, newest on a tie
+  FUSION_MEDIAN,   // median of the healthy sources
+  FUSION_WEIGHTED, // mean of the healthy sources weighted by health
+  FUSION_POLICY_COUNT
+};
+
+enum BreakerState
+{
+  BREAKER_CLOSED,
+  BREAKER_OPEN,
+  BREAKER_HALF_OPEN
+};
+
+const int SOURCE_MAX = 8;
+// values older than this are not fused (two missed polls at the longest poll interval)
+const unsigned long SOURCE_STALE_MS = 1200000;
+// health 0..100, sources below this are left out of median / weighted
+const uint8_t SOURCE_HEALTHY = 50;
+// breaker opens after this many failures in a row, backoff doubles per failed probe
+const uint8_t SOURCE_BREAKER_FAILURES = 3;
+const unsigned long SOURCE_BACKOFF_MIN = 30000;   // ms
+const unsigned long SOURCE_BACKOFF_MAX = 1800000; // ms
+// accepted readings, deci-degrees
+const int32_t SOURCE_MIN_DECI = -600;
+const int32_t SOURCE_MAX_DECI = 990;
+
+/// @brief Snapshot of one source, for reports and the JSON API
+struct SourceInfo
+{
+  char name[12]; // "http0", "udp3", "mqtt", "post"
+  uint8_t health;
+  uint8_t ratePct;
+  unsigned long latencyMs;
+  long ageS; // of the last value, -1 if none yet
+  int32_t deci;
+  unsigned long readings;
+  unsigned long failures;
+  unsigned long skipped; // polls skipped by an open breaker
+  bool polled;           // has a breaker
+  BreakerState breaker;
+  long probeS; // until the next probe of an open breaker
+};
+
+/// @brief Registry index of a source, registered on first use
+/// A full registry makes room by dropping the pushed source heard from longest ago; polled
+/// sources stay (register them at boot so pushed ones cannot take their slots first).
+/// @return -1 if the registry is full of polled sources
+int sourceFind(SourceKind kind, uint8_t id);
+
+/// @brief Source delivered a reading
+/// @param latencyMs  Request time of a polled source, 0 for pushed readings
+/// @return false if the value is out of range (counted as failure)
+bool sourceReading(int src, int32_t deci, unsigned long latencyMs);
+
+/// @brief Source failed to deliver (request failed, malformed payload)
+void sourceFailure(int src);
+
+/// @brief A source delivered after failing, since the last call
+bool sourceRecovered();
+
+/// @brief Health score 0..100: success rate, less latency and staleness penalties
+uint8_t sourceHealth(int src);
+
+/// @brief Polled source takes part in this poll cycle (call once per cycle): breaker closed or probing
+bool sourcePollDue(int src);
+
+/// @brief An open breaker's backoff ran out, time for a probe poll
+bool sourceProbeDue();
+
+/// @brief No polled source has a closed breaker (also true if none is registered)
+bool sourceBreakersOpen();
+
+BreakerState sourceBreaker(int src);
+
+/// @brief Snapshot of registry slot src (0..SOURCE_MAX-1)
+/// @return false if the slot is unused
+bool sourceInfo(int src, SourceInfo &info);
+const char *sourceBreakerName(BreakerState state);
+
+/// @brief Displayed value by the current policy
+/// @return false if no source has a fresh value
+bool sourceFuse(int32_t &deci);
+
+void sourceSetPolicy(FusionPolicy policy);
+FusionPolicy sourceGetPolicy();
+const char *sourcePolicyName(FusionPolicy policy);
+/// @return false if name is unknown
+bool sourcePolicyFromName(const char *name, FusionPolicy &policy);
+
+/// @brief Write registry as text
+/// @return Number of chars written
+size_t sourceReport(char *buf, size_t len);
@@ -0,0 +1,316 @@
+// Streaming reader for the thermometer JSON payload, see temp_json.h
+
+#include "temp_json.h"
+
+static const char TEMP_KEY[] = "temperature";
+const uint8_t TEMP_KEY_LEN = sizeof(TEMP_KEY) - 1;
+const uint8_t TEMP_JSON_MAX_DEPTH = 32;
+const uint8_t TEMP_JSON_MAX_DIGITS = 9; // fits uint32_t
+
+enum TempJsonState
+{
+  TJ_START,      // before top level '{'
+  TJ_BODY,       // between tokens
+  TJ_STRING,     // inside a string (key or value)
+  TJ_STRING_ESC, // after backslash
+  TJ_KEY,        // inside a top level key
+  TJ_KEY_ESC,
+  TJ_COLON,      // after "temperature", before ':'
+  TJ_VALUE,      // after ':', before the number
+  TJ_SIGN,       // after '-'
+  TJ_INT,
+  TJ_DOT,        // after '.', before first fraction digit
+  TJ_FRAC,
+  TJ_EXP_MARK,   // after 'e'
+  TJ_EXP_SIGN,   // after 'e+' / 'e-'
+  TJ_EXP
+};
+
+static bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/// @brief Characters that change state between tokens
+static bool isStructural(char c)
+{
+  return c == '"' || c == '{' || c == '}' || c == '[' || c == ']' || c == ',';
+}
+
+static TempJsonStatus fail(TempJsonParser &p)
+{
+  p.status = TEMP_JSON_ERROR;
+  return p.status;
+}
+
+void tempJsonInit(TempJsonParser &p)
+{
+  p.state = TJ_START;
+  p.depth = 0;
+  p.keyPos = 0;
+  p.keyMatch = false;
+  p.expectKey = false;
+  p.neg = false;
+  p.expNeg = false;
+  p.digits = 0;
+  p.scale = 0;
+  p.exp = 0;
+  p.mantissa = 0;
+  p.deci = 0;
+  p.status = TEMP_JSON_MORE;
+}
+
+static void numberDigit(TempJsonParser &p, char c, bool fraction)
+{
+  if (p.digits == 0 && c == '0')
+  {
+    if (fraction)
+      p.scale--; // leading zeros of a fraction only shift
+    return;
+  }
+  if (p.digits < TEMP_JSON_MAX_DIGITS)
+  {
+    p.mantissa = p.mantissa * 10 + (uint32_t)(c - '0');
+    p.digits++;
+    if (fraction)
+      p.scale--;
+  }
+  else if (!fraction)
+    p.scale++; // integer digits beyond precision still count
+}
+
+/// @brief Number complete: mantissa * 10^(scale + exp) -> deci-degrees, rounded half away from zero
+static TempJsonStatus numberDone(TempJsonParser &p)
+{
+  int pow10 = p.scale + (p.expNeg ? -p.exp : p.exp) + 1; // +1: degrees -> deci-degrees
+  uint64_t v = p.mantissa;
+
+  if (v != 0 && pow10 > 0)
+  {
+    for (; pow10 > 0; pow10--)
+    {
+      v *= 10;
+      if (v > (uint64_t)TEMP_JSON_MAX_DECI)
+        return fail(p);
+    }
+  }
+  else if (pow10 < 0)
+  {
+    if (pow10 < -10)
+      v = 0;
+    else
+    {
+      uint64_t div = 1;
+      for (; pow10 < 0; pow10++)
+        div *= 10;
+      v = (v + div / 2) / div;
+    }
+  }
+
+  if (v > (uint64_t)TEMP_JSON_MAX_DECI)
+    return fail(p);
+  p.deci = p.neg ? -(int32_t)v : (int32_t)v;
+  p.status = TEMP_JSON_FOUND;
+  return p.status;
+}
+
+static inline TempJsonStatus feed(TempJsonParser &p, const char *data, size_t len)
+{
+  for (size_t i = 0; i < len && p.status == TEMP_JSON_MORE; i++)
+  {
+    char c = data[i];
+    switch (p.state)
+    {
+    case TJ_START:
+      if (c == '{')
+      {
+        p.depth = 1;
+        p.expectKey = true;
+        p.state = TJ_BODY;
+      }
+      else if (!isSpace(c))
+        return fail(p);
+      break;
+
+    case TJ_BODY:
+      // skip numbers, literals and whitespace in one go
+      while (!isStructural(c) && i + 1 < len)
+        c = data[++i];
+      if (c == '"')
+      {
+        if (p.depth == 1 && p.expectKey)
+        {
+          p.keyPos = 0;
+          p.keyMatch = true;
+          p.state = TJ_KEY;
+        }
+        else
+          p.state = TJ_STRING;
+      }
+      else if (c == '{' || c == '[')
+      {
+        if (++p.depth > TEMP_JSON_MAX_DEPTH)
+          return fail(p);
+      }
+      else if (c == '}' || c == ']')
+      {
+        if (--p.depth == 0)
+          return fail(p); // top level object closed without the member
+      }
+      else if (c == ',' && p.depth == 1)
+        p.expectKey = true;
+      break;
+
+    case TJ_STRING:
+      while (c != '"' && c != '\\' && i + 1 < len)
+        c = data[++i];
+      if (c == '\\')
+        p.state = TJ_STRING_ESC;
+      else if (c == '"')
+        p.state = TJ_BODY;
+      break;
+
+    case TJ_STRING_ESC:
+      p.state = TJ_STRING;
+      break;
+
+    case TJ_KEY:
+      if (c == '"')
+      {
+        p.expectKey = false;
+        p.state = (p.keyMatch && p.keyPos == TEMP_KEY_LEN) ? TJ_COLON : TJ_BODY;
+      }
+      else if (c == '\\')
+      {
+        p.keyMatch = false; // escaped keys are never ours
+        p.state = TJ_KEY_ESC;
+      }
+      else if (p.keyMatch && p.keyPos < TEMP_KEY_LEN && c == TEMP_KEY[p.keyPos])
+        p.keyPos++;
+      else
+        p.keyMatch = false;
+      break;
+
+    case TJ_KEY_ESC:
+      p.state = TJ_KEY;
+      break;
+
+    case TJ_COLON:
+      if (c == ':')
+        p.state = TJ_VALUE;
+      else if (!isSpace(c))
+        return fail(p);
+      break;
+
+    case TJ_VALUE:
+      if (c == '-')
+      {
+        p.neg = true;
+        p.state = TJ_SIGN;
+      }
+      else if (isDigit(c))
+      {
+        numberDigit(p, c, false);
+        p.state = TJ_INT;
+      }
+      else if (!isSpace(c))
+        return fail(p); // string, null, object ...: not a reading
+      break;
+
+    case TJ_SIGN:
+      if (!isDigit(c))
+        return fail(p);
+      numberDigit(p, c, false);
+      p.state = TJ_INT;
+      break;
+
+    case TJ_INT:
+      if (isDigit(c))
+        numberDigit(p, c, false);
+      else if (c == '.')
+        p.state = TJ_DOT;
+      else if (c == 'e' || c == 'E')
+        p.state = TJ_EXP_MARK;
+      else if (isSpace(c) || c == ',' || c == '}')
+        return numberDone(p);
+      else
+        return fail(p);
+      break;
+
+    case TJ_DOT:
+      if (!isDigit(c))
+        return fail(p);
+      numberDigit(p, c, true);
+      p.state = TJ_FRAC;
+      break;
+
+    case TJ_FRAC:
+      if (isDigit(c))
+        numberDigit(p, c, true);
+      else if (c == 'e' || c == 'E')
+        p.state = TJ_EXP_MARK;
+      else if (isSpace(c) || c == ',' || c == '}')
+        return numberDone(p);
+      else
+        return fail(p);
+      break;
+
+    case TJ_EXP_MARK:
+      if (c == '-' || c == '+')
+      {
+        p.expNeg = c == '-';
+        p.state = TJ_EXP_SIGN;
+        break;
+      }
+      if (!isDigit(c))
+        return fail(p);
+      p.exp = c - '0';
+      p.state = TJ_EXP;
+      break;
+
+    case TJ_EXP_SIGN:
+      if (!isDigit(c))
+        return fail(p);
+      p.exp = c - '0';
+      p.state = TJ_EXP;
+      break;
+
+    case TJ_EXP:
+      if (isDigit(c))
+      {
+        if (p.exp > 99)
+          return fail(p);
+        p.exp = p.exp * 10 + (c - '0');
+      }
+      else if (isSpace(c) || c == ',' || c == '}')
+        return numberDone(p);
+      else
+        return fail(p);
+      break;
+    }
+  }
+  return p.status;
+}
+
+TempJsonStatus tempJsonFeed(TempJsonParser &parser, const char *data, size_t len)
+{
+  // work on a local copy: stores through the parser reference could alias the char input
+  // and would force the state back to memory on every byte
+  TempJsonParser p = parser;
+  feed(p, data, len);
+  parser = p;
+  return p.status;
+}
+
+TempJsonStatus tempJsonFinish(TempJsonParser &p)
+{
+  // a number needs its delimiter: "12" at the very end may be a cut off "125"
+  if (p.status == TEMP_JSON_MORE)
+    return fail(p);
+  return p.status;
+}
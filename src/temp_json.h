@@ -0,0 +1,44 @@
+// Streaming reader for the thermometer JSON payload
+// Fed with body chunks of any size as they come off the socket; stops at the top level
+// "temperature" member and yields it as integer deci-degrees. No heap, no buffering of the body.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// readings beyond +-10000.0 are rejected as garbage
+const int32_t TEMP_JSON_MAX_DECI = 100000;
+
+enum TempJsonStatus
+{
+  TEMP_JSON_MORE,  // feed more input
+  TEMP_JSON_FOUND, // deci holds the value, further input is ignored
+  TEMP_JSON_ERROR  // malformed, truncated or no numeric "temperature" member
+};
+
+struct TempJsonParser
+{
+  uint8_t state;
+  uint8_t depth;      // nesting level, 1 = top level object
+  uint8_t keyPos;     // chars of "temperature" matched so far
+  bool keyMatch;      // key string still matches
+  bool expectKey;     // next string at depth 1 is a key
+  bool neg;
+  bool expNeg;
+  uint8_t digits;     // significant mantissa digits kept
+  int16_t scale;      // power of ten applied to mantissa
+  int16_t exp;
+  uint32_t mantissa;
+  int32_t deci;
+  TempJsonStatus status;
+};
+
+/// @brief Reset parser for a new payload
+void tempJsonInit(TempJsonParser &p);
+
+/// @brief Feed next chunk of the payload
+TempJsonStatus tempJsonFeed(TempJsonParser &p, const char *data, size_t len);
+
+/// @brief End of payload: anything short of a delimited value is an error
+TempJsonStatus tempJsonFinish(TempJsonParser &p);
@@ -0,0 +1,293 @@
+// Benchmark and fuzz test of the streaming payload reader, see temp_json_bench.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+#include "pt_bench.h"
+#include "temp_json.h"
+#include "temp_json_bench.h"
+
+#if TEMP_JSON_BENCH_ENABLED
+
+const size_t BENCH_CHUNK = 64; // as read from the socket
+const size_t BENCH_LARGE = 8192;
+const size_t FUZZ_MAX = 1024;
+
+static char large[BENCH_LARGE + 64];
+static char copy[BENCH_LARGE + 64]; // stands in for the getString() heap copy
+static char fuzzBuf[FUZZ_MAX];
+static char fuzzMut[FUZZ_MAX];
+
+/// @brief xorshift32, deterministic on every platform
+static uint32_t rnd(uint32_t &s)
+{
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+/// @brief Feed in fixed chunks like the HTTP worker does
+static TempJsonStatus parseChunked(TempJsonParser &p, const char *data, size_t len, size_t chunk)
+{
+  tempJsonInit(p);
+  for (size_t off = 0; off < len; off += chunk)
+  {
+    if (tempJsonFeed(p, data + off, len - off < chunk ? len - off : chunk) != TEMP_JSON_MORE)
+      return p.status;
+  }
+  return tempJsonFinish(p);
+}
+
+/// @brief Old way: whole body in a buffer, strstr() + strtof()
+static float parseBuffered(const char *data, size_t len)
+{
+  memcpy(copy, data, len);
+  copy[len] = '\0';
+  const char *t = strstr(copy, "\"temperature\":");
+  return t ? strtof(t + 14, nullptr) : -101.0f;
+}
+
+/// @brief Payload of about size bytes with the temperature member first or last
+static size_t makeLarge(bool temperatureFirst, size_t size)
+{
+  size_t n = 0;
+  n += snprintf(large + n, sizeof(large) - n, "{");
+  if (temperatureFirst)
+    n += snprintf(large + n, sizeof(large) - n, "\"temperature\":-3.25,");
+  n += snprintf(large + n, sizeof(large) - n, "\"log\":[");
+  for (int i = 0; n + 64 < size; i++)
+    n += snprintf(large + n, sizeof(large) - n, "%s{\"t\":%d,\"msg\":\"sample \\\"%d\\\" ok\"}", i ? "," : "", i, i);
+  n += snprintf(large + n, sizeof(large) - n, "]");
+  if (!temperatureFirst)
+    n += snprintf(large + n, sizeof(large) - n, ",\"temperature\":-3.25");
+  n += snprintf(large + n, sizeof(large) - n, "}");
+  return n;
+}
+
+static size_t benchLine(char *buf, size_t len, const char *name, const char *data, size_t n, unsigned long iters)
+{
+  TempJsonParser p;
+  volatile int32_t sink = 0;
+  volatile float fsink = 0;
+
+  uint64_t t0 = benchNowNs();
+  for (unsigned long i = 0; i < iters; i++)
+  {
+    parseChunked(p, data, n, BENCH_CHUNK);
+    sink += p.deci;
+  }
+  uint64_t t1 = benchNowNs();
+  for (unsigned long i = 0; i < iters; i++)
+    fsink += parseBuffered(data, n);
+  uint64_t t2 = benchNowNs();
+  (void)sink;
+  (void)fsink;
+
+  unsigned long streamNs = (unsigned long)((t1 - t0) / iters);
+  unsigned long bufNs = (unsigned long)((t2 - t1) / iters);
+  return snprintf(buf, len, "%-16s %6u B %10lu %10lu %8u %8u\n", name, (unsigned)n, streamNs, bufNs,
+                  (unsigned)sizeof(TempJsonParser), (unsigned)(n + 1));
+}
+
+size_t tempJsonBenchmark(char *buf, size_t len)
+{
+  static const char small[] = "{\"temperature\":12.34,\"humidity\":61.4,\"uptime\":1234}";
+#ifdef ARDUINO
+  const unsigned long itersSmall = 2000, itersLarge = 20;
+#else
+  const unsigned long itersSmall = 200000, itersLarge = 2000;
+#endif
+
+  size_t n = snprintf(buf, len, "%-16s %8s %10s %10s %8s %8s\n", "payload", "size", "stream_ns", "buffer_ns",
+                      "stream_B", "buffer_B");
+  if (n < len)
+    n += benchLine(buf + n, len - n, "small", small, strlen(small), itersSmall);
+  size_t m = makeLarge(true, BENCH_LARGE);
+  if (n < len)
+    n += benchLine(buf + n, len - n, "large, temp 1st", large, m, itersLarge);
+  m = makeLarge(false, BENCH_LARGE);
+  if (n < len)
+    n += benchLine(buf + n, len - n, "large, temp last", large, m, itersLarge);
+  return n < len ? n : len - 1;
+}
+
+// ===== Fuzzing =====
+
+/// @brief Append random JSON value (nesting limited)
+static size_t randomValue(char *b, size_t n, size_t cap, uint32_t &s, int depth)
+{
+  static const char *const words[] = {"temperature", "temperatur", "temperatures", "Temperature", "t\\u0065mp",
+                                      "humidity", "\\\"temperature\\\"", ""};
+  switch (rnd(s) % (depth < 3 ? 7 : 4))
+  {
+  case 0:
+    return n + snprintf(b + n, cap - n, "%d", (int)(rnd(s) % 20001) - 10000);
+  case 1:
+    return n + snprintf(b + n, cap - n, "\"%s\"", words[rnd(s) % 8]);
+  case 2:
+    return n + snprintf(b + n, cap - n, "%s", rnd(s) & 1 ? "null" : "true");
+  case 3:
+    return n + snprintf(b + n, cap - n, "%d.%02de%d", (int)(rnd(s) % 100), (int)(rnd(s) % 100), (int)(rnd(s) % 5));
+  case 4:
+  case 5:
+  {
+    // nested object, may hold a "temperature" that must not count
+    n += snprintf(b + n, cap - n, "{");
+    int k = rnd(s) % 3;
+    for (int i = 0; i < k && n + 64 < cap; i++)
+    {
+      n += snprintf(b + n, cap - n, "%s\"%s\":", i ? "," : "", words[rnd(s) % 8]);
+      n = randomValue(b, n, cap, s, depth + 1);
+    }
+    return n + snprintf(b + n, cap - n, "}");
+  }
+  default:
+  {
+    n += snprintf(b + n, cap - n, "[");
+    int k = rnd(s) % 4;
+    for (int i = 0; i < k && n + 64 < cap; i++)
+    {
+      n += snprintf(b + n, cap - n, "%s", i ? "," : "");
+      n = randomValue(b, n, cap, s, depth + 1);
+    }
+    return n + snprintf(b + n, cap - n, "]");
+  }
+  }
+}
+
+/// @brief Expected reading in centi-degrees written in one of several number forms
+static size_t writeReading(char *b, size_t n, size_t cap, uint32_t &s, int32_t centi)
+{
+  const char *sign = centi < 0 ? "-" : "";
+  int32_t a = centi < 0 ? -centi : centi;
+  switch (rnd(s) % 5)
+  {
+  case 0:
+    return n + snprintf(b + n, cap - n, "%s%d.%02d", sign, (int)(a / 100), (int)(a % 100));
+  case 1:
+    return n + snprintf(b + n, cap - n, "%s%de-2", sign, (int)a);
+  case 2:
+    return n + snprintf(b + n, cap - n, "%s%d.%d%02dE1", sign, (int)(a / 1000), (int)(a / 100 % 10), (int)(a % 100));
+  case 3:
+    return n + snprintf(b + n, cap - n, "%s%d.%02d000000000001", sign, (int)(a / 100), (int)(a % 100));
+  default:
+    return n + snprintf(b + n, cap - n, "%s0%d.%02d0", sign, (int)(a / 100), (int)(a % 100));
+  }
+}
+
+/// @brief Parse whole, byte by byte and in random chunks; all must agree
+static bool chunkingAgrees(const char *data, size_t len, uint32_t &s, TempJsonParser &whole)
+{
+  TempJsonParser p;
+  parseChunked(whole, data, len, len ? len : 1);
+  parseChunked(p, data, len, 1);
+  if (p.status != whole.status || (whole.status == TEMP_JSON_FOUND && p.deci != whole.deci))
+    return false;
+
+  tempJsonInit(p);
+  for (size_t off = 0; off < len && p.status == TEMP_JSON_MORE;)
+  {
+    size_t k = 1 + rnd(s) % 17;
+    if (k > len - off)
+      k = len - off;
+    tempJsonFeed(p, data + off, k);
+    off += k;
+  }
+  tempJsonFinish(p);
+  return p.status == whole.status && (whole.status != TEMP_JSON_FOUND || p.deci == whole.deci);
+}
+
+bool tempJsonFuzz(unsigned long iterations, uint32_t seed, char *report, size_t len)
+{
+  uint32_t s = seed ? seed : 1;
+  unsigned long valid = 0, absent = 0, mutated = 0, found = 0, rejected = 0;
+  TempJsonParser whole;
+
+  for (unsigned long it = 0; it < iterations; it++)
+  {
+    // well-formed object, reading at a random position or missing
+    int members = rnd(s) % 6;
+    int at = (rnd(s) % 4 == 0) ? -1 : (int)(rnd(s) % (members + 1));
+    int32_t centi = (int32_t)(rnd(s) % 19999) - 9999;
+    size_t n = snprintf(fuzzBuf, FUZZ_MAX, "%s{", rnd(s) & 1 ? " \r\n" : "");
+    for (int i = 0; i <= members && n + 160 < FUZZ_MAX; i++)
+    {
+      n += snprintf(fuzzBuf + n, FUZZ_MAX - n, "%s", (n > 1 && fuzzBuf[n - 1] != '{') ? " , " : "");
+      if (i == at)
+      {
+        n += snprintf(fuzzBuf + n, FUZZ_MAX - n, "\"temperature\" : ");
+        n = writeReading(fuzzBuf, n, FUZZ_MAX, s, centi);
+      }
+      else if (i < members)
+      {
+        n += snprintf(fuzzBuf + n, FUZZ_MAX - n, "\"k%d\":", i);
+        n = randomValue(fuzzBuf, n, FUZZ_MAX - 160, s, 0);
+      }
+    }
+    // trailing comma after the last member is avoided by the n > 1 check only for the first one
+    if (fuzzBuf[n - 1] == ' ' && fuzzBuf[n - 2] == ',')
+      n -= 3;
+    n += snprintf(fuzzBuf + n, FUZZ_MAX - n, "}");
+
+    if (!chunkingAgrees(fuzzBuf, n, s, whole))
+      return snprintf(report, len, "FAIL chunking: %.*s\n", (int)n, fuzzBuf), false;
+
+    int32_t a = centi < 0 ? -centi : centi;
+    int32_t expect = (a + 5) / 10 * (centi < 0 ? -1 : 1);
+    bool ok = at < 0 ? whole.status == TEMP_JSON_ERROR
+                     : (whole.status == TEMP_JSON_FOUND && whole.deci == expect);
+    if (!ok)
+      return snprintf(report, len, "FAIL value (want %ld): %.*s\n", (long)(at < 0 ? -1 : expect), (int)n, fuzzBuf),
+             false;
+    if (at < 0)
+      absent++;
+    else
+      valid++;
+
+    // corrupted copy: flips, cuts, inserted junk; only agreement and range are checked
+    size_t m = n;
+    memcpy(fuzzMut, fuzzBuf, n);
+    int edits = 1 + rnd(s) % 4;
+    for (int e = 0; e < edits && m > 0; e++)
+    {
+      size_t pos = rnd(s) % m;
+      switch (rnd(s) % 3)
+      {
+      case 0:
+        fuzzMut[pos] = (char)(rnd(s) & 0xff);
+        break;
+      case 1:
+        m = pos; // truncate
+        break;
+      default:
+        if (m < FUZZ_MAX)
+        {
+          memmove(fuzzMut + pos + 1, fuzzMut + pos, m - pos);
+          fuzzMut[pos] = "{}[]\",:\\-.e0"[rnd(s) % 12];
+          m++;
+        }
+        break;
+      }
+    }
+    mutated++;
+    if (!chunkingAgrees(fuzzMut, m, s, whole))
+      return snprintf(report, len, "FAIL chunking (mutated): %.*s\n", (int)m, fuzzMut), false;
+    if (whole.status == TEMP_JSON_FOUND)
+    {
+      found++;
+      if (whole.deci > TEMP_JSON_MAX_DECI || whole.deci < -TEMP_JSON_MAX_DECI)
+        return snprintf(report, len, "FAIL range: %.*s\n", (int)m, fuzzMut), false;
+    }
+    else
+      rejected++;
+  }
+
+  snprintf(report, len, "fuzz ok: %lu valid, %lu without reading, %lu corrupted (%lu still read, %lu rejected)\n",
+           valid, absent, mutated, found, rejected);
+  return true;
+}
+
+#endif
@@ -0,0 +1,25 @@
+// Benchmark and fuzz test of the streaming payload reader (temp_json.h)
+// Benchmark runs from serial ('j') on device or with --bench-json on host;
+// fuzzing only on host (--fuzz-json N[:SEED]).
+// Off by default, the buffers cost about 18 KB of RAM; [env:native] turns it on, a device build
+// can with -DTEMP_JSON_BENCH_ENABLED=1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef TEMP_JSON_BENCH_ENABLED
+#define TEMP_JSON_BENCH_ENABLED 0
+#endif
+
+#if TEMP_JSON_BENCH_ENABLED
+/// @brief Streaming reader vs buffered strstr() + strtof() on small and large payloads
+/// @return Number of chars written
+size_t tempJsonBenchmark(char *buf, size_t len);
+
+/// @brief Random well-formed, near-miss and corrupted payloads split at random chunk boundaries.
+/// Checks expected values, chunking invariance and range.
+/// @return true if all cases passed, report holds counts and the first failing payload
+bool tempJsonFuzz(unsigned long iterations, uint32_t seed, char *report, size_t len);
+#endif
@@ -0,0 +1,91 @@
+// Latency trace points, see trace.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+struct TraceHist
+{
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t buckets[TRACE_BUCKETS];
+};
+
+static const char *const TRACE_NAMES[TRACE_COUNT] = {"loop", "webPoll", "wifi", "fetch", "sendFrame",
+                                                            "pushLatch"};
+
+static TraceHist hist[TRACE_COUNT];
+static uint32_t cyclesPerUs = 160;
+
+void traceInit()
+{
+  cyclesPerUs = halCyclesPerUs();
+  if (cyclesPerUs == 0)
+    cyclesPerUs = 1;
+}
+
+void traceRecord(TraceId id, uint32_t cycles)
+{
+  uint32_t us = cycles / cyclesPerUs;
+  TraceHist &h = hist[id];
+
+  int b = 0;
+  for (uint32_t v = us >> 1; v != 0 && b < TRACE_BUCKETS - 1; v >>= 1)
+    b++;
+
+  h.buckets[b]++;
+  h.count++;
+  h.totalUs += us;
+  if (us > h.maxUs)
+    h.maxUs = us;
+}
+
+void traceReset()
+{
+  memset(hist, 0, sizeof(hist));
+}
+
+size_t traceReport(char *buf, size_t len)
+{
+  size_t n = snprintf(buf, len, "%-13s %8s %10s %10s  buckets [>=us:count]\n", "name", "count", "avg_us", "max_us");
+
+  for (int i = 0; i < TRACE_COUNT && n < len; i++)
+  {
+    const TraceHist &h = hist[i];
+    n += snprintf(buf + n, len - n, "%-13s %8lu %10lu %10lu ", TRACE_NAMES[i], (unsigned long)h.count,
+                  (unsigned long)(h.count ? h.totalUs / h.count : 0), (unsigned long)h.maxUs);
+    for (int b = 0; b < TRACE_BUCKETS && n < len; b++)
+    {
+      if (h.buckets[b])
+        n += snprintf(buf + n, len - n, " %lu:%lu", b ? 1UL << b : 0UL, (unsigned long)h.buckets[b]);
+    }
+    if (n < len)
+      n += snprintf(buf + n, len - n, "\n");
+  }
+  return n < len ? n : len - 1;
+}
+
+bool traceSerialCommand(int c)
+{
+  if (c == 't')
+  {
+    char buf[1536];
+    traceReport(buf, sizeof(buf));
+    halSerialWrite(buf);
+    return true;
+  }
+  if (c == 'r')
+  {
+    traceReset();
+    halLog("trace reset\n");
+    return true;
+  }
+  return false;
+}
+
+#endif
@@ -0,0 +1,71 @@
+// Latency trace points
+// Cycle-counter based scope timers with fixed log2 histograms and max tracking per subsystem.
+// Set TRACE_ENABLED to 0 to compile all trace points out.
+
+#pragma once
+
+#include "hal.h"
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// traced subsystems
+enum TraceId
+{
+  TRACE_LOOP,          // whole loop() iteration
+  TRACE_HANDLE_CLIENT, // webPoll()
+  TRACE_WIFI,          // WiFi manager tasks
+  TRACE_FETCH,         // sensor fetch, start to first valid reading
+  TRACE_SEND_FRAME,    // sendFrame() bus write
+  TRACE_PUSH_LATCH,    // pushed reading received -> frame on the panel
+  TRACE_COUNT
+};
+
+// histogram bucket i counts durations in [2^i, 2^(i+1)) us, last bucket is open ended
+const int TRACE_BUCKETS = 24;
+
+#if TRACE_ENABLED
+
+/// @brief Initialize cycle -> us conversion
+void traceInit();
+
+/// @brief Record one duration
+/// @param id      Subsystem
+/// @param cycles  Duration in CPU cycles
+void traceRecord(TraceId id, uint32_t cycles);
+
+/// @brief Reset all histograms
+void traceReset();
+
+/// @brief Write all histograms as text
+/// @param buf  Output buffer
+/// @param len  Buffer size
+/// @return Number of chars written
+size_t traceReport(char *buf, size_t len);
+
+/// @brief Handle serial command: 't' prints report, 'r' resets
+/// @return true if command was handled
+bool traceSerialCommand(int c);
+
+/// @brief RAII scope timer
+struct TraceScope
+{
+  TraceId id;
+  uint32_t start;
+  explicit TraceScope(TraceId i) : id(i), start(halCycles()) {}
+  ~TraceScope() { traceRecord(id, halCycles() - start); }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(id) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(id)
+
+#else
+
+#define TRACE_SCOPE(id) \
+  do                    \
+  {                     \
+  } while (0)
+
+#endif
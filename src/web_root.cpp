@@ -0,0 +1,104 @@
+// Root page served from flash, see web_root.h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "web_root.h"
+#include "web_server.h"
+#include "web_root_data.h"
+
+// CRC-32 (reflected 0xEDB88320) a nibble at a time
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL};
+
+static uint32_t crcRegister(uint32_t reg, const char *data, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    reg ^= (uint8_t)data[i];
+    reg = (reg >> 4) ^ CRC_NIBBLE[reg & 15];
+    reg = (reg >> 4) ^ CRC_NIBBLE[reg & 15];
+  }
+  return reg;
+}
+
+static void putLe32(uint8_t *p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+void webRootValue(float temp, bool gzip, WebRootValue &v)
+{
+  int n = snprintf(v.text, sizeof(v.text), "%.2f", temp);
+  v.len = n < 0 ? 0 : ((size_t)n < sizeof(v.text) ? (size_t)n : sizeof(v.text) - 1);
+  v.plainLength = WEB_ROOT_LEN_HEAD + v.len + WEB_ROOT_LEN_TAIL;
+  v.gzLength = sizeof(WEB_ROOT_GZ_HEAD) + sizeof(v.stored) + v.len + sizeof(WEB_ROOT_GZ_TAIL) + sizeof(v.trailer);
+  if (!gzip)
+    return;
+
+  // stored block (not final): header bits padded to the byte, LEN, NLEN
+  v.stored[0] = 0;
+  v.stored[1] = (uint8_t)v.len;
+  v.stored[2] = 0;
+  v.stored[3] = (uint8_t)~v.len;
+  v.stored[4] = 0xFF;
+
+  // CRC over head | value | tail: the tail's share is the register advanced over its length
+  uint32_t reg = crcRegister(WEB_ROOT_CRC_HEAD, v.text, v.len);
+  uint32_t crc = WEB_ROOT_CRC_TAIL;
+  for (int k = 0; k < 8; k++)
+    crc ^= WEB_ROOT_CRC_SHIFT[k][reg >> (4 * k) & 15];
+  putLe32(v.trailer, ~crc);
+  putLe32(v.trailer + 4, v.plainLength);
+}
+
+size_t webRootWrite(const WebRootValue &v, bool gzip, WebRootSink sink)
+{
+  // the head straight from flash, the rest gathered so the page goes out in two pieces
+  uint8_t rest[sizeof(v.stored) + WEB_ROOT_VALUE_MAX + sizeof(WEB_ROOT_GZ_TAIL) + sizeof(v.trailer)];
+  size_t n = 0;
+  if (gzip)
+  {
+    sink(WEB_ROOT_GZ_HEAD, sizeof(WEB_ROOT_GZ_HEAD), true);
+    memcpy(rest + n, v.stored, sizeof(v.stored));
+    n += sizeof(v.stored);
+    memcpy(rest + n, v.text, v.len);
+    n += v.len;
+    memcpy(rest + n, WEB_ROOT_GZ_TAIL, sizeof(WEB_ROOT_GZ_TAIL));
+    n += sizeof(WEB_ROOT_GZ_TAIL);
+    memcpy(rest + n, v.trailer, sizeof(v.trailer));
+    n += sizeof(v.trailer);
+    sink(rest, n, false);
+    return sizeof(WEB_ROOT_GZ_HEAD) + n;
+  }
+
+  sink(WEB_ROOT_PLAIN_HEAD, WEB_ROOT_LEN_HEAD, true);
+  sink(v.text, v.len, false);
+  sink(WEB_ROOT_PLAIN_TAIL, WEB_ROOT_LEN_TAIL, true);
+  return v.plainLength;
+}
+
+/// @brief Flash pieces are sent in place, the rest is copied into the connection
+static void responseSink(const void *data, size_t len, bool flash)
+{
+  if (flash)
+    webSendStatic(data, len);
+  else
+    webSendContent(data, len);
+}
+
+void webRootSend(float temp)
+{
+  char accept[64];
+  bool gzip = webHeader("Accept-Encoding", accept, sizeof(accept)) && strstr(accept, "gzip") != nullptr;
+  WebRootValue v;
+  webRootValue(temp, gzip, v);
+  webSendHeader("Vary", "Accept-Encoding");
+  if (gzip)
+    webSendHeader("Content-Encoding", "gzip");
+  webSendSized(200, "text/html", gzip ? v.gzLength : v.plainLength);
+  webRootWrite(v, gzip, responseSink);
+}
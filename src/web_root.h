@@ -0,0 +1,36 @@
+// Root page served from flash, no heap
+// tools/gen_web.py turns web/root.html into pre-gzipped pieces around the temperature
+// (web_root_data.h, regenerated on every PlatformIO build). At runtime the value is spliced in as
+// a stored deflate block and the gzip CRC is completed from generated tables; the page is never
+// assembled in RAM. Clients without gzip get the plain pieces.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const size_t WEB_ROOT_VALUE_MAX = 12;
+
+/// @brief Runtime parts of the page for one value
+struct WebRootValue
+{
+  char text[WEB_ROOT_VALUE_MAX];
+  size_t len;
+  uint8_t stored[5];  // stored block header for text
+  uint8_t trailer[8]; // gzip CRC-32 and size
+  size_t gzLength;    // whole gzip response
+  size_t plainLength; // whole plain response
+};
+
+/// @brief Format value and lengths; for gzip also the stored block header and trailer
+void webRootValue(float temp, bool gzip, WebRootValue &v);
+
+/// @brief Where the page pieces go; flash pieces outlive the call and need not be copied
+typedef void (*WebRootSink)(const void *data, size_t len, bool flash);
+
+/// @brief Write the page through sink, in the pieces the response is sent in
+/// @return Bytes written
+size_t webRootWrite(const WebRootValue &v, bool gzip, WebRootSink sink);
+
+/// @brief Serve the page for the current request, gzipped if the client accepts it
+void webRootSend(float temp);
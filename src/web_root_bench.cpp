@@ -0,0 +1,101 @@
+// Benchmark of the root page, see web_root_bench.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+#include "pt_bench.h"
+#include "web_root.h"
+#include "web_root_bench.h"
+
+#if WEB_ROOT_BENCH_ENABLED
+
+#include "web_root_data.h"
+
+const int BENCH_LIVE = 16; // unrelated allocations alive at any time
+
+static char socketBuf[2048]; // stands in for the socket send buffer
+static size_t socketLen;
+
+static void socketWrite(const void *data, size_t len, bool flash)
+{
+  (void)flash;
+  if (socketLen + len > sizeof(socketBuf))
+    socketLen = 0;
+  memcpy(socketBuf + socketLen, data, len);
+  socketLen += len;
+}
+
+/// @brief Old way: whole page by snprintf on the stack, copied to a String by WebServer::send()
+static size_t oldPage(float temp)
+{
+  char html[1536];
+  int n = snprintf(html, sizeof(html), "%s%.2f%s", WEB_ROOT_PLAIN_HEAD, temp, WEB_ROOT_PLAIN_TAIL);
+  char *copy = (char *)malloc(n + 1);
+  if (copy == nullptr)
+    return 0;
+  memcpy(copy, html, n + 1);
+  socketWrite(copy, n, false);
+  free(copy);
+  return n;
+}
+
+static size_t newPage(float temp, bool gzip)
+{
+  WebRootValue v;
+  webRootValue(temp, gzip, v);
+  return webRootWrite(v, gzip, socketWrite);
+}
+
+/// @brief Pages of one kind with unrelated allocations in between, heap stats at the end
+static size_t benchLine(char *buf, size_t len, const char *name, int kind, unsigned long iters)
+{
+  void *live[BENCH_LIVE] = {};
+  uint32_t s = 1;
+  size_t bytes = 0;
+  uint64_t busyNs = 0;
+  for (unsigned long i = 0; i < iters; i++)
+  {
+    s = s * 1103515245UL + 12345UL;
+    free(live[i % BENCH_LIVE]);
+    live[i % BENCH_LIVE] = malloc(32 + (s >> 16) % 480);
+
+    float temp = (float)(int)(i % 400 - 200) / 10.0f;
+    uint64_t t0 = benchNowNs();
+    bytes = kind == 0 ? oldPage(temp) : newPage(temp, kind == 1);
+    busyNs += benchNowNs() - t0;
+  }
+  size_t freeBytes = 0, largest = 0, minFree = 0;
+  bool heap = halHeapStats(freeBytes, largest, minFree);
+  for (int i = 0; i < BENCH_LIVE; i++)
+    free(live[i]);
+
+  unsigned long ns = (unsigned long)(busyNs / iters);
+  int n = snprintf(buf, len, "%-12s %6u B %8lu %8lu %6s", name, (unsigned)bytes, ns, ns ? 1000000000UL / ns : 0,
+                   kind == 0 ? "1" : "0");
+  if (n >= 0 && (size_t)n < len)
+    n += heap ? snprintf(buf + n, len - n, " %8u %8u\n", (unsigned)freeBytes, (unsigned)largest)
+              : snprintf(buf + n, len - n, " %8s %8s\n", "-", "-");
+  return n < 0 ? 0 : (size_t)n;
+}
+
+size_t webRootBenchmark(char *buf, size_t len)
+{
+#ifdef ARDUINO
+  const unsigned long iters = 500;
+#else
+  const unsigned long iters = 200000;
+#endif
+  size_t n = snprintf(buf, len, "%-12s %8s %8s %8s %6s %8s %8s\n", "page", "size", "ns/page", "pages/s", "allocs",
+                      "heap", "largest");
+  if (n < len)
+    n += benchLine(buf + n, len - n, "snprintf+copy", 0, iters);
+  if (n < len)
+    n += benchLine(buf + n, len - n, "flash gzip", 1, iters);
+  if (n < len)
+    n += benchLine(buf + n, len - n, "flash plain", 2, iters);
+  return n < len ? n : len - 1;
+}
+
+#endif
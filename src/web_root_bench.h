@@ -0,0 +1,20 @@
+// Benchmark of the root page (web_root.h): old snprintf + heap copy vs pieces from flash
+// Runs from serial ('w') on device or with --bench-web on host. Heap numbers only on device.
+// Off by default (2 KB socket buffer); [env:native] turns it on, a device build can with
+// -DWEB_ROOT_BENCH_ENABLED=1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef WEB_ROOT_BENCH_ENABLED
+#define WEB_ROOT_BENCH_ENABLED 0
+#endif
+
+#if WEB_ROOT_BENCH_ENABLED
+/// @brief Time per page, bytes on the wire, heap allocations, and free / largest heap block after
+/// a run with unrelated allocations in between (as WiFi and lwIP make them)
+/// @return Number of chars written
+size_t webRootBenchmark(char *buf, size_t len);
+#endif
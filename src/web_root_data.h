@@ -0,0 +1,123 @@
+// Generated by tools/gen_web.py from web/root.html, do not edit
+// Included by web_root.cpp and web_root_bench.cpp. Const data stays in flash on the ESP32.
+
+#pragma once
+
+#include <stdint.h>
+
+// gzip header + deflated text before the value, ends on a full flush
+static const uint8_t WEB_ROOT_GZ_HEAD[478] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x9c, 0x92, 0x4d, 0x8f, 0x9c, 0x30,
+  0x0c, 0x86, 0xff, 0x0a, 0xd5, 0x1e, 0x68, 0xa5, 0x61, 0x06, 0xd8, 0xd9, 0xed, 0x28, 0xc0, 0x48,
+  0x55, 0xdb, 0xf3, 0xf6, 0xb0, 0x97, 0xaa, 0xea, 0xc1, 0x24, 0x06, 0xac, 0x42, 0x82, 0x92, 0x30,
+  0x1f, 0x1d, 0xcd, 0x7f, 0xaf, 0x81, 0xd9, 0xd5, 0x22, 0xb5, 0x97, 0x2a, 0x52, 0x12, 0x5b, 0xf6,
+  0x63, 0xbf, 0x89, 0xf3, 0x77, 0x5f, 0x9e, 0x3e, 0x3f, 0x7f, 0xff, 0xf6, 0x35, 0x68, 0x7c, 0xd7,
+  0xee, 0xf3, 0xdb, 0x8e, 0xa0, 0xf6, 0x79, 0x87, 0x1e, 0x02, 0xd9, 0x80, 0x75, 0xe8, 0x8b, 0x70,
+  0xf0, 0x55, 0xb4, 0x0b, 0x6f, 0x5e, 0x0d, 0x1d, 0x16, 0xe1, 0x81, 0xf0, 0xd8, 0x1b, 0xeb, 0xc3,
+  0x40, 0x1a, 0xed, 0x51, 0x73, 0xd4, 0x91, 0x94, 0x6f, 0x0a, 0x85, 0x07, 0x92, 0x18, 0x4d, 0xc6,
+  0x2a, 0x20, 0x4d, 0x9e, 0xa0, 0x8d, 0x9c, 0x84, 0x16, 0x8b, 0x64, 0x1d, 0x33, 0xc5, 0x93, 0x6f,
+  0x71, 0xff, 0x34, 0x78, 0x65, 0x8c, 0x0d, 0x9e, 0xb1, 0xeb, 0xf3, 0xcd, 0xec, 0xcb, 0x9d, 0x3f,
+  0xf3, 0x51, 0x1a, 0x75, 0xbe, 0x54, 0x8c, 0x8d, 0x2a, 0xe8, 0xa8, 0x3d, 0x8b, 0x4f, 0x96, 0x19,
+  0x2b, 0x07, 0xda, 0x45, 0x0e, 0x2d, 0x55, 0x59, 0x09, 0xf2, 0x57, 0x6d, 0xcd, 0xa0, 0x95, 0xb8,
+  0xab, 0xd2, 0x71, 0x65, 0x1d, 0xd8, 0x9a, 0xb4, 0x88, 0xb3, 0x1e, 0x94, 0x22, 0x5d, 0xf3, 0xed,
+  0xba, 0x96, 0x60, 0xd5, 0xa5, 0x83, 0xd3, 0xdc, 0x8e, 0xb8, 0x7f, 0x8c, 0xfb, 0xd3, 0x4b, 0xe4,
+  0x96, 0xef, 0x01, 0x0c, 0xde, 0x2c, 0x69, 0x55, 0xf5, 0x4a, 0x48, 0xc7, 0xe8, 0xd2, 0x58, 0x85,
+  0x36, 0xb2, 0xa0, 0x68, 0x70, 0x22, 0x49, 0x27, 0xd7, 0x29, 0x72, 0x0d, 0x28, 0x73, 0x14, 0x71,
+  0xb0, 0x65, 0x4a, 0x32, 0xa2, 0x6c, 0x5d, 0xc2, 0xfb, 0x78, 0x35, 0xae, 0x75, 0xf2, 0x21, 0xbb,
+  0x36, 0xe9, 0xc5, 0xe3, 0xc9, 0x47, 0xd0, 0x52, 0xad, 0x85, 0xe4, 0x27, 0x42, 0x7b, 0xab, 0x1d,
+  0x79, 0xd3, 0x4f, 0xfd, 0x79, 0x16, 0x3f, 0x2b, 0x75, 0xf4, 0x1b, 0xc5, 0x76, 0xc7, 0xf4, 0x7f,
+  0x25, 0x4d, 0xed, 0x04, 0x9c, 0x55, 0x19, 0xdb, 0x5d, 0x14, 0xb9, 0xbe, 0x85, 0xb3, 0xa8, 0x5a,
+  0x3c, 0x65, 0xe3, 0x16, 0x29, 0xb2, 0x28, 0x3d, 0x19, 0x4e, 0x33, 0xed, 0xd0, 0xe9, 0xac, 0x86,
+  0x5e, 0x24, 0x0f, 0x4c, 0xbc, 0x92, 0xee, 0x07, 0xff, 0xc3, 0x9f, 0x7b, 0x2c, 0xf4, 0xd0, 0x95,
+  0x68, 0x7f, 0xbe, 0x29, 0x3a, 0xa9, 0x7c, 0x91, 0x7c, 0xd3, 0xf7, 0x56, 0xf2, 0xee, 0xd5, 0x23,
+  0x12, 0x6e, 0xc0, 0x99, 0x96, 0x54, 0x70, 0x27, 0xa5, 0x5c, 0x70, 0xdd, 0x50, 0x76, 0xe4, 0xff,
+  0x93, 0xab, 0x8d, 0xc6, 0xc5, 0x2f, 0xc4, 0xf1, 0xc7, 0x92, 0x3f, 0x82, 0x85, 0x18, 0x2b, 0x8e,
+  0x0d, 0x79, 0xcc, 0xe4, 0x60, 0x1d, 0x1b, 0xbd, 0xa1, 0xe9, 0x4d, 0xfe, 0x52, 0x5b, 0x00, 0xcb,
+  0x3f, 0xe0, 0x65, 0x09, 0x7a, 0x78, 0x2c, 0xef, 0xb3, 0x6b, 0xbe, 0x99, 0x47, 0x2b, 0xdf, 0xcc,
+  0xf3, 0x3d, 0x8e, 0xd8, 0x3e, 0x57, 0x74, 0x08, 0x64, 0x0b, 0xce, 0x15, 0xe1, 0x38, 0x29, 0x3c,
+  0x9b, 0x4d, 0xba, 0x18, 0x4c, 0xb4, 0xe0, 0x07, 0x8b, 0x9c, 0x95, 0x2e, 0xa2, 0xc7, 0x7f, 0xe3,
+  0x68, 0xd7, 0x83, 0x0e, 0x48, 0xb1, 0x1d, 0xee, 0xff, 0x00, 0x00, 0x00, 0xff, 0xff,
+};
+
+// deflated text after the value, independent of the head, final block
+static const uint8_t WEB_ROOT_GZ_TAIL[272] = {
+  0x5d, 0x8f, 0xcd, 0x4e, 0xc3, 0x30, 0x10, 0x84, 0x5f, 0xc5, 0x27, 0x1c, 0x4b, 0x10, 0x03, 0xb7,
+  0xaa, 0x8e, 0x0f, 0x54, 0x45, 0xea, 0x99, 0x27, 0x70, 0xe3, 0x4d, 0x63, 0x14, 0xff, 0x60, 0xaf,
+  0xab, 0x44, 0x51, 0xdf, 0x1d, 0x1b, 0x2a, 0xa0, 0xf8, 0xe2, 0x59, 0x69, 0x66, 0xf6, 0x5b, 0xc1,
+  0x53, 0x50, 0x4e, 0x92, 0x3b, 0x0d, 0xa7, 0xed, 0x4e, 0x70, 0x6d, 0xce, 0x52, 0x0c, 0x3e, 0x5a,
+  0xa2, 0x7a, 0x34, 0xde, 0x75, 0x94, 0x27, 0x40, 0x2a, 0x85, 0x71, 0x21, 0x23, 0xc1, 0x25, 0x40,
+  0x47, 0x5d, 0xb6, 0x47, 0x88, 0x94, 0x38, 0x65, 0xcb, 0x84, 0x60, 0x03, 0x25, 0xd6, 0x14, 0xef,
+  0xc3, 0x66, 0x53, 0x94, 0x9a, 0x3b, 0x5a, 0x45, 0x98, 0x54, 0x0f, 0xa3, 0x9f, 0x34, 0xc4, 0x8e,
+  0xee, 0x1d, 0x42, 0x24, 0xd5, 0x0b, 0x51, 0x61, 0x8e, 0x40, 0x49, 0x84, 0x8f, 0x6c, 0x22, 0xe8,
+  0xdb, 0xf2, 0x94, 0x8f, 0xd6, 0x20, 0x25, 0x67, 0x35, 0xe5, 0x32, 0xbe, 0x01, 0xde, 0xa4, 0xa4,
+  0xe0, 0x15, 0x4f, 0x5e, 0x51, 0x53, 0x1f, 0x4d, 0x40, 0x59, 0x18, 0x0f, 0x75, 0x41, 0x09, 0x35,
+  0x43, 0x76, 0x5f, 0xe8, 0x0d, 0x5b, 0xcd, 0xd0, 0x68, 0xdf, 0x67, 0x0b, 0x0e, 0xdb, 0xd1, 0x68,
+  0x0d, 0x8e, 0x45, 0x28, 0x35, 0x6e, 0x3b, 0x00, 0xf6, 0x63, 0x43, 0xb9, 0x0a, 0x86, 0x27, 0x54,
+  0x08, 0x94, 0xb5, 0x38, 0x82, 0xfb, 0x4d, 0x47, 0xb6, 0x7e, 0x7b, 0x49, 0x6c, 0xdf, 0x53, 0xad,
+  0xbb, 0xfc, 0xb7, 0x24, 0xb6, 0xfe, 0xd4, 0x9f, 0x00, 0xf7, 0x13, 0x54, 0xf9, 0xb2, 0x1c, 0x74,
+  0x43, 0xb1, 0x16, 0xc2, 0x8c, 0x3b, 0x5f, 0xb8, 0x1c, 0x76, 0xa9, 0xad, 0x57, 0xb4, 0xe8, 0x5f,
+  0xcd, 0x0c, 0xba, 0x79, 0xae, 0x6d, 0xbd, 0xaa, 0x10, 0x7f, 0x78, 0x2f, 0xec, 0x72, 0xff, 0xf4,
+  0x58, 0x1e, 0x13, 0xfc, 0x7a, 0x99, 0xe0, 0x47, 0xaf, 0x97, 0xf2, 0x8d, 0x68, 0x27, 0xf9, 0x09,
+};
+
+// CRC-32 register (no final inversion) after the head text, and of the tail text from 0
+static const uint32_t WEB_ROOT_CRC_HEAD = 0x67088fdfUL;
+static const uint32_t WEB_ROOT_CRC_TAIL = 0x22abaac4UL;
+// register nibble k with value v advanced over the tail length
+static const uint32_t WEB_ROOT_CRC_SHIFT[8][16] = {
+  {
+    0x00000000UL, 0x20f9b743UL, 0x41f36e86UL, 0x610ad9c5UL,
+    0x83e6dd0cUL, 0xa31f6a4fUL, 0xc215b38aUL, 0xe2ec04c9UL,
+    0xdcbcbc59UL, 0xfc450b1aUL, 0x9d4fd2dfUL, 0xbdb6659cUL,
+    0x5f5a6155UL, 0x7fa3d616UL, 0x1ea90fd3UL, 0x3e50b890UL,
+  },
+  {
+    0x00000000UL, 0x62087ef3UL, 0xc410fde6UL, 0xa6188315UL,
+    0x5350fd8dUL, 0x3158837eUL, 0x9740006bUL, 0xf5487e98UL,
+    0xa6a1fb1aUL, 0xc4a985e9UL, 0x62b106fcUL, 0x00b9780fUL,
+    0xf5f10697UL, 0x97f97864UL, 0x31e1fb71UL, 0x53e98582UL,
+  },
+  {
+    0x00000000UL, 0x9632f075UL, 0xf714e6abUL, 0x612616deUL,
+    0x3558cb17UL, 0xa36a3b62UL, 0xc24c2dbcUL, 0x547eddc9UL,
+    0x6ab1962eUL, 0xfc83665bUL, 0x9da57085UL, 0x0b9780f0UL,
+    0x5fe95d39UL, 0xc9dbad4cUL, 0xa8fdbb92UL, 0x3ecf4be7UL,
+  },
+  {
+    0x00000000UL, 0xd5632c5cUL, 0x71b75ef9UL, 0xa4d472a5UL,
+    0xe36ebdf2UL, 0x360d91aeUL, 0x92d9e30bUL, 0x47bacf57UL,
+    0x1dac7da5UL, 0xc8cf51f9UL, 0x6c1b235cUL, 0xb9780f00UL,
+    0xfec2c057UL, 0x2ba1ec0bUL, 0x8f759eaeUL, 0x5a16b2f2UL,
+  },
+  {
+    0x00000000UL, 0x3b58fb4aUL, 0x76b1f694UL, 0x4de90ddeUL,
+    0xed63ed28UL, 0xd63b1662UL, 0x9bd21bbcUL, 0xa08ae0f6UL,
+    0x01b6dc11UL, 0x3aee275bUL, 0x77072a85UL, 0x4c5fd1cfUL,
+    0xecd53139UL, 0xd78dca73UL, 0x9a64c7adUL, 0xa13c3ce7UL,
+  },
+  {
+    0x00000000UL, 0x036db822UL, 0x06db7044UL, 0x05b6c866UL,
+    0x0db6e088UL, 0x0edb58aaUL, 0x0b6d90ccUL, 0x080028eeUL,
+    0x1b6dc110UL, 0x18007932UL, 0x1db6b154UL, 0x1edb0976UL,
+    0x16db2198UL, 0x15b699baUL, 0x100051dcUL, 0x136de9feUL,
+  },
+  {
+    0x00000000UL, 0x36db8220UL, 0x6db70440UL, 0x5b6c8660UL,
+    0xdb6e0880UL, 0xedb58aa0UL, 0xb6d90cc0UL, 0x80028ee0UL,
+    0x6dad1741UL, 0x5b769561UL, 0x001a1301UL, 0x36c19121UL,
+    0xb6c31fc1UL, 0x80189de1UL, 0xdb741b81UL, 0xedaf99a1UL,
+  },
+  {
+    0x00000000UL, 0xdb5a2e82UL, 0x6dc55b45UL, 0xb69f75c7UL,
+    0xdb8ab68aUL, 0x00d09808UL, 0xb64fedcfUL, 0x6d15c34dUL,
+    0x6c646b55UL, 0xb73e45d7UL, 0x01a13010UL, 0xdafb1e92UL,
+    0xb7eedddfUL, 0x6cb4f35dUL, 0xda2b869aUL, 0x0171a818UL,
+  },
+};
+static const uint32_t WEB_ROOT_LEN_HEAD = 846;
+static const uint32_t WEB_ROOT_LEN_TAIL = 431;
+
+// plain text, for clients without gzip
+static const char WEB_ROOT_PLAIN_HEAD[] = "<!DOCTYPE html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width, initial-scale=1.0'><title>Outdoor Temp</title><style>body{font-family:Arial,sans-serif;background:#f2f2f2;margin:0;padding:0;}.card{max-width:360px;margin:40px auto;background:#fff;padding:20px;border-radius:12px;box-shadow:0 4px 10px rgba(0,0,0,.1);}h2{text-align:center;margin-top:0;}.temp{font-size:48px;text-align:center;margin:20px 0;}form{display:flex;flex-direction:column;gap:15px;}input[type=number]{font-size:20px;padding:12px;border-radius:8px;border:1px solid #ccc;}input[type=submit]{font-size:20px;padding:12px;border-radius:8px;border:none;background:#007bff;color:white;cursor:pointer;}input[type=submit]:active{background:#0056b3;}</style></head><body><div class='card'><h2>Outdoor Temperature</h2><div class='temp'><span id='t'>";
+// plain text after the value
+static const char WEB_ROOT_PLAIN_TAIL[] = "</span> &deg;C</div><form action='/set'><input type='number' name='temp' min='-99' max='99' placeholder='Enter temperature' required><input type='submit' value='Set temperature'></form></div><script>setInterval(function(){if(document.hidden)return;fetch('/api/state').then(function(r){return r.json()}).then(function(s){document.getElementById('t').textContent=s.temp.toFixed(2)}).catch(function(){})},10000)</script></body></html>";
@@ -0,0 +1,612 @@
+// Event-driven HTTP server, see web_server.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "hal.h"
+#include "web_server.h"
+
+const int WEB_SEGMENTS = 6;
+
+enum ConnState
+{
+  CONN_FREE,
+  CONN_READ,  // collecting the request
+  CONN_WRITE  // handler ran, response going out
+};
+
+/// @brief Output piece: bytes in the slot's transmit buffer or const data elsewhere
+struct WebSegment
+{
+  const uint8_t *data;
+  size_t len;
+};
+
+struct WebConn
+{
+  ConnState state;
+  int id;
+  uint32_t peer; // client IPv4 address
+  unsigned long acceptedUs;
+  unsigned long activeMs; // last progress, for WEB_IDLE_TIMEOUT
+
+  // request, parsed in place
+  char req[WEB_REQUEST_MAX + 1];
+  size_t reqLen;
+  size_t scanned;  // searched for the end of the headers
+  size_t headEnd;  // body offset, 0 while the headers are incomplete
+  size_t bodyLen;  // from Content-Length
+  WebMethod method;
+  const char *path;
+  const char *query;
+  const char *headers; // "Name: value\r\n" lines
+
+  // response
+  bool started;
+  int code;
+  char extra[WEB_HEADERS_MAX];
+  size_t extraLen;
+  uint8_t tx[WEB_TX_MAX];
+  size_t txLen;
+  WebSegment seg[WEB_SEGMENTS];
+  int segCount;
+  int segIdx;
+  size_t segPos;
+  WebFill fill;
+  uint64_t ctx[WEB_STREAM_CTX / sizeof(uint64_t)];
+};
+
+struct WebRoute
+{
+  const char *path;
+  WebHandler handler;
+};
+
+struct WebStats
+{
+  unsigned long accepted;
+  unsigned long responses;
+  unsigned long errors;    // 4xx / 5xx sent
+  unsigned long timeouts;  // closed for no progress
+  unsigned long aborted;   // peer closed or connection failed
+  int active;
+  int peak;
+  uint64_t serviceUs; // accept -> close, responses only
+  unsigned long serviceMaxUs;
+};
+
+static WebConn conns[WEB_MAX_CONN];
+static WebRoute routes[WEB_MAX_ROUTES];
+static int routeCount = 0;
+static WebMode webMode = WEB_ASYNC;
+static WebConn *cur = nullptr; // connection whose handler runs
+static WebStats stats;
+
+static const uint8_t CHUNK_END[] = {'0', '\r', '\n', '\r', '\n'};
+// room kept around a filled chunk: size line before, CRLF and the last chunk after
+const size_t CHUNK_HEAD = 8;
+const size_t CHUNK_TAIL = 2 + sizeof(CHUNK_END);
+
+bool webOn(const char *path, WebHandler handler)
+{
+  if (routeCount >= WEB_MAX_ROUTES)
+    return false;
+  routes[routeCount].path = path;
+  routes[routeCount].handler = handler;
+  routeCount++;
+  return true;
+}
+
+bool webBegin(uint16_t port)
+{
+  memset(conns, 0, sizeof(conns));
+  memset(&stats, 0, sizeof(stats));
+  return halListen(port);
+}
+
+void webSetMode(WebMode mode)
+{
+  webMode = mode;
+}
+
+static const char *statusText(int code)
+{
+  switch (code)
+  {
+  case 200: return "OK";
+  case 204: return "No Content";
+  case 302: return "Found";
+  case 400: return "Bad Request";
+  case 404: return "Not Found";
+  case 405: return "Method Not Allowed";
+  case 413: return "Payload Too Large";
+  case 429: return "Too Many Requests";
+  case 431: return "Request Header Fields Too Large";
+  case 500: return "Internal Server Error";
+  case 503: return "Service Unavailable";
+  default: return "";
+  }
+}
+
+static bool segAdd(WebConn &c, const uint8_t *data, size_t len)
+{
+  if (len == 0)
+    return true;
+  WebSegment *last = c.segCount ? &c.seg[c.segCount - 1] : nullptr;
+  if (last && last->data + last->len == data)
+  {
+    last->len += len; // contiguous in the transmit buffer
+    return true;
+  }
+  if (c.segCount >= WEB_SEGMENTS)
+    return false;
+  c.seg[c.segCount].data = data;
+  c.seg[c.segCount].len = len;
+  c.segCount++;
+  return true;
+}
+
+static bool txPut(WebConn &c, const void *data, size_t len)
+{
+  if (len == 0)
+    return true;
+  if (c.txLen + len > sizeof(c.tx))
+    return false;
+  memcpy(c.tx + c.txLen, data, len);
+  if (!segAdd(c, c.tx + c.txLen, len))
+    return false;
+  c.txLen += len;
+  return true;
+}
+
+/// @brief Status line and headers; length < 0 = chunked
+static void responseHead(WebConn &c, int code, const char *type, long length)
+{
+  c.started = true;
+  c.code = code;
+  char head[WEB_HEADERS_MAX + 192];
+  int n = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+  if (type)
+    n += snprintf(head + n, sizeof(head) - n, "Content-Type: %s\r\n", type);
+  memcpy(head + n, c.extra, c.extraLen);
+  n += c.extraLen;
+  if (length < 0)
+    n += snprintf(head + n, sizeof(head) - n, "Transfer-Encoding: chunked\r\n");
+  else if (code != 204)
+    n += snprintf(head + n, sizeof(head) - n, "Content-Length: %ld\r\n", length);
+  n += snprintf(head + n, sizeof(head) - n, "Connection: close\r\n\r\n");
+  txPut(c, head, n);
+}
+
+// ===== Current request =====
+WebMethod webMethod()
+{
+  return cur ? cur->method : WEB_OTHER;
+}
+
+uint32_t webClient()
+{
+  return cur ? cur->peer : 0;
+}
+
+static int hexValue(char ch)
+{
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+  if (ch >= 'a' && ch <= 'f')
+    return ch - 'a' + 10;
+  if (ch >= 'A' && ch <= 'F')
+    return ch - 'A' + 10;
+  return -1;
+}
+
+/// @brief Find argument name in the query
+/// @return Start of the value (at '&' / end if it has none), nullptr if missing
+static const char *argFind(const char *name)
+{
+  if (cur == nullptr || cur->query == nullptr)
+    return nullptr;
+  size_t nameLen = strlen(name);
+  for (const char *p = cur->query; *p;)
+  {
+    const char *end = strchr(p, '&');
+    if (end == nullptr)
+      end = p + strlen(p);
+    if (strncmp(p, name, nameLen) == 0 && (p[nameLen] == '=' || p + nameLen == end))
+      return p[nameLen] == '=' ? p + nameLen + 1 : p + nameLen;
+    p = *end ? end + 1 : end;
+  }
+  return nullptr;
+}
+
+bool webArg(const char *name, char *buf, size_t len)
+{
+  const char *p = argFind(name);
+  if (p == nullptr || len == 0)
+    return false;
+  size_t n = 0;
+  for (; *p && *p != '&' && n + 1 < len; p++)
+  {
+    char ch = *p;
+    if (ch == '+')
+      ch = ' ';
+    else if (ch == '%' && hexValue(p[1]) >= 0 && hexValue(p[2]) >= 0)
+    {
+      ch = (char)(hexValue(p[1]) * 16 + hexValue(p[2]));
+      p += 2;
+    }
+    buf[n++] = ch;
+  }
+  buf[n] = '\0';
+  return true;
+}
+
+bool webHasArg(const char *name)
+{
+  return argFind(name) != nullptr;
+}
+
+bool webHeader(const char *name, char *buf, size_t len)
+{
+  if (cur == nullptr || len == 0)
+    return false;
+  size_t nameLen = strlen(name);
+  for (const char *p = cur->headers; p && *p;)
+  {
+    const char *eol = strstr(p, "\r\n");
+    if (eol == nullptr)
+      break;
+    if (strncasecmp(p, name, nameLen) == 0 && p[nameLen] == ':')
+    {
+      p += nameLen + 1;
+      while (*p == ' ' || *p == '\t')
+        p++;
+      size_t n = eol - p < (long)len - 1 ? eol - p : len - 1;
+      memcpy(buf, p, n);
+      buf[n] = '\0';
+      return true;
+    }
+    p = eol + 2;
+  }
+  return false;
+}
+
+bool webBody(char *buf, size_t len)
+{
+  if (cur == nullptr || cur->bodyLen == 0 || len == 0)
+    return false;
+  size_t n = cur->bodyLen < len - 1 ? cur->bodyLen : len - 1;
+  memcpy(buf, cur->req + cur->headEnd, n);
+  buf[n] = '\0';
+  return true;
+}
+
+const uint8_t *webBodyData(size_t &len)
+{
+  len = 0;
+  if (cur == nullptr || cur->bodyLen == 0)
+    return nullptr;
+  len = cur->bodyLen;
+  return (const uint8_t *)cur->req + cur->headEnd;
+}
+
+// ===== Response =====
+void webSendHeader(const char *name, const char *value)
+{
+  if (cur == nullptr || cur->started)
+    return;
+  int n = snprintf(cur->extra + cur->extraLen, sizeof(cur->extra) - cur->extraLen, "%s: %s\r\n", name, value);
+  if (n > 0 && cur->extraLen + n < sizeof(cur->extra))
+    cur->extraLen += n;
+}
+
+void webSend(int code, const char *type, const char *body)
+{
+  if (cur == nullptr || cur->started)
+    return;
+  size_t len = type && body ? strlen(body) : 0;
+  responseHead(*cur, code, type, (long)len);
+  if (!txPut(*cur, body, len))
+  {
+    // does not fit: the head promised len bytes, so close early rather than send a short body
+    halLog("[web] response too large (%u bytes)\n", (unsigned)len);
+    cur->segCount = 0;
+  }
+}
+
+void webSendSized(int code, const char *type, size_t len)
+{
+  if (cur == nullptr || cur->started)
+    return;
+  responseHead(*cur, code, type, (long)len);
+}
+
+bool webSendContent(const void *data, size_t len)
+{
+  return cur && cur->started && txPut(*cur, data, len);
+}
+
+bool webSendStatic(const void *data, size_t len)
+{
+  return cur && cur->started && segAdd(*cur, (const uint8_t *)data, len);
+}
+
+void webSendStream(int code, const char *type, WebFill fill, const void *ctx, size_t ctxLen)
+{
+  if (cur == nullptr || cur->started || ctxLen > sizeof(cur->ctx))
+    return;
+  responseHead(*cur, code, type, -1);
+  memcpy(cur->ctx, ctx, ctxLen);
+  cur->fill = fill;
+}
+
+// ===== Connections =====
+static void connOpen(WebConn &c, int id)
+{
+  memset(&c, 0, sizeof(c));
+  c.state = CONN_READ;
+  c.id = id;
+  c.peer = halConnPeer(id);
+  c.acceptedUs = halMicros();
+  c.activeMs = halMillis();
+  stats.accepted++;
+  stats.active++;
+  if (stats.active > stats.peak)
+    stats.peak = stats.active;
+}
+
+static void connClose(WebConn &c, bool served)
+{
+  if (c.fill)
+    c.fill(c.ctx, nullptr, 0); // stream cut short
+  halConnClose(c.id);
+  c.state = CONN_FREE;
+  stats.active--;
+  if (!served)
+    return;
+  unsigned long us = halMicros() - c.acceptedUs;
+  stats.responses++;
+  stats.serviceUs += us;
+  if (us > stats.serviceMaxUs)
+    stats.serviceMaxUs = us;
+  if (c.code >= 400)
+    stats.errors++;
+}
+
+/// @brief Answer without a handler (parse errors, unknown route)
+static void connError(WebConn &c, int code, const char *text)
+{
+  cur = &c;
+  webSend(code, "text/plain", text);
+  cur = nullptr;
+  c.state = CONN_WRITE;
+}
+
+/// @brief Split the request line, find the body length
+/// @return HTTP error code, 0 if fine
+static int parseHead(WebConn &c)
+{
+  char *line = c.req;
+  char *eol = strstr(line, "\r\n");
+  *eol = '\0';
+  c.headers = eol + 2;
+  c.req[c.headEnd - 2] = '\0'; // headers end with their last CRLF
+
+  char *sp = strchr(line, ' ');
+  if (sp == nullptr)
+    return 400;
+  *sp = '\0';
+  char *target = sp + 1;
+  sp = strchr(target, ' ');
+  if (sp == nullptr || target[0] != '/')
+    return 400;
+  *sp = '\0';
+  c.method = strcmp(line, "GET") == 0    ? WEB_GET
+             : strcmp(line, "POST") == 0 ? WEB_POST
+             : strcmp(line, "PUT") == 0  ? WEB_PUT
+                                         : WEB_OTHER;
+  char *q = strchr(target, '?');
+  if (q)
+    *q++ = '\0';
+  c.path = target;
+  c.query = q;
+
+  cur = &c;
+  char length[12];
+  if (webHeader("Content-Length", length, sizeof(length)))
+    c.bodyLen = strtoul(length, nullptr, 10);
+  cur = nullptr;
+  if (c.bodyLen > WEB_REQUEST_MAX - c.headEnd)
+    return 413;
+  return 0;
+}
+
+static void dispatch(WebConn &c)
+{
+  c.req[c.headEnd + c.bodyLen] = '\0';
+  for (int i = 0; i < routeCount; i++)
+  {
+    if (strcmp(routes[i].path, c.path) != 0)
+      continue;
+    cur = &c;
+    routes[i].handler();
+    if (!c.started)
+      webSend(500, "text/plain", "No response");
+    cur = nullptr;
+    c.state = CONN_WRITE;
+    return;
+  }
+  connError(c, 404, "Not found");
+}
+
+static void readStep(WebConn &c)
+{
+  for (;;)
+  {
+    size_t room = WEB_REQUEST_MAX - c.reqLen;
+    if (room == 0)
+    {
+      connError(c, c.headEnd ? 413 : 431, "Request too large");
+      return;
+    }
+    int n = halConnRead(c.id, (uint8_t *)c.req + c.reqLen, room);
+    if (n < 0)
+    {
+      stats.aborted++;
+      connClose(c, false);
+      return;
+    }
+    if (n == 0)
+      return;
+    c.reqLen += n;
+    c.req[c.reqLen] = '\0';
+    c.activeMs = halMillis();
+
+    if (c.headEnd == 0)
+    {
+      char *end = strstr(c.req + c.scanned, "\r\n\r\n");
+      if (end == nullptr)
+      {
+        c.scanned = c.reqLen > 3 ? c.reqLen - 3 : 0;
+        continue;
+      }
+      c.headEnd = end + 4 - c.req;
+      int error = parseHead(c);
+      if (error)
+      {
+        connError(c, error, "Bad request");
+        return;
+      }
+    }
+    if (c.reqLen >= c.headEnd + c.bodyLen)
+    {
+      dispatch(c);
+      return;
+    }
+  }
+}
+
+/// @brief Next chunk of a streamed body into the transmit buffer
+static void streamFill(WebConn &c)
+{
+  c.txLen = 0;
+  c.segCount = 0;
+  c.segIdx = 0;
+  c.segPos = 0;
+  uint8_t *data = c.tx + CHUNK_HEAD;
+  int n = c.fill(c.ctx, data, sizeof(c.tx) - CHUNK_HEAD - CHUNK_TAIL);
+  if (n < 0)
+  {
+    c.fill = nullptr;
+    segAdd(c, CHUNK_END, sizeof(CHUNK_END));
+    return;
+  }
+  if (n == 0)
+    return;
+  char size[CHUNK_HEAD + 1];
+  int s = snprintf(size, sizeof(size), "%x\r\n", n);
+  memcpy(data - s, size, s);
+  data[n] = '\r';
+  data[n + 1] = '\n';
+  c.txLen = CHUNK_HEAD + n + 2;
+  segAdd(c, data - s, s + n + 2);
+}
+
+static void writeStep(WebConn &c)
+{
+  for (;;)
+  {
+    if (c.segIdx == c.segCount)
+    {
+      if (c.fill == nullptr)
+      {
+        connClose(c, true);
+        return;
+      }
+      streamFill(c);
+      if (c.segCount == 0)
+      {
+        c.activeMs = halMillis(); // nothing to send yet, the peer is not the one stalling
+        return;
+      }
+    }
+    const WebSegment &s = c.seg[c.segIdx];
+    int n = halConnWrite(c.id, s.data + c.segPos, s.len - c.segPos);
+    if (n < 0)
+    {
+      stats.aborted++;
+      connClose(c, false);
+      return;
+    }
+    if (n == 0)
+      return;
+    c.activeMs = halMillis();
+    c.segPos += n;
+    if (c.segPos == s.len)
+    {
+      c.segIdx++;
+      c.segPos = 0;
+    }
+  }
+}
+
+static void connStep(WebConn &c)
+{
+  if (c.state == CONN_READ)
+    readStep(c);
+  if (c.state == CONN_WRITE)
+    writeStep(c);
+  if (c.state != CONN_FREE && halMillis() - c.activeMs > WEB_IDLE_TIMEOUT)
+  {
+    stats.timeouts++;
+    connClose(c, false);
+  }
+}
+
+void webPoll()
+{
+  if (webMode == WEB_SERIAL)
+  {
+    // like WebServer::handleClient(): the loop waits for this one client
+    int id = halAccept();
+    if (id < 0)
+      return;
+    WebConn &c = conns[0];
+    connOpen(c, id);
+    for (;;)
+    {
+      connStep(c);
+      if (c.state == CONN_FREE)
+        return;
+      halDelay(1);
+    }
+  }
+
+  for (int i = 0; i < WEB_MAX_CONN; i++)
+  {
+    if (conns[i].state != CONN_FREE)
+      continue;
+    int id = halAccept();
+    if (id < 0)
+      break;
+    connOpen(conns[i], id);
+  }
+  for (int i = 0; i < WEB_MAX_CONN; i++)
+  {
+    if (conns[i].state != CONN_FREE)
+      connStep(conns[i]);
+  }
+}
+
+size_t webReport(char *buf, size_t len)
+{
+  int n = snprintf(buf, len,
+                   "web %s, %lu accepted, %lu responses (%lu errors), %lu timeouts, %lu aborted, "
+                   "%d open (peak %d of %d), service avg %lu us, max %lu us\n",
+                   webMode == WEB_ASYNC ? "async" : "serial", stats.accepted, stats.responses, stats.errors,
+                   stats.timeouts, stats.aborted, stats.active, stats.peak, WEB_MAX_CONN,
+                   stats.responses ? (unsigned long)(stats.serviceUs / stats.responses) : 0UL, stats.serviceMaxUs);
+  return n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+}
@@ -0,0 +1,92 @@
+// Event-driven HTTP/1.1 server over the non-blocking TCP calls of hal.h, no heap
+// Up to WEB_MAX_CONN connections are served at once, each in a fixed slot: a request buffer, a
+// transmit buffer and a short list of output segments (bytes in the transmit buffer, or const data
+// referenced in place, e.g. flash). webPoll() moves every connection as far as the socket allows
+// and returns; a slow client holds its slot until WEB_IDLE_TIMEOUT, never the loop.
+// A request is read whole (line, headers, Content-Length body) before its handler runs. The handler
+// answers through the web* calls below; the response is written out by later polls. Bodies of
+// unknown length are produced by a fill callback, sent chunked, one transmit buffer at a time; a
+// stream waiting for its callback is not idle, only one that cannot write is.
+// Every response closes the connection (no keep-alive).
+//
+// WEB_SERIAL serves one connection to completion inside webPoll() like the Arduino WebServer did,
+// kept for comparison runs (host runner --web-mode serial, tools/web_load.py).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+const int WEB_MAX_CONN = 4;
+const int WEB_MAX_ROUTES = 24;
+const size_t WEB_REQUEST_MAX = 1024;    // request line, headers and body
+const size_t WEB_TX_MAX = 2048;         // response head and copied body
+const size_t WEB_HEADERS_MAX = 160;     // extra response headers (webSendHeader)
+const size_t WEB_STREAM_CTX = 48;       // fill callback context, copied into the slot
+const unsigned long WEB_IDLE_TIMEOUT = 5000; // no progress reading or writing, ms
+
+enum WebMethod
+{
+  WEB_GET,
+  WEB_POST,
+  WEB_PUT,
+  WEB_OTHER
+};
+
+enum WebMode
+{
+  WEB_ASYNC,  // all connections, each as far as it can go
+  WEB_SERIAL  // one connection to completion per poll (blocks)
+};
+
+typedef void (*WebHandler)();
+
+/// @brief Produce the next piece of a streamed body
+/// Called with buf nullptr if the connection closes before the end, to release what ctx holds.
+/// @return Bytes written to buf (at most len), 0 if nothing yet, -1 at the end
+typedef int (*WebFill)(void *ctx, uint8_t *buf, size_t len);
+
+/// @brief Route path (exact match, without the query) to handler, call before webBegin()
+/// @return false if the route table is full
+bool webOn(const char *path, WebHandler handler);
+bool webBegin(uint16_t port);
+/// @brief Accept, read, dispatch and write as far as possible without blocking (WEB_ASYNC)
+void webPoll();
+void webSetMode(WebMode mode);
+
+// ===== Current request (inside a handler) =====
+WebMethod webMethod();
+/// @brief IPv4 address of the client (network byte order), 0 if unknown
+uint32_t webClient();
+/// @brief Copy URL-decoded query argument
+/// @return false if argument is missing
+bool webArg(const char *name, char *buf, size_t len);
+bool webHasArg(const char *name);
+/// @brief Copy request header value (name case-insensitive)
+/// @return false if the header is missing
+bool webHeader(const char *name, char *buf, size_t len);
+/// @brief Copy request body (NUL terminated, truncated)
+/// @return false if there is no body
+bool webBody(char *buf, size_t len);
+/// @brief Request body in place (binary), valid until the handler returns
+/// @return nullptr if there is no body
+const uint8_t *webBodyData(size_t &len);
+
+// ===== Response (inside a handler) =====
+/// @brief Add a header to the response, call before the webSend* that starts it
+void webSendHeader(const char *name, const char *value);
+/// @brief Whole response; type nullptr sends no body
+void webSend(int code, const char *type, const char *body);
+/// @brief Start a response of known length, the body follows in webSendContent() / webSendStatic()
+void webSendSized(int code, const char *type, size_t len);
+/// @brief Append body bytes (copied)
+/// @return false if they do not fit the transmit buffer
+bool webSendContent(const void *data, size_t len);
+/// @brief Append body bytes sent from where they are (const data that outlives the response)
+bool webSendStatic(const void *data, size_t len);
+/// @brief Chunked response filled by fill(ctx copy, ...) until it returns -1
+void webSendStream(int code, const char *type, WebFill fill, const void *ctx, size_t ctxLen);
+
+/// @brief Write request counts, errors, timeouts, concurrency and service time as text
+/// @return Number of chars written
+size_t webReport(char *buf, size_t len);
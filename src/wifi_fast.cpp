@@ -0,0 +1,179 @@
+// WiFi fast-reconnect cache, see wifi_fast.h
+
+#include <stddef.h>
+#include <string.h>
+
+#include "hal.h"
+#include "wifi_pass.h"
+#include "wifi_fast.h"
+
+#define WIFI_FAST_MAGIC 0x57464331UL // "WFC1"
+
+struct WifiFastCache
+{
+  uint32_t magic;
+  uint32_t ssidHash; // cache is dropped when SSID changes
+  HalWifiLink link;
+  uint32_t checksum;
+};
+
+// survives deep sleep and soft reset, NVS copy survives power-off
+HAL_RTC_DATA static WifiFastCache rtcCache;
+
+static WifiFastCache cache;
+static bool cacheValid = false;
+
+static bool fastPending = false;
+static unsigned long fastStartedAt = 0;
+static bool lastConnectFast = false;
+
+static const char *timingReason = "boot";
+static unsigned long timingStart = 0;
+static unsigned long timingConnected = 0;
+static bool timingActive = false;
+
+/// @brief FNV-1a hash
+static uint32_t fnv1a(const uint8_t *data, size_t len, uint32_t h = 2166136261UL)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    h ^= data[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+static uint32_t cacheChecksum(const WifiFastCache &c)
+{
+  return fnv1a((const uint8_t *)&c, offsetof(WifiFastCache, checksum));
+}
+
+static uint32_t ssidHash()
+{
+  return fnv1a((const uint8_t *)SSID, strlen(SSID));
+}
+
+static bool cacheIsValid(const WifiFastCache &c)
+{
+  return c.magic == WIFI_FAST_MAGIC && c.ssidHash == ssidHash() && c.link.channel != 0 && c.checksum == cacheChecksum(c);
+}
+
+/// @brief Drop cache (RTC and NVS) after failed targeted connect
+static void wifiFastInvalidate()
+{
+  cacheValid = false;
+  memset(&rtcCache, 0, sizeof(rtcCache));
+
+  halStoreRemove("wififast", "cache");
+}
+
+void wifiFastInit()
+{
+  if (cacheIsValid(rtcCache))
+  {
+    cache = rtcCache;
+    cacheValid = true;
+    return;
+  }
+
+  if (halStoreRead("wififast", "cache", &cache, sizeof(cache)) && cacheIsValid(cache))
+  {
+    cacheValid = true;
+    rtcCache = cache;
+  }
+}
+
+bool wifiFastBegin()
+{
+  fastPending = false;
+  lastConnectFast = false;
+
+  if (cacheValid)
+  {
+    HalWifiLink target = cache.link;
+#if !WIFI_FAST_STATIC_IP
+    target.ip = 0; // DHCP
+#endif
+    halWifiBegin(SSID, PASSWORD, &target);
+    fastPending = true;
+    fastStartedAt = halMillis();
+    lastConnectFast = true;
+    return true;
+  }
+
+  // full scan + DHCP
+  halWifiBegin(SSID, PASSWORD, nullptr);
+  return false;
+}
+
+void wifiFastCheck(unsigned long now)
+{
+  if (!fastPending)
+    return;
+
+  if (halWifiStatus() == HAL_WIFI_CONNECTED)
+  {
+    fastPending = false;
+    return;
+  }
+
+  if (now - fastStartedAt < WIFI_FAST_TIMEOUT)
+    return;
+
+  // AP moved to other channel / BSSID or lease is gone -> full scan
+  halLog("[wifi] targeted connect failed after %lu ms, full scan\n", now - fastStartedAt);
+  wifiFastInvalidate();
+  halWifiDisconnect();
+  wifiFastBegin();
+}
+
+void wifiFastStore()
+{
+  WifiFastCache c;
+  memset(&c, 0, sizeof(c));
+  c.magic = WIFI_FAST_MAGIC;
+  c.ssidHash = ssidHash();
+  if (!halWifiGetLink(c.link))
+    return;
+  c.checksum = cacheChecksum(c);
+
+  rtcCache = c;
+
+  // write NVS only on change to save flash wear
+  if (cacheValid && memcmp(&c, &cache, sizeof(c)) == 0)
+    return;
+
+  cache = c;
+  cacheValid = true;
+
+  halStoreWrite("wififast", "cache", &c, sizeof(c));
+}
+
+void wifiFastTimingStart(const char *reason)
+{
+  timingReason = reason;
+  // boot is measured from power-on (millis() == 0)
+  timingStart = (strcmp(reason, "boot") == 0) ? 0 : halMillis();
+  timingConnected = 0;
+  timingActive = true;
+}
+
+void wifiFastTimingConnected()
+{
+  if (!timingActive)
+    return;
+  timingConnected = halMillis();
+  halLog("[wifi] %s: connected in %lu ms (%s)\n", timingReason, timingConnected - timingStart,
+         lastConnectFast ? "targeted" : "full scan");
+}
+
+void wifiFastTimingFirstTemp()
+{
+  if (!timingActive)
+    return;
+  timingActive = false;
+  unsigned long now = halMillis();
+  halLog("[wifi] %s: first temperature displayed after %lu ms (wifi %lu ms, fetch %lu ms)\n", timingReason,
+         now - timingStart, timingConnected ? timingConnected - timingStart : 0,
+         timingConnected ? now - timingConnected : 0);
+}
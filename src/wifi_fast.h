@@ -0,0 +1,39 @@
+// WiFi fast-reconnect cache
+// Remembers BSSID, channel and DHCP lease of the last good connection (RTC + NVS)
+// so that cold boots and reconnects can skip the full scan (and, with WIFI_FAST_STATIC_IP, DHCP).
+
+#pragma once
+
+// reuse last DHCP lease as static IP on targeted connect (skips DHCP round-trip)
+// Off by default: the lease is not checked again, if it went to another host the conflict
+// goes unnoticed. Only for networks where the router reserves this address for the device.
+#ifndef WIFI_FAST_STATIC_IP
+#define WIFI_FAST_STATIC_IP 0
+#endif
+
+// how long a targeted (BSSID + channel) connect may take before falling back to full scan
+const unsigned long WIFI_FAST_TIMEOUT = 3000;
+
+/// @brief Load cached connection parameters (RTC memory first, then NVS)
+void wifiFastInit();
+
+/// @brief Start WiFi connection, targeted if cache is valid, full scan otherwise
+/// @return true if targeted connect was started
+bool wifiFastBegin();
+
+/// @brief Fall back to full scan if targeted connect did not succeed in time
+/// @param now  Current millis()
+void wifiFastCheck(unsigned long now);
+
+/// @brief Store parameters of current connection (call once after connect)
+void wifiFastStore();
+
+/// @brief Start timing of connect -> first displayed temperature
+/// @param reason  "boot" or "reconnect"
+void wifiFastTimingStart(const char *reason);
+
+/// @brief Mark WiFi connected in current timing window
+void wifiFastTimingConnected();
+
+/// @brief Mark first displayed temperature in current timing window (prints result)
+void wifiFastTimingFirstTemp();
@@ -0,0 +1,114 @@
+# Generates src/web_root_data.h from web/root.html: the page as pre-gzipped pieces around the
+# %TEMP% marker, so the firmware only splices in the value (see src/web_root.h).
+#
+# Runs as a PlatformIO pre-build script (extra_scripts) or standalone: python3 tools/gen_web.py
+#
+# The gzip stream is: header + deflate(text before the marker, full flush) | stored block with the
+# value (written at runtime) | deflate(text after the marker, independent, final block) | trailer.
+# CRC-32 is linear, so the trailer CRC is computed at runtime from the register after the head,
+# the value bytes, and a table that advances each register nibble over the tail.
+
+import os
+import zlib
+
+MARKER = b"%TEMP%"
+CRC_POLY = 0xEDB88320
+
+
+def crc_register(reg, data):
+    """CRC-32 register update without the final inversion."""
+    for b in data:
+        reg ^= b
+        for _ in range(8):
+            reg = (reg >> 1) ^ (CRC_POLY if reg & 1 else 0)
+    return reg
+
+
+def c_bytes(name, data, comment):
+    lines = ["// " + comment, "static const uint8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def c_string(name, data, comment):
+    text = data.decode("utf-8").replace("\\", "\\\\").replace('"', '\\"')
+    return "// %s\nstatic const char %s[] = \"%s\";" % (comment, name, text)
+
+
+def generate(project_dir):
+    src = os.path.join(project_dir, "web", "root.html")
+    dst = os.path.join(project_dir, "src", "web_root_data.h")
+    if os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src) and \
+            os.path.getmtime(dst) >= os.path.getmtime(os.path.join(project_dir, "tools", "gen_web.py")):
+        return
+
+    with open(src, "rb") as f:
+        page = f.read().rstrip(b"\r\n")
+    head, tail = page.split(MARKER)
+
+    # gzip header: deflate, no flags, mtime 0, max compression, unknown OS
+    gz_header = bytes([0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 2, 0xFF])
+    c = zlib.compressobj(9, zlib.DEFLATED, -15, 9)
+    gz_head = gz_header + c.compress(head) + c.flush(zlib.Z_FULL_FLUSH)
+    c = zlib.compressobj(9, zlib.DEFLATED, -15, 9)
+    gz_tail = c.compress(tail) + c.flush(zlib.Z_FINISH)
+
+    crc_head = crc_register(0xFFFFFFFF, head)
+    crc_tail = crc_register(0, tail)
+    zeros = bytes(len(tail))
+    shift = [[crc_register(v << (4 * k), zeros) for v in range(16)] for k in range(8)]
+
+    # self check with a sample value
+    value = b"-12.34"
+    stored = bytes([0, len(value), 0, (~len(value)) & 0xFF, 0xFF]) + value
+    reg = crc_register(crc_head, value)
+    reg2 = crc_tail
+    for k in range(8):
+        reg2 ^= shift[k][reg >> (4 * k) & 15]
+    trailer = ((~reg2) & 0xFFFFFFFF).to_bytes(4, "little") + (len(head) + len(value) + len(tail)).to_bytes(4, "little")
+    assert zlib.decompress(gz_head + stored + gz_tail + trailer, 31) == head + value + tail
+
+    out = [
+        "// Generated by tools/gen_web.py from web/root.html, do not edit",
+        "// Included by web_root.cpp and web_root_bench.cpp. Const data stays in flash on the ESP32.",
+        "",
+        "#pragma once",
+        "",
+        "#include <stdint.h>",
+        "",
+        c_bytes("WEB_ROOT_GZ_HEAD", gz_head, "gzip header + deflated text before the value, ends on a full flush"),
+        "",
+        c_bytes("WEB_ROOT_GZ_TAIL", gz_tail, "deflated text after the value, independent of the head, final block"),
+        "",
+        "// CRC-32 register (no final inversion) after the head text, and of the tail text from 0",
+        "static const uint32_t WEB_ROOT_CRC_HEAD = 0x%08xUL;" % crc_head,
+        "static const uint32_t WEB_ROOT_CRC_TAIL = 0x%08xUL;" % crc_tail,
+        "// register nibble k with value v advanced over the tail length",
+        "static const uint32_t WEB_ROOT_CRC_SHIFT[8][16] = {",
+    ]
+    for k in range(8):
+        out.append("  {")
+        for i in range(0, 16, 4):
+            out.append("    " + ", ".join("0x%08xUL" % v for v in shift[k][i:i + 4]) + ",")
+        out.append("  },")
+    out += [
+        "};",
+        "static const uint32_t WEB_ROOT_LEN_HEAD = %d;" % len(head),
+        "static const uint32_t WEB_ROOT_LEN_TAIL = %d;" % len(tail),
+        "",
+        c_string("WEB_ROOT_PLAIN_HEAD", head, "plain text, for clients without gzip"),
+        c_string("WEB_ROOT_PLAIN_TAIL", tail, "plain text after the value"),
+        "",
+    ]
+    with open(dst, "w") as f:
+        f.write("\n".join(out))
+    print("gen_web: %s, %d bytes -> %d gzipped + value" % (dst, len(head) + len(tail), len(gz_head) + len(gz_tail) + 8))
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO / SCons)
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -0,0 +1,277 @@
+# Client for the display's binary serial protocol (src/serial_proto.h): COBS frames with CRC-16.
+#
+#   python3 tools/serial_proto.py PORT [--baud 115200] [--repeat N] COMMAND
+#     value N | symbol S | frame N   set the value layer (--repeat times, round trip reported)
+#     stream FPS SECONDS             stream frame records into the playback ring, kept topped up
+#     stats                          device and receiver counters
+#     corrupt                        send a frame with a bad CRC (must stay unanswered), then stats
+#     check                          pass/fail run of the framing edge cases, exits 1 on a failure
+#
+# Host runner: firmware --serial-pty --tick-ms 1 --hours 1   (prints the port, e.g. /dev/pts/3)
+#              python3 tools/serial_proto.py --firmware .pio/build/native/program check
+#              (--firmware starts the runner on a pty itself, PORT is then left out)
+# Device:      python3 tools/serial_proto.py /dev/ttyUSB0 stats
+
+import argparse
+import os
+import select
+import struct
+import subprocess
+import sys
+import termios
+import time
+import tty
+
+SET_VALUE, SET_SYMBOL, SET_FRAME, STREAM, STATS = 1, 2, 3, 4, 5
+REPLY = 0x80
+STATUS = {0: "ok", 1: "bad", 2: "full", 3: "unknown"}
+STREAM_BATCH = 63  # records per frame, 255 body bytes
+FRAME_MASK = 0xA5A5
+TIMEOUT_S = 1.0
+BAUDS = {9600: termios.B9600, 115200: termios.B115200, 230400: termios.B230400, 921600: termios.B921600}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for b in data:
+        if b == 0:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+            continue
+        block.append(b)
+        if len(block) == 254:
+            out += b"\xff" + block
+            block = bytearray()
+    out += bytes([len(block) + 1]) + block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """Payload of one frame (without delimiters), None if it is not COBS."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Link:
+    def __init__(self, port, baud):
+        self.fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = BAUDS[baud]
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        self.seq = 0
+        self.rx = bytearray()
+        self.skipped = 0  # bytes between frames: log lines, bad frames
+
+    def send(self, ftype, body=b"", corrupt=False):
+        self.seq = (self.seq + 1) & 0xFF
+        payload = bytes([ftype, self.seq]) + body
+        crc = crc16(payload) ^ (1 if corrupt else 0)
+        os.write(self.fd, b"\x00" + cobs_encode(payload + struct.pack("<H", crc)) + b"\x00")
+        return self.seq
+
+    def reply(self, seq, timeout=TIMEOUT_S):
+        """(status, body) of the reply to seq, None on timeout."""
+        end = time.monotonic() + timeout
+        while True:
+            while b"\x00" in self.rx:
+                segment, _, rest = bytes(self.rx).partition(b"\x00")
+                self.rx = bytearray(rest)
+                payload = cobs_decode(segment) if segment else None
+                if payload is None or len(payload) < 5 or crc16(payload[:-2]) != struct.unpack("<H", payload[-2:])[0]:
+                    self.skipped += len(segment)
+                    continue
+                if payload[1] == seq and payload[0] & REPLY:
+                    return payload[2], payload[3:-2]
+            left = end - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None
+            self.rx += os.read(self.fd, 4096)
+
+    def command(self, ftype, body=b"", retries=3):
+        for _ in range(retries):
+            r = self.reply(self.send(ftype, body))
+            if r is not None:
+                return r
+        sys.exit("no reply")
+
+
+def stats(link):
+    status, body = link.command(STATS)
+    return struct.unpack("<IHhBHIIIIII", body)
+
+
+def print_stats(link):
+    f = stats(link)
+    print("uptime %.1f s, frame 0x%04x, temp %.1f, wifi %s" % (f[0] / 1000.0, f[1], f[2] / 10.0, "up" if f[3] else "down"))
+    print("playback %d queued, %d shown, %d skipped" % f[4:7])
+    print("receiver %d frames, %d CRC errors, %d overruns, %d timeouts" % f[7:11])
+
+
+def set_command(link, ftype, body, repeat):
+    times = []
+    for _ in range(repeat):
+        t0 = time.monotonic()
+        status, reply = link.command(ftype, body)
+        times.append(time.monotonic() - t0)
+        if status != 0:
+            sys.exit("refused: %s" % STATUS.get(status, status))
+    frame = struct.unpack("<H", reply)[0]
+    times.sort()
+    print("frame 0x%04x, %d commands, round trip avg %.2f ms, max %.2f ms (%.0f commands/s)" % (
+        frame, repeat, 1000 * sum(times) / len(times), 1000 * times[-1], len(times) / sum(times)))
+
+
+def stream(link, fps, seconds):
+    duration = max(1, round(1000 / fps))
+    total = fps * seconds
+    sent = full = frames = 0
+    t0 = time.monotonic()
+    while sent < total:
+        n = min(STREAM_BATCH, total - sent)
+        records = b"".join(struct.pack("<HH", (sent + k) ^ FRAME_MASK, duration) for k in range(n))
+        status, body = link.command(STREAM, b"\x00" + records)
+        frames += 1
+        queued, free = struct.unpack("<HH", body)
+        if status == 2:
+            full += 1
+            time.sleep((n - free) * duration / 1000.0)
+            continue
+        if status != 0:
+            sys.exit("refused: %s" % STATUS.get(status, status))
+        sent += n
+        if free < STREAM_BATCH:
+            time.sleep((STREAM_BATCH - free) * duration / 1000.0)
+    dt = time.monotonic() - t0
+    print("%d records (%d ms) in %d frames, %d refused (ring full), %.1f s, %.0f records/s sent" % (
+        total, duration, frames, full, dt, total / dt))
+    # let the ring play out
+    while True:
+        status, body = link.command(STREAM, b"\x00")
+        if struct.unpack("<HH", body)[0] == 0:
+            break
+        time.sleep(0.1)
+    print_stats(link)
+
+
+def check(link):
+    """Framing edge cases against the receiver; every line is one pass/fail check."""
+    failed = []
+
+    def expect(name, ok):
+        print("%-44s %s" % (name, "ok" if ok else "FAIL"))
+        if not ok:
+            failed.append(name)
+
+    def raw(data, bytewise=False):
+        for i in range(len(data) if bytewise else 1):
+            os.write(link.fd, data[i:i + 1] if bytewise else data)
+            if bytewise:
+                time.sleep(0.002)  # well under SERIAL_FRAME_IDLE_MS
+
+    def frame(ftype, body, crc_flip=0):
+        link.seq = (link.seq + 1) & 0xFF
+        payload = bytes([ftype, link.seq]) + body
+        crc = crc16(payload) ^ crc_flip
+        return link.seq, b"\x00" + cobs_encode(payload + struct.pack("<H", crc)) + b"\x00"
+
+    before = stats(link)
+    expect("set frame 0x1234", link.command(SET_FRAME, struct.pack("<H", 0x1234)) == (0, struct.pack("<H", 0x1234)))
+    expect("set frame 0x0000 (zeros in the body)", link.command(SET_FRAME, b"\x00\x00") == (0, b"\x00\x00"))
+    expect("value out of range refused", link.command(SET_VALUE, struct.pack("<b", 100))[0] == 1)
+    expect("value with a 2 byte body refused", link.command(SET_VALUE, b"\x01\x02")[0] == 1)
+    expect("unknown command answered unknown", link.command(0x7F)[0] == 3)
+
+    # 63 records without a zero byte: 255 byte body, a 0xFF COBS block on the wire
+    records = b"".join(struct.pack("<HH", 0x0101 + k, 0x0101) for k in range(STREAM_BATCH))
+    status, body = link.command(STREAM, b"\x01" + records)
+    expect("stream 255 byte body (0xFF block)", status == 0 and len(body) == 4)
+    link.command(STREAM, b"\x01")  # stop playback again
+
+    seq, data = frame(SET_FRAME, struct.pack("<H", 0x0202))
+    raw(data, bytewise=True)
+    expect("frame sent byte by byte", link.reply(seq) == (0, struct.pack("<H", 0x0202)))
+
+    seq, data = frame(STATS, b"", crc_flip=1)
+    raw(data)
+    expect("bad CRC unanswered", link.reply(seq, timeout=0.3) is None)
+    raw(b"\x00\x06\x01\x02\x00")
+    raw(b"\x00" + (b"\xff" + b"\x33" * 254) * 2 + b"\x00")
+    after = stats(link)
+    expect("cut block counted as CRC error", after[8] - before[8] == 2)
+    expect("overlong frame counted as overrun", after[9] - before[9] == 1)
+    expect("good frames counted", after[7] - before[7] == 9)
+    expect("link still answers", link.command(SET_FRAME, struct.pack("<H", 0x0303))[0] == 0)
+
+    print("check %s" % ("passed" if not failed else "FAILED: %d" % len(failed)))
+    return not failed
+
+
+def main():
+    p = argparse.ArgumentParser(description="Binary serial protocol client for the outdoor display.")
+    # --firmware starts the host runner on a pty, there is no PORT then
+    spawn = any(x == "--firmware" or x.startswith("--firmware=") for x in sys.argv[1:])
+    if not spawn:
+        p.add_argument("port")
+    p.add_argument("--baud", type=int, default=115200, choices=sorted(BAUDS))
+    p.add_argument("--repeat", type=int, default=1)
+    p.add_argument("--firmware", help="host runner to start on a pty instead of opening PORT")
+    p.add_argument("command", choices=["value", "symbol", "frame", "stream", "stats", "corrupt", "check"])
+    p.add_argument("args", nargs="*")
+    a = p.parse_args()
+    runner = None
+    if spawn:
+        runner = subprocess.Popen([a.firmware, "--serial-pty", "--tick-ms", "1", "--hours", "1", "--quiet"],
+                                  stdout=subprocess.PIPE, universal_newlines=True)
+        a.port = runner.stdout.readline().split()[-1]
+    try:
+        run(a, Link(a.port, a.baud))
+    finally:
+        if runner:
+            runner.kill()
+
+
+def run(a, link):
+
+    if a.command == "value":
+        set_command(link, SET_VALUE, struct.pack("<b", int(a.args[0])), a.repeat)
+    elif a.command == "symbol":
+        set_command(link, SET_SYMBOL, a.args[0].encode(), a.repeat)
+    elif a.command == "frame":
+        set_command(link, SET_FRAME, struct.pack("<H", int(a.args[0], 0)), a.repeat)
+    elif a.command == "stream":
+        stream(link, int(a.args[0]), int(a.args[1]))
+    elif a.command == "corrupt":
+        r = link.reply(link.send(STATS, corrupt=True), timeout=0.3)
+        print("corrupted frame %s" % ("answered (wrong)" if r else "dropped"))
+        print_stats(link)
+    elif a.command == "check":
+        if not check(link):
+            sys.exit(1)
+    else:
+        print_stats(link)
+    if link.skipped:
+        print("skipped %d bytes outside frames" % link.skipped)
+
+
+if __name__ == "__main__":
+    main()
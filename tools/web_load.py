@@ -0,0 +1,105 @@
+# Concurrent load on the display's web server, reports latency percentiles and throughput.
+#
+#   python3 tools/web_load.py HOST[:PORT] [--clients N] [--requests N] [--slow N] [--path P]
+#
+# N fast clients each send --requests GET requests back to back (one connection per request, the
+# server closes after every response). --slow clients meanwhile open connections and dribble the
+# request out a byte every 50 ms, the way a stalled phone on bad WiFi does; they are not measured.
+# A blocking server serves the fast clients behind every slow one.
+#
+# Host runner: firmware --web-listen 8080 --tick-ms 1 --hours 1 [--web-mode serial]
+# Device:      python3 tools/web_load.py 192.168.1.50
+
+import argparse
+import socket
+import threading
+import time
+
+SLOW_BYTE_S = 0.05
+
+
+def request(host, port, path, timeout):
+    """One GET, returns (seconds, status) or (seconds, None) on failure."""
+    t0 = time.monotonic()
+    try:
+        with socket.create_connection((host, port), timeout=timeout) as s:
+            s.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nAccept-Encoding: gzip\r\n\r\n" % (path, host)).encode())
+            data = b""
+            while True:
+                part = s.recv(4096)
+                if not part:
+                    break
+                data += part
+        status = int(data.split(b" ", 2)[1]) if data.startswith(b"HTTP/1.1 ") else None
+    except (OSError, ValueError, IndexError):
+        status = None
+    return time.monotonic() - t0, status
+
+
+def fast_client(args, host, port, results):
+    for _ in range(args.requests):
+        results.append(request(host, port, args.path, 30.0))
+
+
+def slow_client(host, port, path, stop):
+    line = ("GET %s HTTP/1.1\r\nHost: %s\r\n\r\n" % (path, host)).encode()
+    while not stop.is_set():
+        try:
+            with socket.create_connection((host, port), timeout=30.0) as s:
+                for b in line:
+                    if stop.is_set():
+                        return
+                    s.send(bytes([b]))
+                    time.sleep(SLOW_BYTE_S)
+                while s.recv(4096):
+                    pass
+        except OSError:
+            time.sleep(SLOW_BYTE_S)
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Concurrent load on the display web server")
+    parser.add_argument("target", help="HOST[:PORT]")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--requests", type=int, default=50, help="per fast client")
+    parser.add_argument("--slow", type=int, default=0, help="slow clients")
+    parser.add_argument("--path", default="/")
+    args = parser.parse_args()
+    host, _, port = args.target.partition(":")
+    port = int(port or 80)
+
+    stop = threading.Event()
+    slow = [threading.Thread(target=slow_client, args=(host, port, args.path, stop), daemon=True)
+            for _ in range(args.slow)]
+    for t in slow:
+        t.start()
+    time.sleep(0.2 if args.slow else 0)
+
+    results = []
+    fast = [threading.Thread(target=fast_client, args=(args, host, port, results)) for _ in range(args.clients)]
+    t0 = time.monotonic()
+    for t in fast:
+        t.start()
+    for t in fast:
+        t.join()
+    wall = time.monotonic() - t0
+    stop.set()
+
+    ok = sorted(t for t, status in results if status is not None and status < 400)
+    failed = len(results) - len(ok)
+    if not ok:
+        print("no successful requests (%d failed)" % failed)
+        return 1
+    print("%d requests, %d clients, %d slow: %d ok, %d failed, %.1f req/s" %
+          (len(results), args.clients, args.slow, len(ok), failed, len(ok) / wall))
+    print("latency ms  p50 %.1f  p95 %.1f  max %.1f" %
+          (1000 * percentile(ok, 0.5), 1000 * percentile(ok, 0.95), 1000 * ok[-1]))
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())